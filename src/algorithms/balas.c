@@ -0,0 +1,269 @@
+#include "balas.h"
+
+// a state is (m, b, last): all the positions before m are used, m is not, bit i of b tells if position m+1+i is used and
+// last is the position placed most recently, stored as offset last-m+k in [0,2k). No position at or after m+k can be
+// used before m, so b has k-1 bits and the states of a level are 2^(k-1) * 2k
+#define BS_NSTATES(k) ((1 << ((k) - 1)) * 2 * (k))
+#define BS_STATE(k, b, off) ((b) * 2 * (k) + (off))
+
+ERROR_CODE bs_workspace_init(bs_workspace* ws, int k){
+    ws->k = k;
+    ws->cost = (double*) malloc((size_t)(k + 1) * BS_NSTATES(k) * sizeof(double));
+    ws->pred = (signed char*) malloc((size_t)(BS_SEGMENT + 1) * BS_NSTATES(k) * sizeof(signed char));
+    ws->buffer = (int*) malloc(BS_SEGMENT * sizeof(int));
+    if(ws->cost == NULL || ws->pred == NULL || ws->buffer == NULL){
+        log_error("error in allocating the Balas-Simonetti workspace");
+        bs_workspace_free(ws);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    return T_OK;
+}
+
+void bs_workspace_free(bs_workspace* ws){
+    utils_safe_free(ws->cost);
+    utils_safe_free(ws->pred);
+    utils_safe_free(ws->buffer);
+}
+
+double bs_segment(bs_workspace* ws, int* path, int len){
+    int k = ws->k;
+    int nb = 1 << (k - 1);
+    int ns = BS_NSTATES(k);
+
+    // levels of the costs are reused modulo k+1, a transition moves m forward by at most k
+    #define BS_LEVEL(m) (ws->cost + (size_t)((m) % (k + 1)) * ns)
+
+    for(int i=0; i<(k+1)*ns; i++){
+        ws->cost[i] = __DBL_MAX__;
+    }
+    BS_LEVEL(1)[BS_STATE(k, 0, k - 1)] = 0.0;
+
+    for(int m=1; m<len; m++){
+        // level m+k is reached for the first time from m, it still holds level m-1
+        double* next = BS_LEVEL(m + k);
+        for(int i=0; i<ns; i++){
+            next[i] = __DBL_MAX__;
+        }
+
+        double* cur = BS_LEVEL(m);
+        int room = len - m - 1;         // positions after m in the segment
+        for(int b=0; b<nb; b++){
+            if(room < k - 1 && (b >> max(room, 0)) != 0){
+                continue;
+            }
+            for(int off=0; off<2*k; off++){
+                double c = cur[BS_STATE(k, b, off)];
+                if(c == __DBL_MAX__){
+                    continue;
+                }
+                int last = m + off - k;
+
+                for(int d=0; d<k && m+d<len; d++){
+                    int q = m + d;
+                    if(d > 0 && ((b >> (d - 1)) & 1)){
+                        continue;
+                    }
+                    if(q == len - 1 && m != len - 1){
+                        // the last node stays last
+                        continue;
+                    }
+
+                    int nm = m;
+                    int nbits = b | ((d > 0) ? 1 << (d - 1) : 0);
+                    if(d == 0){
+                        // m is used, the first unused position is after the used ones that follow it
+                        int shift = 1;
+                        while((b >> (shift - 1)) & 1){
+                            shift++;
+                        }
+                        nm = m + shift;
+                        nbits = b >> shift;
+                    }
+
+                    double nc = c + tsp_get_cost(path[last], path[q]);
+                    int s = BS_STATE(k, nbits, q - nm + k);
+                    double* dst = BS_LEVEL(nm);
+                    if(nc < dst[s]){
+                        dst[s] = nc;
+                        ws->pred[(size_t)nm * ns + s] = (signed char)(last - q);
+                    }
+                }
+            }
+        }
+    }
+
+    double best = BS_LEVEL(len)[BS_STATE(k, 0, k - 1)];
+
+    #undef BS_LEVEL
+
+    double old = 0.0;
+    for(int i=0; i<len-1; i++){
+        old += tsp_get_cost(path[i], path[i+1]);
+    }
+    if(best == __DBL_MAX__ || old - best < BS_EPS){
+        return 0.0;
+    }
+
+    // walk the predecessors back, removing one position at a time from the state
+    int m = len, b = 0, q = len - 1;
+    for(int pos=len-1; pos>0; pos--){
+        ws->buffer[pos] = path[q];
+        int prev = q + ws->pred[(size_t)m * ns + BS_STATE(k, b, q - m + k)];
+        if(q < m){
+            b = ((1 << (m - q - 1)) - 1) | (b << (m - q));
+            m = q;
+        }else{
+            b &= ~(1 << (q - m - 1));
+        }
+        q = prev;
+    }
+
+    // the endpoints never move and are shared with the neighbouring segments, read by other threads
+    memcpy(path + 1, ws->buffer + 1, (len - 2) * sizeof(int));
+
+    return old - best;
+}
+
+void* bs_thread(void* arg){
+    bs_worker* w = (bs_worker*) arg;
+    w->gain = 0.0;
+
+    for(int s=w->id; s<w->nsegments; s+=w->nthreads){
+        int start = s * (w->seglen - 1);
+        int len = w->last - start + 1;
+        if(len > w->seglen){
+            len = w->seglen;
+        }
+        if(len >= 3){
+            w->gain += bs_segment(&w->ws, w->seq + start, len);
+        }
+    }
+
+    return NULL;
+}
+
+ERROR_CODE bs_Polish(void){
+    ERROR_CODE e = T_OK;
+    int n = tsp_inst.nnodes;
+    int k = tsp_env.bs_k;
+
+    if(k < 2 || n < 4){
+        return T_OK;
+    }
+    if(k > BS_MAX_K){
+        log_error("Balas-Simonetti supports k up to %d", BS_MAX_K);
+        return INVALID_ARGUMENT;
+    }
+    if(!tsp_validate_solution(n, tsp_inst.best_solution.path)){
+        log_warn("no valid solution to polish");
+        return FAILED_PRECONDITION;
+    }
+
+    log_info("polishing the solution with Balas-Simonetti, k=%d", k);
+
+    int seglen = (n + 1 < BS_SEGMENT) ? n + 1 : BS_SEGMENT;
+    int nsegments = (n + seglen - 2) / (seglen - 1);
+    int nthreads = (tsp_env.threads < nsegments) ? tsp_env.threads : nsegments;
+
+    int* seq = (int*) malloc((n + 1) * sizeof(int));
+    int* tmp = (int*) malloc((n + 1) * sizeof(int));
+    pthread_t* threads = (pthread_t*) calloc(nthreads, sizeof(pthread_t));
+    bs_worker* workers = (bs_worker*) calloc(nthreads, sizeof(bs_worker));
+    tsp_solution solution;
+    tsp_init_solution(n, &solution);
+    if(seq == NULL || tmp == NULL || threads == NULL || workers == NULL || solution.path == NULL){
+        log_error("error in allocating memory for Balas-Simonetti");
+        e = RESOURCE_EXHAUSTED;
+        goto bs_free;
+    }
+
+    for(int t=0; t<nthreads; t++){
+        e = bs_workspace_init(&workers[t].ws, k);
+        if(!err_ok(e)){
+            goto bs_free;
+        }
+        workers[t].seq = seq;
+        workers[t].nsegments = nsegments;
+        workers[t].seglen = seglen;
+        workers[t].last = n;
+        workers[t].id = t;
+        workers[t].nthreads = nthreads;
+    }
+
+    seq[0] = 0;
+    for(int i=0; i<n; i++){
+        seq[i+1] = tsp_inst.best_solution.path[seq[i]];
+    }
+
+    double total = 0.0;
+    int pass;
+    for(pass=0; pass<BS_MAX_PASSES; pass++){
+        double gain = 0.0;
+
+        for(int cut=0; cut<2; cut++){
+            // the tour is rotated by half a segment at each round, so the endpoints of the segments move
+            int shift = (seglen - 1) / 2;
+            for(int i=0; i<n; i++){
+                tmp[i] = seq[(i + shift) % n];
+            }
+            memcpy(seq, tmp, n * sizeof(int));
+            seq[n] = seq[0];
+
+            if(nthreads == 1){
+                bs_thread(&workers[0]);
+            }else{
+                for(int t=0; t<nthreads; t++){
+                    pthread_create(&threads[t], NULL, bs_thread, &workers[t]);
+                }
+                for(int t=0; t<nthreads; t++){
+                    pthread_join(threads[t], NULL);
+                }
+            }
+            for(int t=0; t<nthreads; t++){
+                gain += workers[t].gain;
+            }
+        }
+
+        total += gain;
+        log_debug("Balas-Simonetti pass %d: gain %.2f", pass, gain);
+        if(gain < BS_EPS){
+            break;
+        }
+        // the polish runs after the algorithm, so the time limit only stops the passes after the first
+        if(dl_expired()){
+            log_warn("time limit reached in Balas-Simonetti");
+            break;
+        }
+    }
+
+    if(total < BS_EPS){
+        log_info("Balas-Simonetti did not improve the solution");
+        goto bs_free;
+    }
+
+    for(int i=0; i<n; i++){
+        solution.path[seq[i]] = seq[i+1];
+    }
+    solution.cost = tsp_solution_cost(solution.path);
+
+    log_info("Balas-Simonetti improved the solution by %.2f in %d passes", total, pass + 1);
+
+    e = tsp_update_best_solution(&solution);
+    if(e == CANCELLED){
+        e = T_OK;
+    }
+
+bs_free:
+    for(int t=0; t<nthreads && workers != NULL; t++){
+        bs_workspace_free(&workers[t].ws);
+    }
+    utils_safe_free(seq);
+    utils_safe_free(tmp);
+    utils_safe_free(threads);
+    utils_safe_free(workers);
+    utils_safe_free(solution.path);
+    utils_safe_free(solution.comp);
+
+    return e;
+}
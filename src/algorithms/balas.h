@@ -0,0 +1,98 @@
+#ifndef BALAS_H_
+#define BALAS_H_
+
+/**
+ * @file balas.h
+ * @brief Balas-Simonetti dynamic programming to polish a tour. Among all the tours where a node at position i comes
+ *        before a node at position j whenever j >= i+k (so no node moves more than k places) it finds the best one in
+ *        O(n k 2^k). The tour is cut into segments with fixed endpoints that are solved in parallel, then cut again
+ *        with shifted endpoints so that the seams can move too
+ * @version 0.1
+ * @date 2024-06-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <pthread.h>
+
+#include "../tsp.h"
+
+#define BS_MAX_K 10                 // the states of a segment grow as 2^k, above this the polish is not cheap anymore
+#define BS_SEGMENT 1000             // maximum length of a segment
+#define BS_MAX_PASSES 10            // each pass solves all the segments twice, with two different cuts
+#define BS_EPS 1.0E-6
+
+/**
+ * @brief Workspace of a thread, holds the states of one segment
+ *
+ */
+typedef struct {
+    int k;
+    double* cost;                   // (k+1) levels of 2^(k-1) * 2k states, levels are reused as the segment is scanned
+    signed char* pred;              // BS_SEGMENT+1 levels of 2^(k-1) * 2k predecessors
+    int* buffer;                    // reordered segment
+} bs_workspace;
+
+/**
+ * @brief Segments assigned to a thread
+ *
+ */
+typedef struct {
+    int* seq;                       // tour as a sequence of n+1 nodes, the first one repeated at the end
+    int nsegments;
+    int seglen;                     // segment s covers positions s*(seglen-1) .. (s+1)*(seglen-1)
+    int last;                       // last position of the sequence
+    int id;                         // thread id
+    int nthreads;
+    bs_workspace ws;
+    double gain;                    // improvement found by the thread
+    ERROR_CODE error;
+} bs_worker;
+
+/**
+ * @brief Polishes the best solution with the Balas-Simonetti neighbourhood of size tsp_env.bs_k
+ *
+ * @return ERROR_CODE
+ */
+ERROR_CODE bs_Polish(void);
+
+//================================================================================
+// BALAS-SIMONETTI UTILS
+//================================================================================
+
+/**
+ * @brief Allocates the workspace of a thread
+ *
+ * @param ws Workspace
+ * @param k Size of the neighbourhood
+ * @return ERROR_CODE
+ */
+ERROR_CODE bs_workspace_init(bs_workspace* ws, int k);
+
+/**
+ * @brief Frees the workspace of a thread
+ *
+ * @param ws Workspace
+ */
+void bs_workspace_free(bs_workspace* ws);
+
+/**
+ * @brief Finds the best reordering of a path where the first and last node stay in place and no node moves more than
+ *        k places, the path is rewritten in place
+ *
+ * @param ws Workspace
+ * @param path Nodes of the path
+ * @param len Length of the path, at most BS_SEGMENT
+ * @return double Improvement of the path cost, 0 if the path is already optimal
+ */
+double bs_segment(bs_workspace* ws, int* path, int len);
+
+/**
+ * @brief Main function of a thread, polishes its segments
+ *
+ * @param arg bs_worker pointer
+ * @return void* NULL
+ */
+void* bs_thread(void* arg);
+
+#endif
@@ -0,0 +1,505 @@
+#include "bnb.h"
+
+//================================================================================
+// SUBPROBLEMS
+//================================================================================
+
+bnb_node* bnb_node_new(int nnodes){
+    bnb_node* node = (bnb_node*) malloc(sizeof(bnb_node));
+    if(node == NULL){
+        return NULL;
+    }
+
+    node->fixed = (signed char*) calloc(nnodes * nnodes, sizeof(signed char));
+    node->pi = (double*) calloc(nnodes, sizeof(double));
+    node->bound = -__DBL_MAX__;
+    node->depth = 0;
+    if(node->fixed == NULL || node->pi == NULL){
+        bnb_node_free(node);
+        return NULL;
+    }
+
+    return node;
+}
+
+void bnb_node_free(bnb_node* node){
+    if(node == NULL){
+        return;
+    }
+    utils_safe_free(node->fixed);
+    utils_safe_free(node->pi);
+    free(node);
+}
+
+// copy of a subproblem, used to create the children
+static bnb_node* bnb_node_copy(const bnb_node* node, const double* pi, double bound){
+    int n = tsp_inst.nnodes;
+    bnb_node* child = bnb_node_new(n);
+    if(child == NULL){
+        return NULL;
+    }
+
+    memcpy(child->fixed, node->fixed, n * n * sizeof(signed char));
+    memcpy(child->pi, pi, n * sizeof(double));
+    child->bound = bound;
+    child->depth = node->depth + 1;
+
+    return child;
+}
+
+// sets the state of edge i-j in both directions
+static void bnb_set(bnb_node* node, int i, int j, signed char state){
+    int n = tsp_inst.nnodes;
+    node->fixed[i * n + j] = state;
+    node->fixed[j * n + i] = state;
+}
+
+// excludes the free edges of v if it already has two included edges, returns false if v cannot have degree 2
+static bool bnb_propagate(bnb_node* node, int v){
+    int n = tsp_inst.nnodes;
+    int included = 0, available = 0;
+    for(int u=0; u<n; u++){
+        if(u == v){
+            continue;
+        }
+        included += (node->fixed[v * n + u] == OT_INCLUDED);
+        available += (node->fixed[v * n + u] != OT_EXCLUDED);
+    }
+
+    if(included > 2 || available < 2){
+        return false;
+    }
+
+    if(included == 2){
+        for(int u=0; u<n; u++){
+            if(u != v && node->fixed[v * n + u] == OT_FREE){
+                bnb_set(node, v, u, OT_EXCLUDED);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool bnb_fix_edge(bnb_node* node, int i, int j, signed char state){
+    bnb_set(node, i, j, state);
+    return bnb_propagate(node, i) && bnb_propagate(node, j);
+}
+
+//================================================================================
+// DEQUES
+//================================================================================
+
+static ERROR_CODE bnb_push(bnb_shared* shared, int id, bnb_node* node){
+    bnb_deque* d = &shared->deques[id];
+
+    pthread_mutex_lock(&d->lock);
+    if(d->size == d->capacity){
+        int capacity = max(16, 2 * d->capacity);
+        bnb_node** items = (bnb_node**) realloc(d->items, capacity * sizeof(bnb_node*));
+        if(items == NULL){
+            pthread_mutex_unlock(&d->lock);
+            log_error("error in growing the deque");
+            return RESOURCE_EXHAUSTED;
+        }
+        d->items = items;
+        d->capacity = capacity;
+    }
+    d->items[d->size++] = node;
+    pthread_mutex_unlock(&d->lock);
+
+    pthread_mutex_lock(&shared->lock);
+    shared->pending++;
+    pthread_mutex_unlock(&shared->lock);
+
+    return T_OK;
+}
+
+// newest subproblem of the own deque, so that each thread goes depth-first
+static bnb_node* bnb_pop(bnb_deque* d){
+    bnb_node* node = NULL;
+
+    pthread_mutex_lock(&d->lock);
+    if(d->size > 0){
+        node = d->items[--d->size];
+    }
+    pthread_mutex_unlock(&d->lock);
+
+    return node;
+}
+
+// oldest subproblem of another deque, i.e. the root of the largest unexplored subtree
+static bnb_node* bnb_steal(bnb_shared* shared, int id){
+    for(int k=1; k<shared->nthreads; k++){
+        bnb_deque* d = &shared->deques[(id + k) % shared->nthreads];
+
+        bnb_node* node = NULL;
+        pthread_mutex_lock(&d->lock);
+        if(d->size > 0){
+            node = d->items[0];
+            memmove(d->items, d->items + 1, (d->size - 1) * sizeof(bnb_node*));
+            d->size--;
+        }
+        pthread_mutex_unlock(&d->lock);
+
+        if(node != NULL){
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+//================================================================================
+// BRANCH-AND-BOUND
+//================================================================================
+
+// the 1-tree is a tour: save it if it improves the incumbent
+static void bnb_update_incumbent(bnb_shared* shared, const ot_tree* tree){
+    int n = tsp_inst.nnodes;
+
+    // adjacency of the 1-tree, every node has degree 2
+    int* adj = (int*) malloc(2 * n * sizeof(int));
+    int* cnt = (int*) calloc(n, sizeof(int));
+    tsp_solution solution;
+    tsp_init_solution(n, &solution);
+    if(adj == NULL || cnt == NULL || solution.path == NULL){
+        log_error("error in allocating memory for the incumbent");
+        goto bnb_free_inc;
+    }
+
+    for(int v=1; v<n; v++){
+        int p = tree->parent[v];
+        if(p >= 0){
+            adj[2 * v + cnt[v]++] = p;
+            adj[2 * p + cnt[p]++] = v;
+        }
+    }
+    adj[0] = tree->first;
+    adj[1] = tree->second;
+    adj[2 * tree->first + cnt[tree->first]++] = 0;
+    adj[2 * tree->second + cnt[tree->second]++] = 0;
+
+    int prev = 0, curr = tree->first;
+    solution.path[0] = tree->first;
+    solution.cost = tsp_get_cost(0, tree->first);
+    while(curr != 0){
+        int next = (adj[2 * curr] != prev) ? adj[2 * curr] : adj[2 * curr + 1];
+        solution.path[curr] = next;
+        solution.cost += tsp_get_cost(curr, next);
+        prev = curr;
+        curr = next;
+    }
+
+    pthread_mutex_lock(&shared->lock);
+    if(solution.cost < shared->ub && err_ok(tsp_update_best_solution(&solution))){
+        shared->ub = solution.cost;
+        log_info("branch-and-bound: new incumbent %.2f", solution.cost);
+    }
+    pthread_mutex_unlock(&shared->lock);
+
+bnb_free_inc:
+    utils_safe_free(adj);
+    utils_safe_free(cnt);
+    utils_safe_free(solution.path);
+    utils_safe_free(solution.comp);
+}
+
+static double bnb_get_ub(bnb_shared* shared){
+    pthread_mutex_lock(&shared->lock);
+    double ub = shared->ub;
+    pthread_mutex_unlock(&shared->lock);
+    return ub;
+}
+
+// costs are rounded to integers, so a subproblem is useless if it cannot go below ub - 1
+static bool bnb_prunable(double bound, double ub){
+    return ceil(bound - BNB_EPS) >= ub - BNB_EPS;
+}
+
+ERROR_CODE bnb_process(bnb_worker* w, bnb_node* node, ot_tree* tree, double* pi, double* best_pi){
+    int n = tsp_inst.nnodes;
+    ERROR_CODE e = T_OK;
+
+    memcpy(pi, node->pi, n * sizeof(double));
+    memcpy(best_pi, node->pi, n * sizeof(double));
+    double best = node->bound;
+    double lambda = BNB_LAMBDA;
+    int stall = 0;
+
+    // subgradient ascent warm started from the penalties of the parent
+    for(int iter=0; iter<BNB_NODE_ITERS; iter++){
+        e = ot_compute_fixed(tree, pi, node->fixed);
+        if(e == NOT_FOUND){
+            return T_OK;
+        }
+        if(!err_ok(e)){
+            return e;
+        }
+
+        double ub = bnb_get_ub(w->shared);
+
+        if(tree->value > best + BNB_EPS){
+            best = tree->value;
+            memcpy(best_pi, pi, n * sizeof(double));
+            stall = 0;
+        }else if(++stall >= BNB_STALL_ITERS){
+            lambda /= 2.0;
+            stall = 0;
+        }
+
+        if(bnb_prunable(best, ub)){
+            return T_OK;
+        }
+
+        int norm = 0;
+        for(int i=0; i<n; i++){
+            norm += (tree->degree[i] - 2) * (tree->degree[i] - 2);
+        }
+        if(norm == 0){
+            // optimal tour of the subproblem
+            bnb_update_incumbent(w->shared, tree);
+            return T_OK;
+        }
+
+        double t = lambda * (ub - tree->value) / norm;
+        for(int i=0; i<n; i++){
+            pi[i] += t * (tree->degree[i] - 2);
+        }
+    }
+
+    // branch on the 1-tree of the best penalties
+    e = ot_compute_fixed(tree, best_pi, node->fixed);
+    if(e == NOT_FOUND){
+        return T_OK;
+    }
+    if(!err_ok(e)){
+        return e;
+    }
+
+    // node with the highest degree, at least 3 otherwise the 1-tree would be a tour
+    int v = 0;
+    for(int i=1; i<n; i++){
+        if(tree->degree[i] > tree->degree[v]){
+            v = i;
+        }
+    }
+    if(tree->degree[v] <= 2){
+        bnb_update_incumbent(w->shared, tree);
+        return T_OK;
+    }
+
+    // most expensive free edge of the 1-tree incident to v
+    int u = -1;
+    double maxcost = -__DBL_MAX__;
+    for(int i=0; i<n; i++){
+        if(i == v || node->fixed[v * n + i] != OT_FREE){
+            continue;
+        }
+        bool intree = (tree->parent[i] == v) || (tree->parent[v] == i) ||
+                      (v == 0 && (i == tree->first || i == tree->second)) ||
+                      (i == 0 && (v == tree->first || v == tree->second));
+        if(intree && tsp_get_cost(v, i) > maxcost){
+            maxcost = tsp_get_cost(v, i);
+            u = i;
+        }
+    }
+    if(u < 0){
+        // v has more than two included edges, cannot happen after bnb_fix_edge
+        return T_OK;
+    }
+
+    bnb_node* include = bnb_node_copy(node, best_pi, best);
+    bnb_node* exclude = bnb_node_copy(node, best_pi, best);
+    if(include == NULL || exclude == NULL){
+        log_error("error in allocating the children");
+        bnb_node_free(include);
+        bnb_node_free(exclude);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    // the excluded child is pushed last so that it is explored first: it lowers the degree of v
+    if(bnb_fix_edge(include, v, u, OT_INCLUDED)){
+        e = bnb_push(w->shared, w->id, include);
+        if(!err_ok(e)){
+            bnb_node_free(include);
+            bnb_node_free(exclude);
+            return e;
+        }
+    }else{
+        bnb_node_free(include);
+    }
+
+    if(bnb_fix_edge(exclude, v, u, OT_EXCLUDED)){
+        e = bnb_push(w->shared, w->id, exclude);
+        if(!err_ok(e)){
+            bnb_node_free(exclude);
+            return e;
+        }
+    }else{
+        bnb_node_free(exclude);
+    }
+
+    return T_OK;
+}
+
+void* bnb_thread(void* arg){
+    bnb_worker* w = (bnb_worker*) arg;
+    bnb_shared* shared = w->shared;
+    int n = tsp_inst.nnodes;
+
+    ot_tree tree;
+    double* pi = (double*) malloc(n * sizeof(double));
+    double* best_pi = (double*) malloc(n * sizeof(double));
+    ERROR_CODE e = ot_init(&tree, n);
+    if(!err_ok(e) || pi == NULL || best_pi == NULL){
+        pthread_mutex_lock(&shared->lock);
+        shared->error = RESOURCE_EXHAUSTED;
+        shared->stop = true;
+        pthread_mutex_unlock(&shared->lock);
+        goto bnb_free_thread;
+    }
+
+    while(1){
+        pthread_mutex_lock(&shared->lock);
+        bool done = shared->stop || shared->pending == 0;
+        pthread_mutex_unlock(&shared->lock);
+        if(done){
+            break;
+        }
+
+        if(dl_expired()){
+            pthread_mutex_lock(&shared->lock);
+            if(err_ok(shared->error)){
+                shared->error = DEADLINE_EXCEEDED;
+            }
+            shared->stop = true;
+            pthread_mutex_unlock(&shared->lock);
+            break;
+        }
+
+        bnb_node* node = bnb_pop(&shared->deques[w->id]);
+        if(node == NULL){
+            node = bnb_steal(shared, w->id);
+        }
+        if(node == NULL){
+            // other threads are still working and may push new subproblems
+            sched_yield();
+            continue;
+        }
+
+        e = bnb_process(w, node, &tree, pi, best_pi);
+        bnb_node_free(node);
+
+        pthread_mutex_lock(&shared->lock);
+        shared->pending--;
+        shared->explored++;
+        if(!err_ok(e)){
+            shared->error = e;
+            shared->stop = true;
+        }
+        pthread_mutex_unlock(&shared->lock);
+    }
+
+bnb_free_thread:
+    ot_free(&tree);
+    utils_safe_free(pi);
+    utils_safe_free(best_pi);
+
+    return NULL;
+}
+
+ERROR_CODE bnb_Solve(void){
+    ERROR_CODE e = T_OK;
+    int n = tsp_inst.nnodes;
+
+    log_info("running 1-tree branch-and-bound");
+
+    if(n > BNB_MAX_NODES){
+        log_warn("branch-and-bound is meant for instances with at most %d nodes, it may not finish", BNB_MAX_NODES);
+    }
+
+    // incumbent from the heuristic
+    e = h_greedy_2opt();
+    if(!err_ok(e)){
+        log_error("error in 2opt greedy incumbent");
+        return e;
+    }
+
+    // root penalties
+    e = ot_HeldKarp(tsp_inst.best_solution.cost);
+    if(!err_ok(e)){
+        log_error("error in Held-Karp bound at the root");
+        return e;
+    }
+
+    if(bnb_prunable(tsp_inst.lower_bound, tsp_inst.best_solution.cost)){
+        log_info("the heuristic tour matches the Held-Karp bound");
+        return T_OK;
+    }
+
+    bnb_shared shared;
+    shared.nthreads = max(1, tsp_env.threads);
+    shared.pending = 0;
+    shared.explored = 0;
+    shared.ub = tsp_inst.best_solution.cost;
+    shared.error = T_OK;
+    shared.stop = false;
+    pthread_mutex_init(&shared.lock, NULL);
+
+    shared.deques = (bnb_deque*) calloc(shared.nthreads, sizeof(bnb_deque));
+    bnb_worker* workers = (bnb_worker*) calloc(shared.nthreads, sizeof(bnb_worker));
+    pthread_t* threads = (pthread_t*) calloc(shared.nthreads, sizeof(pthread_t));
+    if(shared.deques == NULL || workers == NULL || threads == NULL){
+        log_error("error in allocating the threads");
+        e = RESOURCE_EXHAUSTED;
+        goto bnb_free;
+    }
+    for(int i=0; i<shared.nthreads; i++){
+        pthread_mutex_init(&shared.deques[i].lock, NULL);
+    }
+
+    bnb_node* root = bnb_node_new(n);
+    if(root == NULL){
+        log_error("error in allocating the root");
+        e = RESOURCE_EXHAUSTED;
+        goto bnb_free;
+    }
+    memcpy(root->pi, tsp_inst.hk_pi, n * sizeof(double));
+    root->bound = tsp_inst.lower_bound;
+    e = bnb_push(&shared, 0, root);
+    if(!err_ok(e)){
+        bnb_node_free(root);
+        goto bnb_free;
+    }
+
+    for(int i=0; i<shared.nthreads; i++){
+        workers[i].id = i;
+        workers[i].shared = &shared;
+        pthread_create(&threads[i], NULL, bnb_thread, &workers[i]);
+    }
+    for(int i=0; i<shared.nthreads; i++){
+        pthread_join(threads[i], NULL);
+    }
+
+    e = shared.error;
+    log_info("branch-and-bound: %ld subproblems explored with %d threads, best tour %.2f", shared.explored, shared.nthreads, shared.ub);
+
+bnb_free:
+    if(shared.deques != NULL){
+        for(int i=0; i<shared.nthreads; i++){
+            bnb_node* node;
+            while((node = bnb_pop(&shared.deques[i])) != NULL){
+                bnb_node_free(node);
+            }
+            utils_safe_free(shared.deques[i].items);
+            pthread_mutex_destroy(&shared.deques[i].lock);
+        }
+    }
+    utils_safe_free(shared.deques);
+    utils_safe_free(workers);
+    utils_safe_free(threads);
+    pthread_mutex_destroy(&shared.lock);
+
+    return e;
+}
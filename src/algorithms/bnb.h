@@ -0,0 +1,133 @@
+#ifndef BNB_H_
+#define BNB_H_
+
+/**
+ * @file bnb.h
+ * @brief Exact branch-and-bound without CPLEX, meant for small instances. Bounds come from 1-trees with Lagrangian
+ *        penalties, branching includes or excludes one edge. The subproblems are explored depth-first by a pool of
+ *        threads, each one with its own deque: a thread takes the newest subproblem from its deque and, when it is
+ *        empty, steals the oldest one from another thread
+ * @version 0.1
+ * @date 2024-06-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <pthread.h>
+#include <sched.h>
+
+#include "heuristics.h"
+#include "onetree.h"
+
+#define BNB_MAX_NODES 150           // above this size a warning is printed, the solver is not meant for large instances
+#define BNB_NODE_ITERS 30           // subgradient iterations at each subproblem
+#define BNB_LAMBDA 0.5              // initial Polyak step coefficient at each subproblem
+#define BNB_STALL_ITERS 3           // iterations without improvement before halving the coefficient
+#define BNB_EPS 1.0E-6
+
+/**
+ * @brief Subproblem of the branch-and-bound tree
+ *
+ */
+typedef struct {
+    signed char* fixed;             // n*n state of each edge: OT_FREE, OT_INCLUDED or OT_EXCLUDED
+    double* pi;                     // penalties inherited from the parent, used as warm start
+    double bound;                   // bound of the parent
+    int depth;
+} bnb_node;
+
+/**
+ * @brief Deque of subproblems owned by a thread
+ *
+ */
+typedef struct {
+    bnb_node** items;
+    int size;
+    int capacity;
+    pthread_mutex_t lock;
+} bnb_deque;
+
+/**
+ * @brief Data shared by all the threads
+ *
+ */
+typedef struct {
+    int nthreads;
+    bnb_deque* deques;
+
+    pthread_mutex_t lock;           // protects the fields below
+    long pending;                   // subproblems queued or being processed, the search ends when it reaches 0
+    long explored;                  // number of subproblems processed
+    double ub;                      // cost of the incumbent
+    ERROR_CODE error;               // first error met by a thread
+    bool stop;
+} bnb_shared;
+
+/**
+ * @brief Arguments of a worker thread
+ *
+ */
+typedef struct {
+    int id;
+    bnb_shared* shared;
+} bnb_worker;
+
+/**
+ * @brief Solves the TSP to optimality with the 1-tree branch-and-bound
+ *
+ * @return ERROR_CODE
+ */
+ERROR_CODE bnb_Solve(void);
+
+//================================================================================
+// BRANCH-AND-BOUND UTILS
+//================================================================================
+
+/**
+ * @brief Allocates a subproblem
+ *
+ * @param nnodes Number of nodes
+ * @return bnb_node* NULL if the allocation fails
+ */
+bnb_node* bnb_node_new(int nnodes);
+
+/**
+ * @brief Frees a subproblem
+ *
+ * @param node Subproblem
+ */
+void bnb_node_free(bnb_node* node);
+
+/**
+ * @brief Fixes the state of edge i-j. When a node reaches two included edges all its other free edges are excluded
+ *
+ * @param node Subproblem
+ * @param i First node of the edge
+ * @param j Second node of the edge
+ * @param state OT_INCLUDED or OT_EXCLUDED
+ * @return true If the subproblem can still contain a tour
+ * @return false If the fixings are infeasible
+ */
+bool bnb_fix_edge(bnb_node* node, int i, int j, signed char state);
+
+/**
+ * @brief Bounds a subproblem and, if it cannot be pruned, pushes its two children in the deque of the thread
+ *
+ * @param w Worker
+ * @param node Subproblem
+ * @param tree 1-tree workspace of the thread
+ * @param pi Penalties workspace of the thread
+ * @param best_pi Penalties workspace of the thread
+ * @return ERROR_CODE
+ */
+ERROR_CODE bnb_process(bnb_worker* w, bnb_node* node, ot_tree* tree, double* pi, double* best_pi);
+
+/**
+ * @brief Main loop of a worker thread
+ *
+ * @param arg bnb_worker pointer
+ * @return void* NULL
+ */
+void* bnb_thread(void* arg);
+
+#endif
@@ -0,0 +1,151 @@
+#include "candidates.h"
+
+// inserts node in the list sorted by increasing key, keeping at most k elements
+static void cand_insert(int* list, double* key, int* size, int k, int node, double value){
+    if(*size == k && value >= key[k-1]){
+        return;
+    }
+
+    int pos = (*size < k) ? (*size)++ : k - 1;
+    while(pos > 0 && key[pos-1] > value){
+        list[pos] = list[pos-1];
+        key[pos] = key[pos-1];
+        pos--;
+    }
+    list[pos] = node;
+    key[pos] = value;
+}
+
+// allocates tsp_inst.cand for k candidates per node
+static ERROR_CODE cand_alloc(int k){
+    cand_free();
+
+    tsp_inst.cand = (int*) malloc(tsp_inst.nnodes * k * sizeof(int));
+    if(tsp_inst.cand == NULL){
+        log_error("error in allocating the candidate lists");
+        return RESOURCE_EXHAUSTED;
+    }
+    tsp_inst.ncand = k;
+
+    return T_OK;
+}
+
+ERROR_CODE cand_build(void){
+    // at least one other node must remain outside the list for a move to make sense
+    int k = (tsp_env.cand_k < tsp_inst.nnodes - 2) ? tsp_env.cand_k : tsp_inst.nnodes - 2;
+    if(tsp_env.cand == CAND_NONE || k <= 0){
+        return T_OK;
+    }
+
+    switch (tsp_env.cand)
+    {
+    case CAND_KNN:
+        return cand_knn(k);
+    case CAND_ALPHA:
+        return cand_alpha(k);
+    default:
+        log_error("candidate type not recognized");
+        return INVALID_ARGUMENT;
+    }
+}
+
+ERROR_CODE cand_knn(int k){
+    int n = tsp_inst.nnodes;
+
+    ERROR_CODE e = cand_alloc(k);
+    if(!err_ok(e)){
+        return e;
+    }
+
+    double* key = (double*) malloc(k * sizeof(double));
+    if(key == NULL){
+        log_error("error in allocating memory for knn");
+        cand_free();
+        return RESOURCE_EXHAUSTED;
+    }
+
+    for(int i=0; i<n; i++){
+        int size = 0;
+        for(int j=0; j<n; j++){
+            if(j != i){
+                cand_insert(&tsp_inst.cand[i * k], key, &size, k, j, tsp_get_cost(i, j));
+            }
+        }
+    }
+
+    utils_safe_free(key);
+
+    log_info("built %d nearest neighbour candidates per node", k);
+
+    return T_OK;
+}
+
+ERROR_CODE cand_alpha(int k){
+    ERROR_CODE e = T_OK;
+    int n = tsp_inst.nnodes;
+
+    if(tsp_inst.hk_pi == NULL){
+        e = ot_HeldKarp(-1.0);
+        if(!err_ok(e)){
+            log_error("Held-Karp bound not available for alpha-nearness");
+            return e;
+        }
+    }
+    const double* pi = tsp_inst.hk_pi;
+
+    ot_tree tree;
+    e = ot_init(&tree, n);
+    if(!err_ok(e)){
+        return e;
+    }
+
+    double* alpha = (double*) malloc(n * sizeof(double));
+    int* mark = (int*) malloc(n * sizeof(int));
+    double* key = (double*) malloc(k * sizeof(double));
+    if(alpha == NULL || mark == NULL || key == NULL){
+        log_error("error in allocating memory for alpha-nearness");
+        e = RESOURCE_EXHAUSTED;
+        goto cand_free_all;
+    }
+
+    e = ot_compute(&tree, pi);
+    if(!err_ok(e)){
+        log_error("error in computing the 1-tree");
+        goto cand_free_all;
+    }
+
+    e = cand_alloc(k);
+    if(!err_ok(e)){
+        goto cand_free_all;
+    }
+
+    for(int i=0; i<n; i++){
+        mark[i] = -1;
+    }
+
+    for(int a=0; a<n; a++){
+        ot_alpha_row(&tree, pi, a, alpha, mark);
+
+        int size = 0;
+        for(int b=0; b<n; b++){
+            if(b != a){
+                cand_insert(&tsp_inst.cand[a * k], key, &size, k, b, alpha[b]);
+            }
+        }
+    }
+
+    log_info("built %d alpha-nearness candidates per node", k);
+
+cand_free_all:
+    utils_safe_free(alpha);
+    utils_safe_free(mark);
+    utils_safe_free(key);
+    ot_free(&tree);
+
+    return e;
+}
+
+void cand_free(void){
+    utils_safe_free(tsp_inst.cand);
+    tsp_inst.ncand = 0;
+}
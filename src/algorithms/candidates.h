@@ -0,0 +1,48 @@
+#ifndef CANDIDATES_H_
+#define CANDIDATES_H_
+
+/**
+ * @file candidates.h
+ * @brief Candidate lists for the local searches: for each node, the ncand most promising neighbours.
+ *        The lists are saved row-major in tsp_inst.cand, tsp_inst.cand[i * tsp_inst.ncand + k] is the k-th candidate of node i
+ * @version 0.1
+ * @date 2024-06-14
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "onetree.h"
+
+/**
+ * @brief Builds the candidate lists chosen with -cand, does nothing if they are disabled
+ *
+ * @return ERROR_CODE
+ */
+ERROR_CODE cand_build(void);
+
+/**
+ * @brief Candidates are the k nearest neighbours of each node
+ *
+ * @param k Number of candidates per node
+ * @return ERROR_CODE
+ */
+ERROR_CODE cand_knn(int k);
+
+/**
+ * @brief Candidates are the k alpha-nearest neighbours of each node, where alpha(i,j) is the increase of the cost of the
+ *        minimum 1-tree when edge i-j is forced in. The 1-tree is computed on the Held-Karp penalized costs, so the
+ *        bound is computed first if it is not available. Alpha values are computed in O(n^2) time and O(n) memory
+ *        visiting the tree in topological order
+ *
+ * @param k Number of candidates per node
+ * @return ERROR_CODE
+ */
+ERROR_CODE cand_alpha(int k);
+
+/**
+ * @brief Frees the candidate lists
+ *
+ */
+void cand_free(void);
+
+#endif
@@ -0,0 +1,804 @@
+#include "cluster.h"
+
+#define CL_NEXT(t, v) ((t)->tour[((t)->pos[(v)] + 1) % (t)->n])
+#define CL_PREV(t, v) ((t)->tour[((t)->pos[(v)] + (t)->n - 1) % (t)->n])
+
+// queue of the nodes whose neighbourhood has to be explored again
+typedef struct {
+    int* items;
+    bool* queued;
+    int head;
+    int count;
+    int capacity;
+} cl_queue;
+
+static void cl_push(cl_queue* q, int v){
+    if(q->queued[v]){
+        return;
+    }
+    q->items[(q->head + q->count) % q->capacity] = v;
+    q->count++;
+    q->queued[v] = true;
+}
+
+static int cl_pop(cl_queue* q){
+    int v = q->items[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+    q->queued[v] = false;
+    return v;
+}
+
+// inserts node in the list sorted by increasing key, keeping at most k elements
+static void cl_insert(int* list, double* key, int* size, int k, int node, double value){
+    if(*size == k && value >= key[k-1]){
+        return;
+    }
+
+    int pos = (*size < k) ? (*size)++ : k - 1;
+    while(pos > 0 && key[pos-1] > value){
+        list[pos] = list[pos-1];
+        key[pos] = key[pos-1];
+        pos--;
+    }
+    list[pos] = node;
+    key[pos] = value;
+}
+
+static double cl_cost(const cl_tour* t, int i, int j){
+    if((i == t->fix_a && j == t->fix_b) || (i == t->fix_b && j == t->fix_a)){
+        return CL_FIXED_COST;
+    }
+    return tsp_distance(&t->points[i], &t->points[j]);
+}
+
+//================================================================================
+// CLUSTER DECOMPOSITION
+//================================================================================
+
+// solves cluster c as a path from its entry to its exit
+static ERROR_CODE cl_solve_cluster(cl_shared* sh, int c){
+    int m = sh->begin[c+1] - sh->begin[c];
+    const int* nodes = sh->nodes + sh->begin[c];
+    int* out = sh->paths + sh->begin[c];
+
+    if(m <= 2){
+        out[0] = sh->entry[c];
+        out[m-1] = sh->exit[c];
+        return T_OK;
+    }
+
+    // only the points of the cluster are copied, memory stays proportional to its size
+    point* points = (point*) malloc(m * sizeof(point));
+    if(points == NULL){
+        log_error("error in allocating the points of cluster %d", c);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    int entry = -1, exit = -1;
+    for(int i=0; i<m; i++){
+        points[i] = tsp_inst.points[nodes[i]];
+        if(nodes[i] == sh->entry[c]){
+            entry = i;
+        }
+        if(nodes[i] == sh->exit[c]){
+            exit = i;
+        }
+    }
+
+    cl_tour t;
+    ERROR_CODE e = cl_tour_init(&t, points, m);
+    if(!err_ok(e)){
+        utils_safe_free(points);
+        return e;
+    }
+    t.fix_a = entry;
+    t.fix_b = exit;
+
+    e = cl_nearest_neighbour(&t, entry);
+    if(err_ok(e)){
+        e = cl_local_search(&t, NULL, 0);
+    }
+
+    if(err_ok(e)){
+        // the edge entry-exit is in the tour, the path leaves the entry from its other side
+        int p = t.pos[entry];
+        int step = (t.tour[(p + 1) % m] == exit) ? m - 1 : 1;
+        for(int i=0; i<m; i++){
+            out[i] = nodes[t.tour[(p + (long)i * step) % m]];
+        }
+    }
+
+    cl_tour_free(&t);
+    utils_safe_free(points);
+
+    return e;
+}
+
+void* cl_thread(void* arg){
+    cl_shared* sh = (cl_shared*) arg;
+
+    while(1){
+        pthread_mutex_lock(&sh->lock);
+        int c = sh->next++;
+        bool stop = (sh->error != T_OK);
+        pthread_mutex_unlock(&sh->lock);
+
+        if(stop || c >= sh->nclusters){
+            break;
+        }
+
+        ERROR_CODE e = cl_solve_cluster(sh, c);
+        if(!err_ok(e)){
+            pthread_mutex_lock(&sh->lock);
+            if(sh->error == T_OK){
+                sh->error = e;
+            }
+            pthread_mutex_unlock(&sh->lock);
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+// the nodes of cluster c closest to a point, without the excluded one
+static int cl_closest(const cl_shared* sh, int c, const point* target, int exclude, int* list, double* key){
+    int size = 0;
+    for(int i=sh->begin[c]; i<sh->begin[c+1]; i++){
+        int v = sh->nodes[i];
+        if(v == exclude){
+            continue;
+        }
+        double dx = tsp_inst.points[v].x - target->x;
+        double dy = tsp_inst.points[v].y - target->y;
+        cl_insert(list, key, &size, CL_BRIDGE, v, dx * dx + dy * dy);
+    }
+    return size;
+}
+
+// chooses the exit of cluster a and the entry of cluster b as the closest pair among the nodes facing each other
+static void cl_bridge(cl_shared* sh, int a, int b, const point* centroids){
+    int la[CL_BRIDGE], lb[CL_BRIDGE];
+    double key[CL_BRIDGE];
+
+    int sizea = sh->begin[a+1] - sh->begin[a];
+    int sizeb = sh->begin[b+1] - sh->begin[b];
+    int na = cl_closest(sh, a, &centroids[b], (sizea > 1) ? sh->entry[a] : -1, la, key);
+    int nb = cl_closest(sh, b, &centroids[a], (sizeb > 1) ? sh->exit[b] : -1, lb, key);
+
+    double best = __DBL_MAX__;
+    for(int i=0; i<na; i++){
+        for(int j=0; j<nb; j++){
+            double d = tsp_distance(&tsp_inst.points[la[i]], &tsp_inst.points[lb[j]]);
+            if(d < best){
+                best = d;
+                sh->exit[a] = la[i];
+                sh->entry[b] = lb[j];
+            }
+        }
+    }
+
+    if(sizea == 1){
+        sh->entry[a] = sh->exit[a];
+    }
+    if(sizeb == 1){
+        sh->exit[b] = sh->entry[b];
+    }
+}
+
+ERROR_CODE cl_Solve(void){
+    ERROR_CODE e = T_OK;
+    int n = tsp_inst.nnodes;
+    int maxsize = tsp_env.cl_size;
+
+    log_info("running cluster decomposition");
+
+    if(n < 8){
+        log_error("cluster decomposition needs at least 8 nodes");
+        return FAILED_PRECONDITION;
+    }
+
+    int maxclusters = 2 * n / maxsize + 2;
+    cl_shared sh = {.nclusters = 0, .next = 0, .error = T_OK};
+    pthread_mutex_init(&sh.lock, NULL);
+    sh.nodes = (int*) malloc(n * sizeof(int));
+    sh.begin = (int*) malloc((maxclusters + 1) * sizeof(int));
+    sh.paths = (int*) malloc(n * sizeof(int));
+    sh.entry = (int*) malloc(maxclusters * sizeof(int));
+    sh.exit = (int*) malloc(maxclusters * sizeof(int));
+    point* centroids = (point*) calloc(maxclusters, sizeof(point));
+    int* order = (int*) malloc(maxclusters * sizeof(int));
+    int* clusterof = (int*) malloc(n * sizeof(int));
+    int* seeds = (int*) malloc(n * sizeof(int));
+    pthread_t* threads = (pthread_t*) calloc(tsp_env.threads, sizeof(pthread_t));
+    cl_tour global = {0};
+    tsp_solution solution;
+    tsp_init_solution(n, &solution);
+    if(sh.nodes == NULL || sh.begin == NULL || sh.paths == NULL || sh.entry == NULL || sh.exit == NULL ||
+       centroids == NULL || order == NULL || clusterof == NULL || seeds == NULL || threads == NULL || solution.path == NULL){
+        log_error("error in allocating memory for the cluster decomposition");
+        e = RESOURCE_EXHAUSTED;
+        goto cl_free;
+    }
+
+    for(int i=0; i<n; i++){
+        sh.nodes[i] = i;
+    }
+    cl_bisect(tsp_inst.points, sh.nodes, n, 0, maxsize, sh.begin, &sh.nclusters);
+    sh.begin[sh.nclusters] = n;
+    int k = sh.nclusters;
+
+    log_info("%d clusters of at most %d nodes", k, maxsize);
+
+    for(int c=0; c<k; c++){
+        int m = sh.begin[c+1] - sh.begin[c];
+        for(int i=sh.begin[c]; i<sh.begin[c+1]; i++){
+            clusterof[sh.nodes[i]] = c;
+            centroids[c].x += tsp_inst.points[sh.nodes[i]].x / m;
+            centroids[c].y += tsp_inst.points[sh.nodes[i]].y / m;
+        }
+        sh.entry[c] = -1;
+        sh.exit[c] = -1;
+        order[c] = c;
+    }
+
+    // order of the clusters, a TSP on the centroids. Bisection leaves them already close to each other
+    if(k >= 8){
+        cl_tour ct;
+        e = cl_tour_init(&ct, centroids, k);
+        if(!err_ok(e)){
+            goto cl_free;
+        }
+        e = cl_nearest_neighbour(&ct, 0);
+        if(err_ok(e)){
+            e = cl_local_search(&ct, NULL, 0);
+        }
+        memcpy(order, ct.tour, k * sizeof(int));
+        cl_tour_free(&ct);
+        if(!err_ok(e)){
+            goto cl_free;
+        }
+    }
+
+    if(k > 1){
+        for(int i=0; i<k; i++){
+            cl_bridge(&sh, order[i], order[(i + 1) % k], centroids);
+        }
+    }
+
+    // each cluster is solved by the first free thread
+    int nthreads = (tsp_env.threads < k) ? tsp_env.threads : k;
+    if(k == 1){
+        // a single cluster is the whole instance, solved as a tour by the global search below
+        memcpy(sh.paths, sh.nodes, n * sizeof(int));
+    }else if(nthreads == 1){
+        cl_thread(&sh);
+    }else{
+        for(int t=0; t<nthreads; t++){
+            pthread_create(&threads[t], NULL, cl_thread, &sh);
+        }
+        for(int t=0; t<nthreads; t++){
+            pthread_join(threads[t], NULL);
+        }
+    }
+    if(!err_ok(sh.error)){
+        log_error("code %d : error in solving the clusters", sh.error);
+        e = sh.error;
+        goto cl_free;
+    }
+
+    // global tour, the paths one after the other
+    e = cl_tour_init(&global, tsp_inst.points, n);
+    if(!err_ok(e)){
+        goto cl_free;
+    }
+    int p = 0;
+    for(int i=0; i<k; i++){
+        int c = order[i];
+        for(int j=sh.begin[c]; j<sh.begin[c+1]; j++){
+            global.tour[p] = sh.paths[j];
+            global.pos[sh.paths[j]] = p;
+            p++;
+        }
+    }
+
+    if(k == 1){
+        e = cl_nearest_neighbour(&global, 0);
+        if(!err_ok(e)){
+            goto cl_free;
+        }
+    }
+
+    for(int i=0; i<n; i++){
+        solution.path[global.tour[i]] = global.tour[(i + 1) % n];
+    }
+    solution.cost = tsp_solution_cost(solution.path);
+    log_info("clusters joined, cost %.2f", solution.cost);
+    e = tsp_update_best_solution(&solution);
+    if(!err_ok(e)){
+        log_error("code %d : error in updating the best solution of the cluster decomposition", e);
+        goto cl_free;
+    }
+
+    // the clusters are already locally optimal, the search starts from the nodes with neighbours in other clusters
+    int nseeds = 0;
+    for(int v=0; v<n; v++){
+        for(int h=0; h<CL_NCAND; h++){
+            int u = global.cand[v * CL_NCAND + h];
+            if(u >= 0 && clusterof[u] != clusterof[v]){
+                seeds[nseeds++] = v;
+                break;
+            }
+        }
+    }
+    log_info("global search from %d seam nodes", nseeds);
+
+    e = cl_local_search(&global, (k == 1) ? NULL : seeds, nseeds);
+
+    for(int i=0; i<n; i++){
+        solution.path[global.tour[i]] = global.tour[(i + 1) % n];
+    }
+    solution.cost = tsp_solution_cost(solution.path);
+    log_info("global search done, cost %.2f", solution.cost);
+
+    ERROR_CODE error = tsp_update_best_solution(&solution);
+    if(!err_ok(error)){
+        log_error("code %d : error in updating the best solution of the cluster decomposition", error);
+        e = error;
+    }
+
+cl_free:
+    pthread_mutex_destroy(&sh.lock);
+    cl_tour_free(&global);
+    utils_safe_free(sh.nodes);
+    utils_safe_free(sh.begin);
+    utils_safe_free(sh.paths);
+    utils_safe_free(sh.entry);
+    utils_safe_free(sh.exit);
+    utils_safe_free(centroids);
+    utils_safe_free(order);
+    utils_safe_free(clusterof);
+    utils_safe_free(seeds);
+    utils_safe_free(threads);
+    utils_safe_free(solution.path);
+    utils_safe_free(solution.comp);
+
+    return e;
+}
+
+//================================================================================
+// CLUSTER UTILS
+//================================================================================
+
+#define CL_COORD(v) (byx ? points[(v)].x : points[(v)].y)
+
+// quickselect: the node with the k-th smallest coordinate goes to nodes[k], smaller ones before and larger ones after
+static void cl_select(const point* points, int* nodes, int count, int k, bool byx){
+    int lo = 0, hi = count - 1;
+    while(lo < hi){
+        double pivot = CL_COORD(nodes[(lo + hi) / 2]);
+        int i = lo, j = hi;
+        while(i <= j){
+            while(CL_COORD(nodes[i]) < pivot){
+                i++;
+            }
+            while(CL_COORD(nodes[j]) > pivot){
+                j--;
+            }
+            if(i <= j){
+                int tmp = nodes[i];
+                nodes[i] = nodes[j];
+                nodes[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+        if(k <= j){
+            hi = j;
+        }else if(k >= i){
+            lo = i;
+        }else{
+            break;
+        }
+    }
+}
+
+void cl_bisect(const point* points, int* nodes, int count, int offset, int maxsize, int* begin, int* nclusters){
+    if(count <= maxsize){
+        begin[(*nclusters)++] = offset;
+        return;
+    }
+
+    double minx = __DBL_MAX__, maxx = -__DBL_MAX__, miny = __DBL_MAX__, maxy = -__DBL_MAX__;
+    for(int i=0; i<count; i++){
+        const point* p = &points[nodes[i]];
+        minx = (p->x < minx) ? p->x : minx;
+        maxx = (p->x > maxx) ? p->x : maxx;
+        miny = (p->y < miny) ? p->y : miny;
+        maxy = (p->y > maxy) ? p->y : maxy;
+    }
+
+    int half = count / 2;
+    cl_select(points, nodes, count, half, maxx - minx >= maxy - miny);
+
+    cl_bisect(points, nodes, half, offset, maxsize, begin, nclusters);
+    cl_bisect(points, nodes + half, count - half, offset + half, maxsize, begin, nclusters);
+}
+
+#undef CL_COORD
+
+ERROR_CODE cl_knn(const point* points, int n, int k, int* cand){
+    for(int i=0; i<n*k; i++){
+        cand[i] = -1;
+    }
+    if(n < 2){
+        return T_OK;
+    }
+
+    double minx = __DBL_MAX__, maxx = -__DBL_MAX__, miny = __DBL_MAX__, maxy = -__DBL_MAX__;
+    for(int i=0; i<n; i++){
+        minx = (points[i].x < minx) ? points[i].x : minx;
+        maxx = (points[i].x > maxx) ? points[i].x : maxx;
+        miny = (points[i].y < miny) ? points[i].y : miny;
+        maxy = (points[i].y > maxy) ? points[i].y : maxy;
+    }
+    double w = maxx - minx, h = maxy - miny;
+
+    // about two points per cell, with a bounded number of cells when the points lie on a thin strip
+    double cell = sqrt(w * h / (n / 2.0));
+    if(!(cell > 0.0)){
+        cell = max(w, h) / (n / 2.0);
+    }
+    if(!(cell > 0.0)){
+        cell = 1.0;
+    }
+    int gx, gy;
+    while(1){
+        gx = (int)(w / cell) + 1;
+        gy = (int)(h / cell) + 1;
+        if((long)gx * gy <= 4L * n){
+            break;
+        }
+        cell *= 2.0;
+    }
+
+    int* cellstart = (int*) calloc((size_t)gx * gy + 1, sizeof(int));
+    int* cellnodes = (int*) malloc(n * sizeof(int));
+    int* cellof = (int*) malloc(n * sizeof(int));
+    int* list = (int*) malloc(k * sizeof(int));
+    double* key = (double*) malloc(k * sizeof(double));
+    if(cellstart == NULL || cellnodes == NULL || cellof == NULL || list == NULL || key == NULL){
+        log_error("error in allocating the neighbour grid");
+        utils_safe_free(cellstart);
+        utils_safe_free(cellnodes);
+        utils_safe_free(cellof);
+        utils_safe_free(list);
+        utils_safe_free(key);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    // nodes sorted by cell
+    for(int i=0; i<n; i++){
+        int cx = (int)((points[i].x - minx) / cell);
+        int cy = (int)((points[i].y - miny) / cell);
+        cellof[i] = cy * gx + cx;
+        cellstart[cellof[i] + 1]++;
+    }
+    for(int c=0; c<gx*gy; c++){
+        cellstart[c+1] += cellstart[c];
+    }
+    for(int i=0; i<n; i++){
+        cellnodes[cellstart[cellof[i]]++] = i;
+    }
+    for(int c=gx*gy; c>0; c--){
+        cellstart[c] = cellstart[c-1];
+    }
+    cellstart[0] = 0;
+
+    for(int i=0; i<n; i++){
+        int cx = cellof[i] % gx, cy = cellof[i] / gx;
+        int size = 0;
+
+        // rings of cells around the cell of i, a point beyond ring r is at least r*cell far
+        for(int r=0; ; r++){
+            for(int y=cy-r; y<=cy+r; y++){
+                if(y < 0 || y >= gy){
+                    continue;
+                }
+                int stepx = (y == cy - r || y == cy + r) ? 1 : 2 * r;
+                for(int x=cx-r; x<=cx+r; x+=max(stepx, 1)){
+                    if(x < 0 || x >= gx){
+                        continue;
+                    }
+                    int c = y * gx + x;
+                    for(int s=cellstart[c]; s<cellstart[c+1]; s++){
+                        int j = cellnodes[s];
+                        if(j == i){
+                            continue;
+                        }
+                        double dx = points[j].x - points[i].x;
+                        double dy = points[j].y - points[i].y;
+                        cl_insert(list, key, &size, k, j, dx * dx + dy * dy);
+                    }
+                }
+            }
+
+            if(size == k && (r * cell) * (r * cell) >= key[k-1]){
+                break;
+            }
+            if(r > gx && r > gy){
+                break;
+            }
+        }
+
+        memcpy(&cand[(size_t)i * k], list, size * sizeof(int));
+    }
+
+    utils_safe_free(cellstart);
+    utils_safe_free(cellnodes);
+    utils_safe_free(cellof);
+    utils_safe_free(list);
+    utils_safe_free(key);
+
+    return T_OK;
+}
+
+//================================================================================
+// TOUR UTILS
+//================================================================================
+
+ERROR_CODE cl_tour_init(cl_tour* t, const point* points, int n){
+    t->n = n;
+    t->points = points;
+    t->fix_a = -1;
+    t->fix_b = -1;
+
+    t->tour = (int*) malloc(n * sizeof(int));
+    t->pos = (int*) malloc(n * sizeof(int));
+    t->cand = (int*) malloc((size_t)n * CL_NCAND * sizeof(int));
+    if(t->tour == NULL || t->pos == NULL || t->cand == NULL){
+        log_error("error in allocating the tour");
+        cl_tour_free(t);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    for(int i=0; i<n; i++){
+        t->tour[i] = i;
+        t->pos[i] = i;
+    }
+
+    ERROR_CODE e = cl_knn(points, n, CL_NCAND, t->cand);
+    if(!err_ok(e)){
+        cl_tour_free(t);
+    }
+    return e;
+}
+
+void cl_tour_free(cl_tour* t){
+    utils_safe_free(t->tour);
+    utils_safe_free(t->pos);
+    utils_safe_free(t->cand);
+}
+
+ERROR_CODE cl_nearest_neighbour(cl_tour* t, int start){
+    int n = t->n;
+    bool* visited = (bool*) calloc(n, sizeof(bool));
+    if(visited == NULL){
+        log_error("error in allocating memory for nearest neighbour");
+        return RESOURCE_EXHAUSTED;
+    }
+
+    int cur = start;
+    visited[cur] = true;
+    t->tour[0] = cur;
+    t->pos[cur] = 0;
+    for(int p=1; p<n; p++){
+        int next = -1;
+        if(cur == t->fix_a && !visited[t->fix_b]){
+            next = t->fix_b;
+        }else if(cur == t->fix_b && !visited[t->fix_a]){
+            next = t->fix_a;
+        }
+
+        // the neighbour lists are sorted, the first free one is the nearest
+        for(int h=0; h<CL_NCAND && next < 0; h++){
+            int c = t->cand[cur * CL_NCAND + h];
+            if(c >= 0 && !visited[c]){
+                next = c;
+            }
+        }
+
+        // all the neighbours are taken, scan every node
+        if(next < 0){
+            double best = __DBL_MAX__;
+            for(int v=0; v<n; v++){
+                if(!visited[v]){
+                    double d = tsp_distance(&t->points[cur], &t->points[v]);
+                    if(d < best){
+                        best = d;
+                        next = v;
+                    }
+                }
+            }
+        }
+
+        visited[next] = true;
+        t->tour[p] = next;
+        t->pos[next] = p;
+        cur = next;
+    }
+
+    utils_safe_free(visited);
+    return T_OK;
+}
+
+// reverses the tour between positions i and j included, or the rest of the tour if it is shorter
+static void cl_reverse(cl_tour* t, int i, int j){
+    int n = t->n;
+    int len = (j - i + n) % n + 1;
+    if(2 * len > n){
+        int ni = (j + 1) % n;
+        j = (i - 1 + n) % n;
+        i = ni;
+        len = n - len;
+    }
+
+    for(int s=0; s<len/2; s++){
+        int a = t->tour[i], b = t->tour[j];
+        t->tour[i] = b;
+        t->pos[b] = i;
+        t->tour[j] = a;
+        t->pos[a] = j;
+        i = (i + 1) % n;
+        j = (j - 1 + n) % n;
+    }
+}
+
+// replaces edges a-b and c-d with a-c and b-d, where b and d follow a and c in the same direction
+static void cl_move(cl_tour* t, int a, int b, int c, int d){
+    if(CL_NEXT(t, a) == b){
+        cl_reverse(t, t->pos[b], t->pos[c]);
+    }else{
+        cl_reverse(t, t->pos[a], t->pos[d]);
+    }
+}
+
+static bool cl_try_2opt(cl_tour* t, cl_queue* q, int a){
+    long evaluated = 0;
+    for(int dir=0; dir<2; dir++){
+        int a1 = (dir == 0) ? CL_NEXT(t, a) : CL_PREV(t, a);
+        double d1 = cl_cost(t, a, a1);
+
+        for(int h=0; h<CL_NCAND; h++){
+            int c = t->cand[a * CL_NCAND + h];
+            if(c < 0){
+                break;
+            }
+            double g1 = d1 - cl_cost(t, a, c);
+            if(g1 <= CL_EPS){
+                break;
+            }
+            int c1 = (dir == 0) ? CL_NEXT(t, c) : CL_PREV(t, c);
+            if(c == a1 || c1 == a){
+                continue;
+            }
+
+            evaluated++;
+            if(g1 + cl_cost(t, c, c1) - cl_cost(t, a1, c1) > CL_EPS){
+                cl_move(t, a, a1, c, c1);
+                cl_push(q, a1);
+                cl_push(q, c);
+                cl_push(q, c1);
+                st_add(ST_2OPT_EVALUATED, evaluated);
+                st_add(ST_2OPT_APPLIED, 1);
+                return true;
+            }
+        }
+    }
+
+    st_add(ST_2OPT_EVALUATED, evaluated);
+    return false;
+}
+
+static bool cl_try_oropt(cl_tour* t, cl_queue* q, int a){
+    int n = t->n;
+
+    // segment s1..s2 of 1 to 3 nodes starting at a, moved between two adjacent nodes u-v close to one of its ends
+    int s2 = a;
+    for(int len=1; len<=3; len++, s2=CL_NEXT(t, s2)){
+        int s1 = a;
+        int p = CL_PREV(t, s1), nx = CL_NEXT(t, s2);
+        double g0 = cl_cost(t, p, s1) + cl_cost(t, s2, nx) - cl_cost(t, p, nx);
+        if(g0 <= CL_EPS){
+            continue;
+        }
+
+        for(int end=0; end<2; end++){
+            int s = (end == 0) ? s1 : s2;
+            for(int h=0; h<CL_NCAND; h++){
+                int c = t->cand[s * CL_NCAND + h];
+                if(c < 0 || cl_cost(t, s, c) >= g0){
+                    break;
+                }
+
+                for(int side=0; side<2; side++){
+                    int u = (side == 0) ? c : CL_PREV(t, c);
+                    int v = (side == 0) ? CL_NEXT(t, c) : c;
+                    if((t->pos[u] - t->pos[s1] + n) % n < len || (t->pos[v] - t->pos[s1] + n) % n < len){
+                        continue;
+                    }
+
+                    double duv = cl_cost(t, u, v);
+                    double rev = cl_cost(t, u, s2) + cl_cost(t, s1, v) - duv;
+                    double fwd = cl_cost(t, u, s1) + cl_cost(t, s2, v) - duv;
+                    if(g0 - ((fwd < rev) ? fwd : rev) > CL_EPS){
+                        // p s1..s2 nx .. u v  ->  p u .. nx s2..s1 v  ->  p nx .. u s2..s1 v
+                        cl_move(t, p, s1, u, v);
+                        cl_move(t, p, u, nx, s2);
+                        if(fwd < rev){
+                            cl_move(t, u, s2, s1, v);
+                        }
+                        cl_push(q, p);
+                        cl_push(q, nx);
+                        cl_push(q, s2);
+                        cl_push(q, u);
+                        cl_push(q, v);
+                        st_add(ST_OROPT_APPLIED, 1);
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+ERROR_CODE cl_local_search(cl_tour* t, const int* seeds, int nseeds){
+    int n = t->n;
+    if(n < 8){
+        return T_OK;
+    }
+
+    cl_queue q = {.head = 0, .count = 0, .capacity = n};
+    q.items = (int*) malloc(n * sizeof(int));
+    q.queued = (bool*) calloc(n, sizeof(bool));
+    if(q.items == NULL || q.queued == NULL){
+        log_error("error in allocating the local search queue");
+        utils_safe_free(q.items);
+        utils_safe_free(q.queued);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    if(seeds == NULL){
+        for(int i=0; i<n; i++){
+            cl_push(&q, t->tour[i]);
+        }
+    }else{
+        for(int i=0; i<nseeds; i++){
+            cl_push(&q, seeds[i]);
+        }
+    }
+
+    ERROR_CODE e = T_OK;
+    struct timespec start = st_now();
+    while(q.count > 0){
+        if(dl_expired()){
+            log_debug("time limit exceeded in the cluster local search");
+            e = DEADLINE_EXCEEDED;
+            break;
+        }
+
+        int a = cl_pop(&q);
+        if(cl_try_2opt(t, &q, a) || cl_try_oropt(t, &q, a)){
+            cl_push(&q, a);
+        }
+    }
+    st_time(ST_TIME_REFINEMENT, &start);
+
+    utils_safe_free(q.items);
+    utils_safe_free(q.queued);
+
+    return e;
+}
@@ -0,0 +1,140 @@
+#ifndef CLUSTER_H_
+#define CLUSTER_H_
+
+/**
+ * @file cluster.h
+ * @brief Divide-and-conquer heuristic for very large instances. The points are split by recursive bisection into clusters
+ *        of at most tsp_env.cl_size nodes, the clusters are ordered by a TSP on their centroids and each one is solved
+ *        in parallel as a path between the nodes closest to the previous and next cluster. The paths are joined and
+ *        polished by 2-opt and Or-opt with neighbour lists, starting from the nodes on the seams. The cost matrix is
+ *        never stored, memory is linear in the number of nodes
+ * @version 0.1
+ * @date 2024-06-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <pthread.h>
+
+#include "../tsp.h"
+
+#define CL_NCAND 8                  // neighbours of each node in the local searches
+#define CL_BRIDGE 16                // nodes of a cluster considered to link it to the next one
+#define CL_FIXED_COST -1.0E9        // cost of the edge between entry and exit, so the local search never removes it
+#define CL_EPS 1.0E-6
+
+/**
+ * @brief Tour in array form over a set of points, with neighbour lists
+ *
+ */
+typedef struct {
+    int n;
+    const point* points;
+    int* tour;                      // tour[p] is the node at position p
+    int* pos;                       // pos[v] is the position of node v
+    int* cand;                      // CL_NCAND nearest neighbours of each node, -1 if fewer
+    int fix_a;                      // edge fix_a-fix_b always in the tour, -1 if none
+    int fix_b;
+} cl_tour;
+
+/**
+ * @brief Clusters and data shared by the threads
+ *
+ */
+typedef struct {
+    int* nodes;                     // nodes grouped by cluster, cluster c is nodes[begin[c]..begin[c+1])
+    int* begin;
+    int nclusters;
+    int* entry;                     // first node of each cluster in the final tour
+    int* exit;                      // last node of each cluster in the final tour
+    int* paths;                     // nodes of each cluster in path order, same layout as nodes
+
+    pthread_mutex_t lock;           // protects the fields below
+    int next;                       // next cluster to solve
+    ERROR_CODE error;               // first error met by a thread
+} cl_shared;
+
+/**
+ * @brief Solves the TSP with the cluster decomposition
+ *
+ * @return ERROR_CODE
+ */
+ERROR_CODE cl_Solve(void);
+
+//================================================================================
+// CLUSTER UTILS
+//================================================================================
+
+/**
+ * @brief Splits the nodes by recursive bisection along the longest side of their bounding box
+ *
+ * @param points Coordinates of the nodes
+ * @param nodes Nodes to split, reordered so that each cluster is contiguous
+ * @param count Number of nodes
+ * @param offset Position of nodes[0] in the whole array
+ * @param maxsize Maximum size of a cluster
+ * @param begin Array to hold the first position of each cluster
+ * @param nclusters Pointer to the number of clusters found so far
+ */
+void cl_bisect(const point* points, int* nodes, int count, int offset, int maxsize, int* begin, int* nclusters);
+
+/**
+ * @brief Nearest neighbours of each point, found through a uniform grid in O(n k) expected time
+ *
+ * @param points Coordinates
+ * @param n Number of points
+ * @param k Number of neighbours
+ * @param cand Array of n*k neighbours sorted by distance, -1 when there are fewer than k other points
+ * @return ERROR_CODE
+ */
+ERROR_CODE cl_knn(const point* points, int n, int k, int* cand);
+
+//================================================================================
+// TOUR UTILS
+//================================================================================
+
+/**
+ * @brief Allocates a tour over a set of points and computes the neighbour lists
+ *
+ * @param t Tour
+ * @param points Coordinates
+ * @param n Number of points
+ * @return ERROR_CODE
+ */
+ERROR_CODE cl_tour_init(cl_tour* t, const point* points, int n);
+
+/**
+ * @brief Frees a tour
+ *
+ * @param t Tour
+ */
+void cl_tour_free(cl_tour* t);
+
+/**
+ * @brief Builds a nearest neighbour tour from a node, the fixed edge is taken as soon as one of its nodes is reached
+ *
+ * @param t Tour
+ * @param start Starting node
+ * @return ERROR_CODE
+ */
+ERROR_CODE cl_nearest_neighbour(cl_tour* t, int start);
+
+/**
+ * @brief 2-opt and Or-opt with neighbour lists, processing a queue of nodes until no move improves the tour
+ *
+ * @param t Tour
+ * @param seeds Nodes to start from, NULL for all the nodes
+ * @param nseeds Number of seeds
+ * @return ERROR_CODE DEADLINE_EXCEEDED if the time limit stopped the search
+ */
+ERROR_CODE cl_local_search(cl_tour* t, const int* seeds, int nseeds);
+
+/**
+ * @brief Main function of a thread, solves clusters until none is left
+ *
+ * @param arg cl_shared pointer
+ * @return void* NULL
+ */
+void* cl_thread(void* arg);
+
+#endif
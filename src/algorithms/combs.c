@@ -0,0 +1,228 @@
+#include "combs.h"
+
+// the heuristic is run with teeth made of edges with value at least these thresholds
+static const double comb_tooth_thresholds[] = {1.0 - COMB_EPS, 0.75, 0.5};
+#define COMB_NTHRESHOLDS 3
+
+static int comb_find(int* parent, int i){
+    while(parent[i] != i){
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// collects the teeth leaving the handle, returns a node shared by two teeth or -1 if the teeth are disjoint
+static int comb_collect_teeth(int hsize, const int* hnodes, const bool* inhandle, const int* adjbeg, const int* adj, const int* elist,
+                              const double* x, double tau, int* used, int stamp, int* teeth, int* nteeth){
+    *nteeth = 0;
+    for(int h=0; h<hsize; h++){
+        int v = hnodes[h];
+        if(!inhandle[v]){
+            continue;
+        }
+        for(int a=adjbeg[v]; a<adjbeg[v+1]; a++){
+            int e = adj[a];
+            int u = (elist[2*e] == v) ? elist[2*e+1] : elist[2*e];
+            if(inhandle[u] || x[e] < tau){
+                continue;
+            }
+            if(used[v] == stamp){
+                return v;
+            }
+            if(used[u] == stamp){
+                return u;
+            }
+            used[v] = stamp;
+            used[u] = stamp;
+            teeth[2 * *nteeth] = v;
+            teeth[2 * *nteeth + 1] = u;
+            (*nteeth)++;
+        }
+    }
+    return -1;
+}
+
+ERROR_CODE comb_blossoms(int nnodes, int nedges, const int* elist, const double* x, comb_doit_fn doit_fn, void* userhandle, int* ncuts){
+    ERROR_CODE error = T_OK;
+    *ncuts = 0;
+
+    int* adjbeg = (int*) calloc(nnodes + 1, sizeof(int));
+    int* adj = (int*) malloc(2 * nedges * sizeof(int));
+    int* parent = (int*) malloc(nnodes * sizeof(int));
+    int* compbeg = (int*) calloc(nnodes + 1, sizeof(int));
+    int* order = (int*) malloc(nnodes * sizeof(int));
+    int* hnodes = (int*) malloc(nnodes * sizeof(int));
+    bool* inhandle = (bool*) calloc(nnodes, sizeof(bool));
+    bool* inlist = (bool*) calloc(nnodes, sizeof(bool));
+    int* used = (int*) calloc(nnodes, sizeof(int));
+    int* teeth = (int*) malloc(2 * nnodes * sizeof(int));
+    if(adjbeg == NULL || adj == NULL || parent == NULL || compbeg == NULL || order == NULL || hnodes == NULL ||
+       inhandle == NULL || inlist == NULL || used == NULL || teeth == NULL){
+        log_error("error in allocating memory for blossom separation");
+        error = RESOURCE_EXHAUSTED;
+        goto comb_free;
+    }
+
+    // adjacency lists of the support graph
+    for(int e=0; e<nedges; e++){
+        adjbeg[elist[2*e] + 1]++;
+        adjbeg[elist[2*e+1] + 1]++;
+    }
+    for(int i=0; i<nnodes; i++){
+        adjbeg[i+1] += adjbeg[i];
+    }
+    for(int e=0; e<nedges; e++){
+        adj[adjbeg[elist[2*e]]++] = e;
+        adj[adjbeg[elist[2*e+1]]++] = e;
+    }
+    for(int i=nnodes; i>0; i--){
+        adjbeg[i] = adjbeg[i-1];
+    }
+    adjbeg[0] = 0;
+
+    int stamp = 0;
+
+    for(int k=0; k<COMB_NTHRESHOLDS; k++){
+        double tau = comb_tooth_thresholds[k];
+
+        // a lower threshold gives new candidates only if some edge has value in [tau, previous threshold)
+        if(k > 0){
+            bool changed = false;
+            for(int e=0; e<nedges && !changed; e++){
+                changed = (x[e] >= tau && x[e] < comb_tooth_thresholds[k-1]);
+            }
+            if(!changed){
+                continue;
+            }
+        }
+
+        // candidate handles are the connected components of the edges with value in (0, tau)
+        for(int i=0; i<nnodes; i++){
+            parent[i] = i;
+        }
+        for(int e=0; e<nedges; e++){
+            if(x[e] > COMB_EPS && x[e] < tau){
+                int a = comb_find(parent, elist[2*e]);
+                int b = comb_find(parent, elist[2*e+1]);
+                if(a != b){
+                    parent[a] = b;
+                }
+            }
+        }
+
+        // group the nodes by component
+        memset(compbeg, 0, (nnodes + 1) * sizeof(int));
+        for(int i=0; i<nnodes; i++){
+            parent[i] = comb_find(parent, i);
+            compbeg[parent[i] + 1]++;
+        }
+        for(int i=0; i<nnodes; i++){
+            compbeg[i+1] += compbeg[i];
+        }
+        for(int i=0; i<nnodes; i++){
+            order[compbeg[parent[i]]++] = i;
+        }
+        for(int i=nnodes; i>0; i--){
+            compbeg[i] = compbeg[i-1];
+        }
+        compbeg[0] = 0;
+
+        for(int r=0; r<nnodes; r++){
+            int csize = compbeg[r+1] - compbeg[r];
+            if(csize < 2){
+                continue;
+            }
+
+            int hsize = 0;
+            for(int c=compbeg[r]; c<compbeg[r+1]; c++){
+                hnodes[hsize++] = order[c];
+                inhandle[order[c]] = true;
+                inlist[order[c]] = true;
+            }
+
+            // Grotschel-Holland repair: a node shared by two teeth is moved in or out of the handle,
+            // the two teeth disappear and the parity of |T| does not change
+            int nteeth = 0;
+            int shared = -1;
+            for(int iter=0; iter<nnodes; iter++){
+                stamp++;
+                shared = comb_collect_teeth(hsize, hnodes, inhandle, adjbeg, adj, elist, x, tau, used, stamp, teeth, &nteeth);
+                if(shared < 0){
+                    break;
+                }
+                inhandle[shared] = !inhandle[shared];
+                if(!inlist[shared]){
+                    inlist[shared] = true;
+                    hnodes[hsize++] = shared;
+                }
+            }
+
+            // drop the nodes moved out of the handle
+            int h = 0;
+            for(int i=0; i<hsize; i++){
+                inlist[hnodes[i]] = false;
+                if(inhandle[hnodes[i]]){
+                    hnodes[h++] = hnodes[i];
+                }
+            }
+            hsize = h;
+
+            if(shared < 0 && nteeth >= 3 && nteeth % 2 == 1){
+                // x(E(H)) + x(T) - |H| - (|T|-1)/2
+                double lhs = 0.0;
+                for(int i=0; i<hsize; i++){
+                    int v = hnodes[i];
+                    for(int a=adjbeg[v]; a<adjbeg[v+1]; a++){
+                        int e = adj[a];
+                        int u = (elist[2*e] == v) ? elist[2*e+1] : elist[2*e];
+                        if(inhandle[u] && v < u){
+                            lhs += x[e];
+                        }
+                    }
+                }
+                for(int a=0; a<nteeth; a++){
+                    int v = teeth[2*a];
+                    for(int b=adjbeg[v]; b<adjbeg[v+1]; b++){
+                        int e = adj[b];
+                        if(elist[2*e] == teeth[2*a+1] || elist[2*e+1] == teeth[2*a+1]){
+                            lhs += x[e];
+                        }
+                    }
+                }
+                double violation = lhs - (hsize + (nteeth - 1) / 2.0);
+
+                if(violation > COMB_MIN_VIOLATION){
+                    log_debug("violated blossom: |H| = %d, |T| = %d, violation %.4f", hsize, nteeth, violation);
+                    (*ncuts)++;
+                    if(doit_fn(hsize, hnodes, nteeth, teeth, violation, userhandle)){
+                        log_error("error in blossom doit_fn");
+                        error = INTERNAL;
+                    }
+                }
+            }
+
+            for(int i=0; i<hsize; i++){
+                inhandle[hnodes[i]] = false;
+            }
+
+            if(!err_ok(error)){
+                goto comb_free;
+            }
+        }
+    }
+
+comb_free:
+    utils_safe_free(adjbeg);
+    utils_safe_free(adj);
+    utils_safe_free(parent);
+    utils_safe_free(compbeg);
+    utils_safe_free(order);
+    utils_safe_free(hnodes);
+    utils_safe_free(inhandle);
+    utils_safe_free(inlist);
+    utils_safe_free(used);
+    utils_safe_free(teeth);
+
+    return error;
+}
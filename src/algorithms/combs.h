@@ -0,0 +1,49 @@
+#ifndef COMBS_H_
+#define COMBS_H_
+
+/**
+ * @file combs.h
+ * @brief Heuristic separation of blossom (2-matching) inequalities, i.e. combs whose teeth are single edges:
+ *        x(E(H)) + x(T) <= |H| + (|T|-1)/2, where H is the handle and T an odd set of disjoint edges with one end in H
+ * @version 0.1
+ * @date 2024-06-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "../tsp.h"
+
+#define COMB_EPS 1.0E-6             // values below it are considered 0, above 1-COMB_EPS are considered 1
+#define COMB_MIN_VIOLATION 0.05     // minimum violation for a blossom to be passed to doit_fn
+
+/**
+ * @brief Function called for every violated blossom found
+ *
+ * @param hsize |H|
+ * @param handle Nodes of the handle
+ * @param nteeth |T|, always odd and at least 3
+ * @param teeth Endpoints of the teeth, teeth[2*i] and teeth[2*i+1] are the two nodes of the i-th tooth
+ * @param violation Violation of the inequality
+ * @param userhandle Pointer passed to comb_blossoms
+ * @return int 0 if it is successful, 1 otherwise
+ */
+typedef int (*comb_doit_fn)(int hsize, const int* handle, int nteeth, const int* teeth, double violation, void* userhandle);
+
+/**
+ * @brief Odd-component heuristic for blossoms. The handles are the connected components of the fractional edges, the teeth
+ *        are the edges with (almost) integer value leaving the handle. Teeth sharing a node are removed with the Grotschel-Holland
+ *        rule, i.e. moving the shared node in or out of the handle. The heuristic is repeated with lower thresholds for the teeth
+ *        to find more candidates
+ *
+ * @param nnodes Number of nodes
+ * @param nedges Number of edges in the support graph
+ * @param elist Support graph in Concorde format, elist[2*i] and elist[2*i+1] are the nodes of the i-th edge
+ * @param x Values of the edges
+ * @param doit_fn Function called for every violated blossom
+ * @param userhandle Pointer passed to doit_fn
+ * @param ncuts Number of violated blossoms found
+ * @return ERROR_CODE
+ */
+ERROR_CODE comb_blossoms(int nnodes, int nedges, const int* elist, const double* x, comb_doit_fn doit_fn, void* userhandle, int* ncuts);
+
+#endif
@@ -1,5 +1,12 @@
 #include "cplex_model.h"
 
+// separation workspace of each CPLEX thread, kept across callbacks to avoid rebuilding the graphs from scratch
+static CCcut_workspace cx_workspaces[THREADS];
+static hp_pool cx_heurpool;
+// cost of the last MIP start, checked against the first incumbent CPLEX reports to the callbacks
+static double cx_mipstart_cost;
+static int cx_mipstart_pending;
+
 ERROR_CODE cx_Nosec()
 {
 
@@ -36,7 +43,9 @@ ERROR_CODE cx_Nosec()
 	log_info("CPLEX initialized correctly");
 
 	// solve with cplex
+	struct timespec start = st_now();
 	error = CPXmipopt(env, lp);
+	st_time(ST_TIME_MIP, &start);
 	if (error)
 	{
 		log_fatal("CPX code %d : CPXmipopt() error", error);
@@ -94,6 +103,24 @@ cx_free:
 	return e;
 }
 
+// appends the SEC of the component just merged by patching, called by pt_patch
+static ERROR_CODE cx_patch_sec(const tsp_solution *solution, int node, void *userhandle)
+{
+	patchsecs_passparams *uh = (patchsecs_passparams *)userhandle;
+
+	int nnodes = 0;
+	int v = node;
+	do
+	{
+		uh->nodes[nnodes++] = v;
+		v = solution->path[v];
+	} while (v != node);
+
+	cp_insert(&tsp_inst.sec_pool, uh->nodes, nnodes);
+
+	return cx_cutbuffer_add_sec(uh->buffer, uh->nodes, nnodes);
+}
+
 ERROR_CODE cx_BendersLoop(bool patching)
 {
 
@@ -101,19 +128,25 @@ ERROR_CODE cx_BendersLoop(bool patching)
 
 	log_info("running CPLEX Benders Loop %s Patching", patching ? "with" : "without");
 
+	tsp_solution solution = {0};
+	cutbuffer buffer = {0};
+	double *xstar = NULL;
+	int *nodes = NULL;
+	CPXLPptr lp = NULL;
+
 	// open CPLEX model
 	int error;
 	CPXENVptr env = CPXopenCPLEX(&error);
 	if (error)
 	{
-		log_fatal("CPX code %d : CPXopenCPLEX() error", e);
+		log_fatal("CPX code %d : CPXopenCPLEX() error", error);
 		e = FAILED_PRECONDITION;
 		goto cx_free;
 	}
-	CPXLPptr lp = CPXcreateprob(env, &error, "TSP model version 1");
+	lp = CPXcreateprob(env, &error, "TSP model version 1");
 	if (error)
 	{
-		log_fatal("CPX code %d : CPXcreateprob() error", e);
+		log_fatal("CPX code %d : CPXcreateprob() error", error);
 		e = FAILED_PRECONDITION;
 		goto cx_free;
 	}
@@ -129,47 +162,43 @@ ERROR_CODE cx_BendersLoop(bool patching)
 
 	log_info("CPLEX initialized correctly");
 
-	tsp_solution solution;
 	tsp_init_solution(tsp_inst.nnodes, &solution);
+	xstar = (double *)calloc(tsp_inst.ncols, sizeof(double));
+	nodes = (int *)malloc(tsp_inst.nnodes * sizeof(int));
+	if (solution.path == NULL || solution.comp == NULL || xstar == NULL || nodes == NULL)
+	{
+		log_error("error in allocating memory for the Benders loop");
+		e = RESOURCE_EXHAUSTED;
+		goto cx_free;
+	}
 
 	int iteration = 0;
+	int totcuts = 0;
 	while (1)
 	{
-		log_info("iteration %d", iteration);
 		double ex_time = utils_timeelapsed(&tsp_inst.c);
+		if (dl_expired())
+		{
+			log_warn("exceeded time, saving best solution found until now");
+			e = DEADLINE_EXCEEDED;
+			goto cx_free;
+		}
 		if (tsp_env.timelimit != -1.0)
 		{
-			CPXsetdblparam(env, CPX_PARAM_TILIM, tsp_env.timelimit - ex_time);
-
-			if (ex_time > tsp_env.timelimit)
-			{
-				log_warn("exceeded time, saving best solution found until now");
-				e = DEADLINE_EXCEEDED;
-				break;
-			}
+			CPXsetdblparam(env, CPX_PARAM_TILIM, dl_remaining());
 		}
 
-		// solve with cplex
+		// solve with cplex, the cuts of the previous iterations stay in the model and the patched tour is a MIP start
+		struct timespec start = st_now();
 		error = CPXmipopt(env, lp);
+		st_time(ST_TIME_MIP, &start);
 		if (error)
 		{
-			log_fatal("CPX code %d : CPXmipopt() error", e);
-			e = INTERNAL;
-			goto cx_free;
-		}
-
-		int ncols = CPXgetnumcols(env, lp);
-
-		// get the optimal value
-		double *xstar = (double *)calloc(ncols, sizeof(double));
-
-		// check that cplex solved it right
-		if (CPXgetx(env, lp, xstar, 0, ncols - 1))
-		{
-			log_fatal("CPX : CPXgetx() error");
+			log_fatal("CPX code %d : CPXmipopt() error", error);
 			e = INTERNAL;
 			goto cx_free;
 		}
+		double mip_time = utils_timeelapsed(&tsp_inst.c) - ex_time;
 
 		// check cplex status code on exit
 		e = cx_handle_cplex_status(env, lp);
@@ -179,57 +208,96 @@ ERROR_CODE cx_BendersLoop(bool patching)
 			goto cx_free;
 		}
 
-		cx_build_sol(xstar, &solution);
+		if (CPXgetx(env, lp, xstar, 0, tsp_inst.ncols - 1))
+		{
+			log_error("CPX : CPXgetx() error");
+			e = NOT_FOUND;
+			goto cx_free;
+		}
 
-		log_info("number of components: %d", solution.ncomp);
-		log_info("current solution cost: %f", solution.cost);
-		log_info("is solution a tour? %d", tsp_is_tour(solution.path, tsp_inst.nnodes));
-		log_info("cost re-computed: %f", tsp_solution_cost(solution.path));
+		cx_build_sol(xstar, &solution);
+		double lower_bound = solution.cost;
 
 		// only one component it means that we have found an Hamiltonian cycle
 		if (solution.ncomp == 1)
 		{
+			log_info("iteration %d: tour found, cost %.2f, mip %.3fs", iteration, solution.cost, mip_time);
 			break;
 		}
 
-		error = cx_add_sec(env, lp, solution.comp, solution.ncomp);
-		if (!err_ok(error))
+		// the SECs of the components, all violated by the current solution
+		int ncomp = solution.ncomp;
+		double cut_start = utils_timeelapsed(&tsp_inst.c);
+		e = cx_collect_comp_secs(solution.comp, &buffer);
+		if (!err_ok(e))
 		{
-			log_fatal("code %d : error in add_sec", error);
 			goto cx_free;
 		}
+		int nsecs = buffer.nrows;
 
-		// patch solution
+		// patch solution, every merged component is a new subtour to cut and the final tour is the next MIP start
+		double patch_time = 0.0;
 		if (patching)
 		{
-			while (solution.ncomp > 1)
+			double patch_start = utils_timeelapsed(&tsp_inst.c);
+			patchsecs_passparams params = {.buffer = &buffer, .nodes = nodes};
+			e = pt_patch(&solution, cx_patch_sec, &params);
+			if (!err_ok(e))
+			{
+				goto cx_free;
+			}
+			patch_time = utils_timeelapsed(&tsp_inst.c) - patch_start;
+
+			ERROR_CODE best_error = tsp_update_best_solution(&solution);
+			if (err_ok(best_error) && best_error != CANCELLED)
+			{
+				log_info("patched tour is the new best solution, cost %.2f", solution.cost);
+			}
+
+			if (CPXgetnummipstarts(env, lp) > 0 && CPXdelmipstarts(env, lp, 0, CPXgetnummipstarts(env, lp) - 1))
 			{
-				cx_patching(&solution);
-				log_info("number of components: %d", solution.ncomp);
-				log_info("current solution cost: %f", solution.cost);
-				log_info("is solution a tour? %d", tsp_is_tour(solution.path, tsp_inst.nnodes));
-				log_info("cost re-computed: %f", tsp_solution_cost(solution.path));
+				log_warn("CPXdelmipstarts() error, old MIP starts are kept");
+			}
+			e = cx_add_mip_starts(env, lp, &solution);
+			if (!err_ok(e))
+			{
+				goto cx_free;
 			}
 		}
 
-		iteration++;
+		int nrows = buffer.nrows;
+		e = cx_cutbuffer_flush(env, lp, &buffer);
+		if (!err_ok(e))
+		{
+			goto cx_free;
+		}
+		double cut_time = utils_timeelapsed(&tsp_inst.c) - cut_start - patch_time;
+		totcuts += nrows;
+		st_add(ST_CUTS_BENDERS, nrows);
 
-		utils_safe_free(xstar);
+		log_info("iteration %d: %d components, lower bound %.2f, %d component SECs, %d patching SECs, mip %.3fs, cuts %.3fs, patching %.3fs",
+				 iteration, ncomp, lower_bound, nsecs, nrows - nsecs, mip_time, cut_time, patch_time);
+
+		iteration++;
 	}
 
-	log_info("Optimal found");
+	log_info("Optimal found after %d iterations and %d SECs", iteration + 1, totcuts);
 
 	// save the best solution
-	tsp_update_best_solution(&solution);
+	e = tsp_update_best_solution(&solution);
 
 cx_free:
 	utils_safe_free(solution.path);
+	utils_safe_free(solution.comp);
+	utils_safe_free(xstar);
+	utils_safe_free(nodes);
+	cx_cutbuffer_free(&buffer);
 
 	// free and close cplex model
 	CPXfreeprob(env, &lp);
 	CPXcloseCPLEX(&env);
 
-	return error;
+	return e;
 }
 
 ERROR_CODE cx_BranchAndCut()
@@ -239,6 +307,11 @@ ERROR_CODE cx_BranchAndCut()
 
 	log_info("running CPLEX Branch&Cut");
 
+	// declared before the first jump to cx_free, which frees them
+	double *xstar = NULL;
+	double *dj = NULL;
+	tsp_solution solution = {0};
+
 	// open CPLEX model
 	int error;
 	CPXENVptr env = CPXopenCPLEX(&error);
@@ -266,11 +339,35 @@ ERROR_CODE cx_BranchAndCut()
 
 	log_info("CPLEX initialized correctly");
 
-	double *xstar = (double *)calloc(tsp_inst.ncols, sizeof(double));
+	xstar = (double *)calloc(tsp_inst.ncols, sizeof(double));
 
-	tsp_solution solution;
 	tsp_init_solution(tsp_inst.nnodes, &solution);
 
+	dj = (double *)calloc(tsp_inst.ncols, sizeof(double));
+	double lpbound = -CPX_INFBOUND;
+
+	// tighten the root bound before CPLEX starts branching
+	if (tsp_env.bc_rootcuts)
+	{
+		e = cx_root_cuts(env, lp, tsp_env.bc_elim ? dj : NULL, &lpbound);
+		if (!err_ok(e))
+		{
+			log_error("error in root cutting-plane loop");
+			goto cx_free;
+		}
+	}
+
+	// with the root bound and the MIP start most of the edges can be fixed to 0
+	if (tsp_env.bc_elim)
+	{
+		e = cx_eliminate_edges(env, lp, (lpbound > -CPX_INFBOUND) ? dj : NULL, lpbound);
+		if (!err_ok(e))
+		{
+			log_error("error in edge elimination");
+			goto cx_free;
+		}
+	}
+
 	e = cx_branchcut_util(env, lp, tsp_inst.ncols, xstar);
 	if (!err_ok(e))
 	{
@@ -291,6 +388,7 @@ cx_free:
 	utils_safe_free(solution.path);
 	utils_safe_free(solution.comp);
 	utils_safe_free(xstar);
+	utils_safe_free(dj);
 
 	// free and close cplex model
 	CPXfreeprob(env, &lp);
@@ -312,6 +410,26 @@ ERROR_CODE cx_initialize(CPXENVptr env, CPXLPptr lp)
 
 	cx_build_model(env, lp);
 
+	// the cut pool lives as long as the instance, if it already has cuts they are added to the new model
+	if (tsp_inst.sec_pool.keys == NULL)
+	{
+		error = cp_init(&tsp_inst.sec_pool, tsp_inst.nnodes, (unsigned)tsp_env.seed);
+		if (!err_ok(error))
+		{
+			log_error("error in cut pool initialization");
+			goto cx_free;
+		}
+	}
+	else
+	{
+		error = cx_add_pool_cuts(env, lp);
+		if (!err_ok(error))
+		{
+			log_error("error %d in add_pool_cuts", error);
+			goto cx_free;
+		}
+	}
+
 	// Cplex's parameter setting
 
 	// save CPLEX output to a log file
@@ -355,30 +473,23 @@ ERROR_CODE cx_initialize(CPXENVptr env, CPXLPptr lp)
 
 		log_info("beginning warm start computation");
 
-		double old_timelimit = tsp_env.timelimit;
-		// set the new timelimit to 1/10 of the total time, to make it so the heuristic doesnt consume all of the available time
-		if (tsp_env.timelimit > 0.0)
-		{
-			tsp_env.timelimit = old_timelimit / 10.0;
-		}
-		else
-		{
-			tsp_env.timelimit = 300.0 / 10.0; // 30 seconds
-		}
-
-		log_debug("assigned timelimit: %.2f", tsp_env.timelimit);
+		// the heuristic gets 1/10 of the total time, 30 seconds without a time limit, so it doesnt consume all of the available time
+		double budget = (tsp_env.timelimit > 0.0) ? tsp_env.timelimit / 10.0 : 30.0;
+		bool nested = err_ok(dl_push(budget));
+		log_debug("assigned timelimit: %.2f", budget);
 
 		// run all nearest neighbor heuristic
 		error = h_greedy_2opt();
+		if (nested)
+		{
+			dl_pop();
+		}
 		if (!err_ok(error))
 		{
 			log_error("error %d in greedy 2opt mip start");
 			goto cx_free;
 		}
 
-		// change the timelimit back to the original one minus the time spent computing
-		tsp_env.timelimit = old_timelimit;
-
 		error = cx_add_mip_starts(env, lp, &tsp_inst.best_solution);
 		if (!err_ok(error))
 		{
@@ -389,6 +500,31 @@ cx_free:
 	return error;
 }
 
+int cx_build_elist(const double *xstar, int *elist, double *elist_x)
+{
+	int num_edges = 0;
+	int k = 0;
+
+	for (int i = 0; i < tsp_inst.nnodes; i++)
+	{
+		for (int j = i + 1; j < tsp_inst.nnodes; j++)
+		{
+			// take only points that contribute to the solution
+			if (xstar[cx_xpos(i, j, tsp_inst.nnodes)] > 0.001)
+			{
+				elist[k++] = i;
+				elist[k++] = j;
+
+				elist_x[num_edges] = xstar[cx_xpos(i, j, tsp_inst.nnodes)];
+
+				num_edges++;
+			}
+		}
+	}
+
+	return num_edges;
+}
+
 int cx_xpos(int i, int j, int nnodes)
 {
 
@@ -415,57 +551,67 @@ ERROR_CODE cx_add_sec(CPXENVptr env, CPXLPptr lp, int *comp, int ncomp)
 		return INVALID_ARGUMENT;
 	}
 
-	const char sense = 'L';
-
-	// initialize index and value
-	int ncols = CPXgetnumcols(env, lp);
-	int *index = (int *)calloc(ncols, sizeof(int));
-	double *value = (double *)calloc(ncols, sizeof(double));
+	cutbuffer buffer = {0};
 
-	// non più di n**2
-	for (int k = 1; k <= ncomp; k++)
+	ERROR_CODE e = cx_collect_comp_secs(comp, &buffer);
+	if (err_ok(e))
 	{
-		int nnz = 0;
-
-		int number_nodes = 0; // |S|
-
-		for (int i = 0; i < tsp_inst.nnodes; i++)
-		{
+		e = cx_cutbuffer_flush(env, lp, &buffer);
+	}
 
-			// skip iteration if it does belong to the current component k
-			if (comp[i] != k)
-			{
-				continue;
-			}
+	cx_cutbuffer_free(&buffer);
 
-			number_nodes++;
+	return e;
+}
 
-			for (int j = i + 1; j < tsp_inst.nnodes; j++)
-			{
-				// skip iteration if it does belong to the current component k
-				if (comp[j] != k)
-				{
-					continue;
-				}
+ERROR_CODE cx_collect_comp_secs(const int *comp, cutbuffer *buffer)
+{
+	int n = tsp_inst.nnodes;
+	int *start = (int *)calloc(n + 1, sizeof(int));
+	int *nodes = (int *)malloc(n * sizeof(int));
+	if (start == NULL || nodes == NULL)
+	{
+		log_error("error in allocating memory for the component SECs");
+		utils_safe_free(start);
+		utils_safe_free(nodes);
+		return RESOURCE_EXHAUSTED;
+	}
 
-				index[nnz] = cx_xpos(i, j, tsp_inst.nnodes);
-				value[nnz] = 1.0;
+	// bucket the nodes by component, labels need not be contiguous
+	for (int i = 0; i < n; i++)
+	{
+		start[comp[i]]++;
+	}
+	for (int k = 0, sum = 0; k <= n; k++)
+	{
+		int size = start[k];
+		start[k] = sum;
+		sum += size;
+	}
+	for (int i = 0; i < n; i++)
+	{
+		nodes[start[comp[i]]++] = i;
+	}
 
-				nnz++;
-			}
+	// after the fill start[k] is the end of component k, that is the beginning of component k+1
+	ERROR_CODE e = T_OK;
+	for (int k = 1; k <= n && err_ok(e); k++)
+	{
+		int size = start[k] - start[k - 1];
+		if (size < 2 || size == n)
+		{
+			continue;
 		}
 
-		double rhs = number_nodes - 1.0; // |S|-1
-		// https://www.ibm.com/docs/en/icos/22.1.0?topic=cpxxaddrows-cpxaddrows
-		int izero = 0;
-		CPXaddrows(env, lp, 0, 1, nnz, &rhs, &sense, &izero, index, value, NULL, NULL);
+		// the pool only records the cut for the models built later
+		cp_insert(&tsp_inst.sec_pool, &nodes[start[k - 1]], size);
+		e = cx_cutbuffer_add_sec(buffer, &nodes[start[k - 1]], size);
 	}
 
-	// utils_safe_free resources
-	utils_safe_free(index);
-	utils_safe_free(value);
+	utils_safe_free(start);
+	utils_safe_free(nodes);
 
-	return T_OK;
+	return e;
 }
 
 // construct sec
@@ -474,7 +620,7 @@ ERROR_CODE cx_compute_cuts(int *comp, int ncomp, int *nnz, double *rhs, char *se
 
 	log_info("starting sec computing");
 
-	if (ncomp <= 1 || comp == NULL)
+	if (ncomp < 1 || comp == NULL)
 	{
 		log_debug("invalid argument");
 		return INVALID_ARGUMENT;
@@ -531,6 +677,75 @@ ERROR_CODE cx_compute_cuts(int *comp, int ncomp, int *nnz, double *rhs, char *se
 	return T_OK;
 }
 
+// adds the SEC of a single pool cut to the model, called by cp_foreach
+static int cx_add_pool_cut(const int *nodes, int nnodes, void *userhandle)
+{
+	poolcuts_passparams *uh = (poolcuts_passparams *)userhandle;
+
+	int num_edges = (nnodes * (nnodes - 1)) / 2;
+	if (num_edges <= 0)
+	{
+		return 0;
+	}
+
+	int *index = (int *)calloc(num_edges, sizeof(int));
+	double *value = (double *)calloc(num_edges, sizeof(double));
+
+	int nnz = 0;
+	for (int i = 0; i < nnodes; i++)
+	{
+		for (int j = i + 1; j < nnodes; j++)
+		{
+			index[nnz] = cx_xpos(nodes[i], nodes[j], tsp_inst.nnodes);
+			value[nnz] = 1.0;
+			nnz++;
+		}
+	}
+
+	const char sense = 'L';
+	const double rhs = nnodes - 1.0;
+	const int izero = 0;
+	int error = CPXaddrows(uh->env, uh->lp, 0, 1, nnz, &rhs, &sense, &izero, index, value, NULL, NULL);
+	if (!error)
+	{
+		uh->nadded++;
+		st_add(ST_CUTS_POOL, 1);
+	}
+
+	utils_safe_free(index);
+	utils_safe_free(value);
+
+	return error;
+}
+
+ERROR_CODE cx_add_pool_cuts(CPXENVptr env, CPXLPptr lp)
+{
+	return cx_add_pool_cuts_since(env, lp, -1);
+}
+
+ERROR_CODE cx_add_pool_cuts_since(CPXENVptr env, CPXLPptr lp, long since)
+{
+	if (tsp_inst.sec_pool.ncuts == 0)
+	{
+		return T_OK;
+	}
+
+	poolcuts_passparams userhandle = {.env = env, .lp = lp, .nadded = 0};
+	int error = cp_foreach_since(&tsp_inst.sec_pool, since, cx_add_pool_cut, &userhandle);
+	if (error)
+	{
+		log_error("CPX code %d : CPXaddrows() error on pool cut", error);
+		return INTERNAL;
+	}
+
+	if (userhandle.nadded > 0)
+	{
+		log_info("added %d SECs from the cut pool to the model", userhandle.nadded);
+	}
+
+	return T_OK;
+}
+
 void cx_build_model(CPXENVptr env, CPXLPptr lp)
 {
 	char binary = 'B';
@@ -684,92 +899,33 @@ ERROR_CODE cx_handle_cplex_status(CPXENVptr env, CPXLPptr lp)
 	case CPXMIP_OPTIMAL:
 		log_info("optimal");
 		return T_OK;
+	case CPXMIP_SOL_LIM:
+		log_info("solution limit reached");
+		return T_OK;
 	default:
 		log_error("unhandled cplex status code %d\n", status);
 		return UNIMPLEMENTED;
 	}
 }
 
-void cx_patching(tsp_solution *solution)
-{
-	double best_delta = __DBL_MAX__;
-	int best_nodes[2] = {-1, -1};
-
-	// compute nodes to patch together
-	for (int a = 0; a < tsp_inst.nnodes; a++)
-	{
-		for (int b = 0; b < tsp_inst.nnodes; b++)
-		{
-			if (solution->comp[a] == solution->comp[b])
-			{
-				continue;
-			}
-			int succ_a = solution->path[a]; // successor of a
-			int succ_b = solution->path[b]; // successor of b
-
-			double current_cost = tsp_get_cost(a, succ_a) + tsp_get_cost(b, succ_b);
-			double swapped_cost = tsp_get_cost(a, succ_b) + tsp_get_cost(b, succ_a);
-			double delta = swapped_cost - current_cost;
-
-			if (delta < best_delta && delta > 0)
-			{
-				best_delta = delta;
-				best_nodes[0] = a;
-				best_nodes[1] = b;
-			}
-		}
-	}
-	// patch components
-	log_debug("best_delta: %f", best_delta);
-	if (best_delta > EPSILON)
-	{
-		log_debug("  patching...");
-		int a = best_nodes[0];
-		int b = best_nodes[1];
-
-		int succ_a = solution->path[a]; // successor of a
-		int succ_b = solution->path[b]; // successor of b
-
-		solution->path[a] = succ_b;
-		solution->path[b] = succ_a;
-
-		// update solution cost
-		solution->cost += best_delta;
-
-		// update comp
-		int i = succ_b;
-		int comp_index = solution->comp[a];
-		bool finish = false;
-		while (!finish)
-		{
-			solution->comp[i] = comp_index;
-			if (i == b)
-			{
-				finish = true;
-			}
-			i = solution->path[i];
-		}
-
-		solution->ncomp = solution->ncomp - 1;
-	}
-}
-
 ERROR_CODE cx_branchcut_util(CPXENVptr env, CPXLPptr lp, int ncols, double *xstar)
 {
 
 	int error;
 	ERROR_CODE e = T_OK;
-	// initialize seeds for different threads
-	// https://selkie.macalester.edu/csinparallel/modules/MonteCarloSimulationExemplar/build/html/SeedingThreads/SeedEachThread.html
-	tsp_inst.threads_seeds = (int *)calloc(THREADS, sizeof(int));
+	// one non overlapping stream for each thread, cplex uses at most 32 threads
+	// the model can be solved many times, as in the matheuristics
+	utils_safe_free(tsp_inst.threads_rng);
+	tsp_inst.threads_rng = (rng_state *)malloc(THREADS * sizeof(rng_state));
+	if (tsp_inst.threads_rng == NULL)
+	{
+		log_error("error in allocating the generators of the threads");
+		return RESOURCE_EXHAUSTED;
+	}
 
 	for (int i = 0; i < THREADS; i++)
 	{
-		unsigned int seed = (tsp_env.seed == -1) ? (unsigned)time(NULL) : (unsigned)tsp_env.seed;
-
-		// clears the last 5 bits of seed and replace them with i+1
-		// has place for 32 threads (cplex defaults to at most 32 threads or the number of cores, whetever is smaller)
-		tsp_inst.threads_seeds[i] = (seed & 0xFFFFFFE0) | (i + 1);
+		rng_split(&tsp_inst.rng, i, &tsp_inst.threads_rng[i]);
 	}
 
 	CPXLONG contextid = CPX_CALLBACKCONTEXT_CANDIDATE;
@@ -785,8 +941,19 @@ ERROR_CODE cx_branchcut_util(CPXENVptr env, CPXLPptr lp, int ncols, double *xsta
 		goto cx_free;
 	}
 
+	if (tsp_env.modified_costs && tsp_env.callback_relaxation)
+	{
+		e = hp_start(&cx_heurpool, HP_MAX_WORKERS);
+		if (!err_ok(e))
+		{
+			goto cx_free;
+		}
+	}
+
 	// solve with cplex
+	struct timespec start = st_now();
 	error = CPXmipopt(env, lp);
+	st_time(ST_TIME_MIP, &start);
 	log_debug("cpx opt end");
 	if (error)
 	{
@@ -795,25 +962,30 @@ ERROR_CODE cx_branchcut_util(CPXENVptr env, CPXLPptr lp, int ncols, double *xsta
 		goto cx_free;
 	}
 
-	// check that cplex solved it right
-	if (CPXgetx(env, lp, xstar, 0, ncols - 1))
+	// check cplex status code on exit, there is a solution only if it is ok
+	e = cx_handle_cplex_status(env, lp);
+	if (!err_ok(e))
 	{
-		log_fatal("CPX : CPXgetx() error");
-		CPXcloseCPLEX(&env);
-		tsp_handlefatal();
+		log_error("cplex did not finish correctly, error code %d", e);
+		goto cx_free;
 	}
 
-	// check cplex status code on exit
-	e = cx_handle_cplex_status(env, lp);
-	if (!err_ok(e))
+	if (CPXgetx(env, lp, xstar, 0, ncols - 1))
 	{
-		log_error("cplex did not finish correctly, error code %d", e);
+		log_error("CPX : CPXgetx() error");
+		e = NOT_FOUND;
 		goto cx_free;
 	}
 
 	log_info("Branch&Cut done");
 
 cx_free:
+	hp_stop(&cx_heurpool);
+	for (int i = 0; i < THREADS; i++)
+	{
+		CCcut_free_workspace(&cx_workspaces[i]);
+	}
+
 	return e;
 }
 
@@ -853,6 +1025,11 @@ ERROR_CODE cx_add_mip_starts(CPXENVptr env, CPXLPptr lp, tsp_solution *solution)
 		error = INTERNAL;
 		goto cx_free;
 	}
+	st_add(ST_MIPSTART_ADDED, 1);
+
+	// the callbacks tell whether CPLEX took it as incumbent
+	cx_mipstart_cost = solution->cost;
+	__atomic_store_n(&cx_mipstart_pending, 1, __ATOMIC_RELEASE);
 
 	log_status(message);
 
@@ -863,10 +1040,287 @@ cx_free:
 	return error;
 }
 
+ERROR_CODE cx_root_cuts(CPXENVptr env, CPXLPptr lp, double *dj, double *lpbound)
+{
+	ERROR_CODE e = T_OK;
+
+	if (dj != NULL)
+	{
+		*lpbound = -CPX_INFBOUND;
+	}
+
+	log_info("starting root cutting-plane loop");
+
+	// the loop works on a copy of the model with continuous variables, the cuts are then added to both
+	int error;
+	CPXLPptr rlp = CPXcloneprob(env, lp, &error);
+	if (error || rlp == NULL)
+	{
+		log_error("CPX code %d : CPXcloneprob() error", error);
+		return INTERNAL;
+	}
+
+	double *xstar = (double *)calloc(tsp_inst.ncols, sizeof(double));
+	int *elist = (int *)calloc(2 * tsp_inst.ncols, sizeof(int));
+	double *elist_x = (double *)calloc(tsp_inst.ncols, sizeof(double));
+	cutbuffer buffer = {0};
+
+	double bound = -CPX_INFBOUND;
+	int stall = 0;
+	int totcuts = 0;
+	int iter = 0;
+
+	// leave at least half of the time to the branching
+	bool nested = (tsp_env.timelimit > 0.0 && err_ok(dl_push(tsp_env.timelimit / 2.0 - utils_timeelapsed(&tsp_inst.c))));
+
+	if (CPXchgprobtype(env, rlp, CPXPROB_LP))
+	{
+		log_error("CPXchgprobtype() error");
+		e = INTERNAL;
+		goto cx_free;
+	}
+	for (iter = 0; iter < ROOT_MAXITER && stall < ROOT_STALL_ITERS; iter++)
+	{
+		if (dl_expired())
+		{
+			log_warn("root cutting-plane loop stopped for time limit");
+			break;
+		}
+
+		// after the first round the previous basis is still dual feasible, so the dual simplex warm starts from it
+		error = CPXdualopt(env, rlp);
+		if (error)
+		{
+			log_error("CPX code %d : CPXdualopt() error", error);
+			e = INTERNAL;
+			goto cx_free;
+		}
+
+		if (CPXgetstat(env, rlp) != CPX_STAT_OPTIMAL)
+		{
+			log_warn("root LP not solved to optimality, status %d", CPXgetstat(env, rlp));
+			break;
+		}
+
+		double objval;
+		if (CPXgetobjval(env, rlp, &objval) || CPXgetx(env, rlp, xstar, 0, tsp_inst.ncols - 1))
+		{
+			log_error("CPXgetobjval()/CPXgetx() error on root LP");
+			e = INTERNAL;
+			goto cx_free;
+		}
+
+		stall = (objval - bound > ROOT_STALL_TOL * fabs(objval)) ? 0 : stall + 1;
+		bound = objval;
+
+		log_debug("root round %d: bound %.2f", iter, bound);
+
+		int num_edges = cx_build_elist(xstar, elist, elist_x);
+
+		buffer.nrows = 0;
+		buffer.nnz = 0;
+
+		int ncomp = 0;
+		if (CCcut_violated_cuts_shrunk(tsp_inst.nnodes, num_edges, elist, elist_x, 2.0 - EPSILON_BC, cc_collect_sec, &buffer, &ncomp, &cx_workspaces[0]))
+		{
+			log_error("CCcut_violated_cuts_shrunk");
+			e = INTERNAL;
+			goto cx_free;
+		}
+
+		// no violated SEC, try with blossoms on the same support graph
+		if (buffer.nrows == 0 && ncomp == 1)
+		{
+			int nblossoms = 0;
+			if (!err_ok(comb_blossoms(tsp_inst.nnodes, num_edges, elist, elist_x, cc_collect_blossom, &buffer, &nblossoms)))
+			{
+				log_error("comb_blossoms");
+				e = INTERNAL;
+				goto cx_free;
+			}
+			log_debug("root round %d: %d violated blossoms", iter, nblossoms);
+		}
+
+		if (buffer.nrows == 0)
+		{
+			log_info("no violated SEC or blossom left at the root");
+			break;
+		}
+
+		// add the round of cuts in bulk to both models
+		if (CPXaddrows(env, rlp, 0, buffer.nrows, buffer.nnz, buffer.rhs, buffer.sense, buffer.matbeg, buffer.matind, buffer.matval, NULL, NULL) ||
+			CPXaddrows(env, lp, 0, buffer.nrows, buffer.nnz, buffer.rhs, buffer.sense, buffer.matbeg, buffer.matind, buffer.matval, NULL, NULL))
+		{
+			log_error("CPXaddrows() error on root cuts");
+			e = INTERNAL;
+			goto cx_free;
+		}
+
+		totcuts += buffer.nrows;
+		st_add(ST_CUTS_ROOT, buffer.nrows);
+	}
+
+	log_info("root cutting-plane loop: %d rounds, %d SECs, bound %.2f", iter, totcuts, bound);
+
+	// the last round of cuts may not have been optimized yet, the dual simplex warm starts from the last basis
+	if (dj != NULL)
+	{
+		if (CPXdualopt(env, rlp) || CPXgetstat(env, rlp) != CPX_STAT_OPTIMAL)
+		{
+			log_warn("final root LP not solved to optimality, reduced costs not available");
+		}
+		else if (CPXgetobjval(env, rlp, lpbound) || CPXgetdj(env, rlp, dj, 0, tsp_inst.ncols - 1))
+		{
+			log_warn("CPXgetobjval()/CPXgetdj() error on root LP, reduced costs not available");
+			*lpbound = -CPX_INFBOUND;
+		}
+	}
+
+cx_free:
+	if (nested)
+	{
+		dl_pop();
+	}
+	utils_safe_free(xstar);
+	utils_safe_free(elist);
+	utils_safe_free(elist_x);
+	cx_cutbuffer_free(&buffer);
+
+	CPXfreeprob(env, &rlp);
+
+	return e;
+}
+
+ERROR_CODE cx_eliminate_edges(CPXENVptr env, CPXLPptr lp, const double *dj, double lpbound)
+{
+	ERROR_CODE e = T_OK;
+
+	double ub = tsp_inst.best_solution.cost;
+	if (ub == __DBL_MAX__)
+	{
+		log_warn("no incumbent available, skipping edge elimination");
+		return T_OK;
+	}
+	if (dj == NULL && tsp_inst.hk_pi == NULL)
+	{
+		log_warn("no lower bound available, skipping edge elimination");
+		return T_OK;
+	}
+
+	// strict test: the edges of the incumbent can never be eliminated, so the MIP start stays feasible
+	double threshold = ub + ELIM_TOL * fabs(ub);
+	int n = tsp_inst.nnodes;
+
+	int *indices = (int *)malloc(tsp_inst.ncols * sizeof(int));
+	bool *eliminated = (bool *)calloc(tsp_inst.ncols, sizeof(bool));
+	double *alpha = (double *)malloc(n * sizeof(double));
+	int *mark = (int *)malloc(n * sizeof(int));
+	ot_tree tree = {0};
+	if (indices == NULL || eliminated == NULL || alpha == NULL || mark == NULL)
+	{
+		log_error("error in allocating memory for edge elimination");
+		e = RESOURCE_EXHAUSTED;
+		goto cx_free;
+	}
+
+	// LP reduced costs: forcing x_e to 1 raises the root bound by at least dj_e
+	if (dj != NULL)
+	{
+		for (int j = 0; j < tsp_inst.ncols; j++)
+		{
+			if (lpbound + dj[j] > threshold)
+			{
+				eliminated[j] = true;
+			}
+		}
+	}
+
+	// Lagrangian penalties: forcing edge a-b raises the 1-tree bound by alpha(a,b)
+	if (tsp_inst.hk_pi != NULL)
+	{
+		e = ot_init(&tree, n);
+		if (err_ok(e))
+		{
+			e = ot_compute(&tree, tsp_inst.hk_pi);
+		}
+		if (!err_ok(e))
+		{
+			log_error("error in computing the 1-tree");
+			goto cx_free;
+		}
+
+		for (int i = 0; i < n; i++)
+		{
+			mark[i] = -1;
+		}
+		for (int a = 0; a < n; a++)
+		{
+			ot_alpha_row(&tree, tsp_inst.hk_pi, a, alpha, mark);
+			for (int b = a + 1; b < n; b++)
+			{
+				if (tree.value + alpha[b] > threshold)
+				{
+					eliminated[cx_xpos(a, b, n)] = true;
+				}
+			}
+		}
+	}
+
+	int cnt = 0;
+	for (int j = 0; j < tsp_inst.ncols; j++)
+	{
+		if (eliminated[j])
+		{
+			indices[cnt++] = j;
+		}
+	}
+
+	// all the bounds are changed with a single call
+	if (cnt > 0)
+	{
+		char *lu = (char *)malloc(cnt * sizeof(char));
+		double *bd = (double *)calloc(cnt, sizeof(double));
+		if (lu == NULL || bd == NULL)
+		{
+			log_error("error in allocating memory for edge elimination");
+			utils_safe_free(lu);
+			utils_safe_free(bd);
+			e = RESOURCE_EXHAUSTED;
+			goto cx_free;
+		}
+		memset(lu, 'U', cnt * sizeof(char));
+
+		if (CPXchgbds(env, lp, cnt, indices, lu, bd))
+		{
+			log_error("CPXchgbds() error in edge elimination");
+			e = INTERNAL;
+		}
+
+		utils_safe_free(lu);
+		utils_safe_free(bd);
+	}
+
+	log_info("edge elimination: %d of %d edges survive (%.1f%% eliminated)", tsp_inst.ncols - cnt, tsp_inst.ncols, 100.0 * cnt / tsp_inst.ncols);
+
+cx_free:
+	utils_safe_free(indices);
+	utils_safe_free(eliminated);
+	utils_safe_free(alpha);
+	utils_safe_free(mark);
+	ot_free(&tree);
+
+	return e;
+}
+
 static int CPXPUBLIC callback_branch_and_cut(CPXCALLBACKCONTEXTptr context, CPXLONG contextid, void *userhandle)
 {
 	log_debug("callback called");
 
+	if (__atomic_load_n(&cx_mipstart_pending, __ATOMIC_ACQUIRE))
+	{
+		cx_check_mipstart(context);
+	}
+
 	switch (contextid)
 	{
 	case CPX_CALLBACKCONTEXT_CANDIDATE:
@@ -882,6 +1336,8 @@ static int CPXPUBLIC callback_branch_and_cut(CPXCALLBACKCONTEXTptr context, CPXL
 static int CPXPUBLIC callback_candidate(CPXCALLBACKCONTEXTptr context)
 {
 	log_debug("CANDIDATE CALLBACK");
+	st_add(ST_CALLBACK_CANDIDATE, 1);
+	struct timespec start = st_now();
 
 	// return value, if everything is ok, should be 0, else 1
 	int ret_value = 0;
@@ -918,6 +1374,7 @@ static int CPXPUBLIC callback_candidate(CPXCALLBACKCONTEXTptr context)
 	// reject the candidate if the solution is not a single tour
 	if (solution.ncomp > 1)
 	{
+		// the constraints of a rejected candidate are not guaranteed to stay in the model, so they are not recorded in the pool
 		int nnz = 0;
 		double *rhs = (double *)calloc(solution.ncomp, sizeof(double));
 		char *sense = (char *)calloc(solution.ncomp, sizeof(char));
@@ -935,6 +1392,8 @@ static int CPXPUBLIC callback_candidate(CPXCALLBACKCONTEXTptr context)
 		}
 
 		log_info("candidate solution rejected and cut added");
+		st_add(ST_CANDIDATES_REJECTED, 1);
+		st_add(ST_CUTS_CANDIDATE, solution.ncomp);
 
 		// free resources
 		utils_safe_free(rhs);
@@ -955,6 +1414,7 @@ cx_free:
 	utils_safe_free(xstar);
 	utils_safe_free(solution.comp);
 	utils_safe_free(solution.path);
+	st_time(ST_TIME_SEPARATION, &start);
 
 	return ret_value;
 }
@@ -963,6 +1423,7 @@ static int CPXPUBLIC callback_relaxation(CPXCALLBACKCONTEXTptr context)
 {
 
 	log_debug("RELAXATION CALLBACK");
+	st_add(ST_CALLBACK_RELAXATION, 1);
 
 	// return value, if everything is ok, should be 0, else 1
 	int ret_value = 0;
@@ -977,22 +1438,23 @@ static int CPXPUBLIC callback_relaxation(CPXCALLBACKCONTEXTptr context)
 	int nodes = -1;
 	int depth = -1;
 
-	switch (tsp_env.skip_policy)
+	if (CPXcallbackgetinfoint(context, CPXCALLBACKINFO_THREADID, &threadid))
 	{
-	case BC_PROB:
-		// method 1
-		if (CPXcallbackgetinfoint(context, CPXCALLBACKINFO_THREADID, &threadid))
-		{
-			log_error("CPXcallbackgetinfoint on thread id");
-		};
+		log_error("CPXcallbackgetinfoint on thread id");
+	}
 
-		unsigned int seed = tsp_inst.threads_seeds[threadid];
+	// tours finished by the heuristic workers are posted before the callback is skipped
+	if (tsp_env.modified_costs)
+	{
+		cx_post_pool_tours(context);
+	}
 
-		log_info("before: %d", seed);
-		double prob = ((double)rand_r(&seed)) / RAND_MAX;
-		log_info("after: %d", seed);
-		tsp_inst.threads_seeds[threadid] = seed;
-		log_info("prob: %.3f", prob);
+	switch (tsp_env.skip_policy)
+	{
+	case BC_PROB:;
+		// method 1
+		double prob = rng_double(&tsp_inst.threads_rng[threadid]);
+		log_debug("prob: %.3f", prob);
 		if (prob > 0.1)
 		{
 			log_debug("skipped");
@@ -1033,6 +1495,7 @@ static int CPXPUBLIC callback_relaxation(CPXCALLBACKCONTEXTptr context)
 	}
 
 	// callback code
+	struct timespec start = st_now();
 	double *xstar = (double *)calloc(tsp_inst.ncols, sizeof(double));
 	double objval = CPX_INFBOUND;
 
@@ -1042,229 +1505,113 @@ static int CPXPUBLIC callback_relaxation(CPXCALLBACKCONTEXTptr context)
 	}
 
 	int ncomp = 0;
-	int *comps = NULL;
-	int *compscount = NULL;
 
 	// transform into elist format for Concorde
 	// elist[2*i] contains one node of the i-th edge, and elist[2*i+1] contains the other node
 	int *elist = (int *)calloc(2 * tsp_inst.ncols, sizeof(int));
 	double *new_xstar = (double *)calloc(tsp_inst.ncols, sizeof(double));
-	int num_edges = 0;
-	int k = 0;
-
-	int kpos = 0;
-
-	for (int i = 0; i < tsp_inst.nnodes; i++)
+	int num_edges = cx_build_elist(xstar, elist, new_xstar);
+
+	// Shrink the support graph with the Padberg-Rinaldi rules, then on the shrunk graph:
+	//  - if it is disconnected, every component is expanded back and added as a cut
+	//  - otherwise, find the cuts that violate the 2.0-EPSILON_BC threshold with exact min-cut
+	violatedcuts_passparams userhandle = {.context = context, .ncuts = 0};
+	CCcut_workspace *workspace = (threadid >= 0 && threadid < THREADS) ? &cx_workspaces[threadid] : NULL;
+	if (CCcut_violated_cuts_shrunk(tsp_inst.nnodes, num_edges, elist, new_xstar, 2.0 - EPSILON_BC, cc_add_violated_sec, &userhandle, &ncomp, workspace))
 	{
-		for (int j = i + 1; j < tsp_inst.nnodes; j++)
-		{
-
-			// take only points that contribute to the solution
-			if (xstar[cx_xpos(i, j, tsp_inst.nnodes)] > 0.001)
-			{
-				elist[k++] = i;
-				elist[k++] = j;
-
-				new_xstar[num_edges] = xstar[cx_xpos(i, j, tsp_inst.nnodes)];
-
-				// verified correspondence between edges and cplex columns
-				if (cx_xpos(i, j, tsp_inst.nnodes) != kpos)
-				{
-					log_error("cx_xpos error");
-				}
-
-				num_edges++;
-			}
-
-			kpos++;
-		}
-	}
-
-	// Detect the connected components of the graph. Receives:
-	// ncomp - number of connected components
-	// compscount - array to receive the number of connected components
-	// comps - array to receive the edges pertaining to each component
-	if (CCcut_connect_components(tsp_inst.nnodes, num_edges, elist, new_xstar, &ncomp, &compscount, &comps))
-	{
-		log_error("CCcut_connect_components");
+		log_error("CCcut_violated_cuts_shrunk");
 		ret_value = 1;
 		goto cx_free;
 	}
 
 	log_debug("number of components: %d", ncomp);
 
-	if (ncomp == 1)
+	// the point satisfies all the SECs, look for violated blossoms
+	if (ncomp == 1 && userhandle.ncuts == 0)
 	{
-		// connected graph, but it may not be a tsp solution
-
-		violatedcuts_passparams userhandle = {.context = context};
-
-		// find the cut that violate the 2.0-EPSILON_BC threshold
-		if (CCcut_violated_cuts(tsp_inst.nnodes, num_edges, elist, new_xstar, 2.0 - EPSILON_BC, cc_add_violated_sec, &userhandle))
+		int nblossoms = 0;
+		if (!err_ok(comb_blossoms(tsp_inst.nnodes, num_edges, elist, new_xstar, cc_add_blossom, &userhandle, &nblossoms)))
 		{
-			log_error("CCcut_violated_cuts");
+			log_error("comb_blossoms");
 			ret_value = 1;
 			goto cx_free;
 		}
+		log_debug("number of violated blossoms: %d", nblossoms);
 	}
-	else
-	{
 
-		log_info("Found %d components, adding cuts", ncomp);
-
-		// transform components array from concorde format to ours
-		// ours: index is the node, value is the components (starting from 1)
-
-		int *components = (int *)calloc(tsp_inst.nnodes, sizeof(int));
-
-		int start = 0;
-		for (int sub = 0; sub < ncomp; sub++)
+	// the heuristic workers build a tour guided by this point, it is posted by a later callback
+	if (tsp_env.modified_costs)
+	{
+		if (!hp_submit(&cx_heurpool, num_edges, elist, new_xstar))
 		{
-			for (int i = start; i < start + compscount[sub]; i++)
-			{
-				components[comps[i]] = sub + 1;
-			}
-			start += compscount[sub];
+			log_debug("heuristic workers busy, fractional point dropped");
 		}
+	}
 
-		// add all the subtour elimination constraints
-
-		int nnz = 0;
-		double *rhs = (double *)calloc(ncomp, sizeof(double));
-		char *sense = (char *)calloc(ncomp, sizeof(char));
-		int *matbeg = (int *)calloc(ncomp, sizeof(int));
-		double *matval = (double *)calloc(ncomp * tsp_inst.ncols, sizeof(double));
-		int *matind = (int *)calloc(ncomp * tsp_inst.ncols, sizeof(int));
-		cx_compute_cuts(components, ncomp, &nnz, rhs, sense, matbeg, matind, matval);
+cx_free:
+	utils_safe_free(xstar);
+	utils_safe_free(new_xstar);
+	utils_safe_free(elist);
+	st_time(ST_TIME_SEPARATION, &start);
 
-		int *purgeable = (int *)calloc(ncomp, sizeof(int));
-		int *local = (int *)calloc(ncomp, sizeof(int));
+	return ret_value;
+}
 
-		for (int i = 0; i < ncomp; i++)
+void cx_post_pool_tours(CPXCALLBACKCONTEXTptr context)
+{
+	hp_tour *tour;
+	while ((tour = hp_poll(&cx_heurpool)) != NULL)
+	{
+		double *xheu = (double *)calloc(tsp_inst.ncols, sizeof(double));
+		int *ind = (int *)malloc(tsp_inst.ncols * sizeof(int));
+		if (xheu == NULL || ind == NULL)
 		{
-			purgeable[i] = CPX_USECUT_FORCE; // The cut is added to the relaxation and stays there
-			local[i] = 0;					 // Means it is globally valid
+			log_error("error in allocating the heuristic solution to post");
+			utils_safe_free(xheu);
+			utils_safe_free(ind);
+			hp_tour_free(tour);
+			return;
 		}
 
-		// add all the cuts
-		int error = CPXcallbackaddusercuts(context, ncomp, nnz, rhs, sense, matbeg, matind, matval, purgeable, local);
-		if (error)
+		for (int i = 0; i < tsp_inst.nnodes; i++)
 		{
-			log_error("CPXcallbackaddusercuts error, cod %d", error);
-			ret_value = 1;
+			xheu[cx_xpos(i, tour->path[i], tsp_inst.nnodes)] = 1.0;
 		}
-
-		utils_safe_free(rhs);
-		utils_safe_free(sense);
-		utils_safe_free(matbeg);
-		utils_safe_free(matval);
-		utils_safe_free(matind);
-		utils_safe_free(purgeable);
-		utils_safe_free(local);
-
-		utils_safe_free(components);
-
-		// add user cuts gave an error, so we break from the loop and free all other resources
-		if (ret_value == 1)
+		for (int j = 0; j < tsp_inst.ncols; j++)
 		{
-			goto cx_free;
+			ind[j] = j;
 		}
-	}
-
-	// call the modified greedy and post its solution
-
-	if (tsp_env.modified_costs)
-	{
-		unsigned int seed = tsp_inst.threads_seeds[threadid];
-
-		double prob = ((double)rand_r(&seed)) / RAND_MAX;
-		tsp_inst.threads_seeds[threadid] = seed;
 
-		if (prob < 0.5)
+		// edges may have been fixed to 0 in the meantime, CPLEX checks the tour against the current model
+		if (CPXcallbackpostheursoln(context, tsp_inst.ncols, ind, xheu, tour->cost, CPXCALLBACKSOLUTION_CHECKFEAS))
 		{
-			log_info("computing a heuristic NN solution with xstar-weighted costs to post");
-			// modify costs
-			double *modified_costs = (double *)calloc(tsp_inst.nnodes * tsp_inst.nnodes, sizeof(double));
-			double *xheu = (double *)calloc(tsp_inst.ncols, sizeof(double));
-			int *ind = (int *)malloc(tsp_inst.ncols * sizeof(int));
-			tsp_solution solution;
-			tsp_init_solution(tsp_inst.nnodes, &solution);
-
-			for (int i = 0; i < tsp_inst.nnodes; i++)
-			{
-				for (int j = i + 1; j < tsp_inst.nnodes; j++)
-				{
-					double cost = tsp_inst.costs[i * tsp_inst.nnodes + j] * (1 - xstar[cx_xpos(i, j, tsp_inst.nnodes)]);
-					modified_costs[i * tsp_inst.nnodes + j] = cost;
-					modified_costs[j * tsp_inst.nnodes + i] = cost;
-				}
-			}
-
-			// run all nearest neighbor heuristic with xstar-weighted costs to post solution
-
-			double old_timelimit = tsp_env.timelimit;
-			if (tsp_env.timelimit > 0.0)
-			{
-				// set the new timelimit to 1/10 of the total time, to make it so the heuristic doesnt consume all of the available time
-				tsp_env.timelimit = old_timelimit / 10.0;
-			}
-			else
-			{
-				tsp_env.timelimit = 300.0 / 10.0; // 30 seconds
-			}
-
-			// run all nearest neighbor heuristic
-			ERROR_CODE error = h_Greedy_2opt_mod_costs(&solution, modified_costs);
-
-			// change the timelimit back to the original one
-			tsp_env.timelimit = old_timelimit;
-
-			if (!err_ok(error))
-			{
-				log_error("error in greedy for posting solution");
-				ret_value = 1;
-				goto mg_free;
-			}
-
-			// build a cplex solution and post it
-
-			for (int i = 0; i < tsp_inst.nnodes; i++)
-			{
-				xheu[cx_xpos(i, solution.path[i], tsp_inst.nnodes)] = 1.0;
-			}
-
-			for (int j = 0; j < tsp_inst.ncols; j++)
-			{
-				ind[j] = j;
-			}
-
-			if (CPXcallbackpostheursoln(context, tsp_inst.ncols, ind, xheu, solution.cost, CPXCALLBACKSOLUTION_NOCHECK))
-			{
-				log_error("CPXcallbackpostheursoln error");
-				error = INTERNAL;
-				goto mg_free;
-			}
-			else
-			{
-				log_debug("posted heuristic solution with modified cost: %f", solution.cost);
-			}
-
-		mg_free:
-			utils_safe_free(modified_costs);
-			utils_safe_free(solution.path);
-			utils_safe_free(xheu);
-			utils_safe_free(ind);
+			log_error("CPXcallbackpostheursoln error");
+		}
+		else
+		{
+			log_debug("posted heuristic solution with modified cost: %f", tour->cost);
+			st_add(ST_HEURISTIC_POSTED, 1);
 		}
+
+		utils_safe_free(xheu);
+		utils_safe_free(ind);
+		hp_tour_free(tour);
 	}
+}
 
-cx_free:
-	utils_safe_free(xstar);
-	utils_safe_free(new_xstar);
-	utils_safe_free(comps);
-	utils_safe_free(compscount);
-	utils_safe_free(elist);
+void cx_check_mipstart(CPXCALLBACKCONTEXTptr context)
+{
+	double incumbent = CPX_INFBOUND;
+	if (CPXcallbackgetinfodbl(context, CPXCALLBACKINFO_BEST_SOL, &incumbent) || incumbent >= CPX_INFBOUND)
+	{
+		return;
+	}
 
-	return ret_value;
+	// only the thread that clears the flag counts, costs are integer
+	if (__atomic_exchange_n(&cx_mipstart_pending, 0, __ATOMIC_ACQ_REL) && incumbent < cx_mipstart_cost + 0.5)
+	{
+		st_add(ST_MIPSTART_ACCEPTED, 1);
+	}
 }
 
 int cc_add_violated_sec(double cut_value, int cut_nnodes, int *cut_indexes, void *userhandle)
@@ -1295,7 +1642,8 @@ int cc_add_violated_sec(double cut_value, int cut_nnodes, int *cut_indexes, void
 	const char sense = 'L';
 	const double rhs = cut_nnodes - 1;
 	const int rmatbeg = 0;
-	const int purgeable = CPX_USECUT_PURGE; // The cut is added to the relaxation but can be purged later on if CPLEX deems the cut ineffective.
+	// cuts of disconnected components are forced, the others are added to the relaxation but can be purged later on if CPLEX deems the cut ineffective.
+	const int purgeable = (cut_value < EPSILON_BC) ? CPX_USECUT_FORCE : CPX_USECUT_PURGE;
 	const int local = 0;					// Array of flags that specifies for each cut whether it is only locally valid (value = 1) or globally valid (value = 0).
 
 	if (nnz <= 0)
@@ -1311,6 +1659,12 @@ int cc_add_violated_sec(double cut_value, int cut_nnodes, int *cut_indexes, void
 		return 1;
 	}
 
+	uh->ncuts++;
+	st_add(ST_CUTS_RELAXATION, 1);
+
+	// recorded to seed the models built later, the same set is added again whenever it is separated
+	cp_insert(&tsp_inst.sec_pool, cut_indexes, cut_nnodes);
+
 	log_debug("add user cut, edges %d", nnz);
 	log_debug("cut value: %.4f", cut_value);
 
@@ -1319,3 +1673,186 @@ int cc_add_violated_sec(double cut_value, int cut_nnodes, int *cut_indexes, void
 
 	return 0;
 }
+
+int cc_collect_sec(double cut_value, int cut_nnodes, int *cut_indexes, void *userhandle)
+{
+	cutbuffer *buffer = (cutbuffer *)userhandle;
+
+	if (cut_nnodes < 2)
+	{
+		return 0;
+	}
+
+	// a separated cut is violated by the current point so it is never in the LP, the pool only records it
+	cp_insert(&tsp_inst.sec_pool, cut_indexes, cut_nnodes);
+	if (!err_ok(cx_cutbuffer_add_sec(buffer, cut_indexes, cut_nnodes)))
+	{
+		return 1;
+	}
+
+	log_debug("collected cut, value %.4f", cut_value);
+
+	return 0;
+}
+
+ERROR_CODE cx_cutbuffer_reserve(cutbuffer *buffer, int nnz)
+{
+	// grow the buffer geometrically
+	if (buffer->nrows == buffer->rowcap)
+	{
+		buffer->rowcap = max(16, 2 * buffer->rowcap);
+		buffer->rhs = (double *)realloc(buffer->rhs, buffer->rowcap * sizeof(double));
+		buffer->sense = (char *)realloc(buffer->sense, buffer->rowcap * sizeof(char));
+		buffer->matbeg = (int *)realloc(buffer->matbeg, buffer->rowcap * sizeof(int));
+	}
+	if (buffer->nnz + nnz > buffer->nzcap)
+	{
+		buffer->nzcap = max(buffer->nnz + nnz, 2 * buffer->nzcap);
+		buffer->matind = (int *)realloc(buffer->matind, buffer->nzcap * sizeof(int));
+		buffer->matval = (double *)realloc(buffer->matval, buffer->nzcap * sizeof(double));
+	}
+	if (buffer->rhs == NULL || buffer->sense == NULL || buffer->matbeg == NULL || buffer->matind == NULL || buffer->matval == NULL)
+	{
+		log_error("error in allocating the cut buffer");
+		return RESOURCE_EXHAUSTED;
+	}
+
+	return T_OK;
+}
+
+ERROR_CODE cx_cutbuffer_add_sec(cutbuffer *buffer, const int *nodes, int nnodes)
+{
+	ERROR_CODE e = cx_cutbuffer_reserve(buffer, (nnodes * (nnodes - 1)) / 2);
+	if (!err_ok(e))
+	{
+		return e;
+	}
+
+	buffer->matbeg[buffer->nrows] = buffer->nnz;
+	for (int i = 0; i < nnodes; i++)
+	{
+		for (int j = i + 1; j < nnodes; j++)
+		{
+			buffer->matind[buffer->nnz] = cx_xpos(nodes[i], nodes[j], tsp_inst.nnodes);
+			buffer->matval[buffer->nnz] = 1.0;
+			buffer->nnz++;
+		}
+	}
+	buffer->rhs[buffer->nrows] = nnodes - 1.0;
+	buffer->sense[buffer->nrows] = 'L';
+	buffer->nrows++;
+
+	return T_OK;
+}
+
+ERROR_CODE cx_cutbuffer_flush(CPXENVptr env, CPXLPptr lp, cutbuffer *buffer)
+{
+	if (buffer->nrows > 0 && CPXaddrows(env, lp, 0, buffer->nrows, buffer->nnz, buffer->rhs, buffer->sense, buffer->matbeg, buffer->matind, buffer->matval, NULL, NULL))
+	{
+		log_error("CPXaddrows() error");
+		return INTERNAL;
+	}
+
+	buffer->nrows = 0;
+	buffer->nnz = 0;
+
+	return T_OK;
+}
+
+void cx_cutbuffer_free(cutbuffer *buffer)
+{
+	utils_safe_free(buffer->rhs);
+	utils_safe_free(buffer->sense);
+	utils_safe_free(buffer->matbeg);
+	utils_safe_free(buffer->matind);
+	utils_safe_free(buffer->matval);
+}
+
+int cx_blossom_row(int hsize, const int *handle, int nteeth, const int *teeth, int *index, double *value, double *rhs)
+{
+	int nnz = 0;
+
+	// x(E(H))
+	for (int i = 0; i < hsize; i++)
+	{
+		for (int j = i + 1; j < hsize; j++)
+		{
+			index[nnz] = cx_xpos(handle[i], handle[j], tsp_inst.nnodes);
+			value[nnz] = 1.0;
+			nnz++;
+		}
+	}
+
+	// x(T), the teeth have one end outside the handle so they are not in E(H)
+	for (int t = 0; t < nteeth; t++)
+	{
+		index[nnz] = cx_xpos(teeth[2 * t], teeth[2 * t + 1], tsp_inst.nnodes);
+		value[nnz] = 1.0;
+		nnz++;
+	}
+
+	*rhs = hsize + (nteeth - 1) / 2;
+
+	return nnz;
+}
+
+int cc_add_blossom(int hsize, const int *handle, int nteeth, const int *teeth, double violation, void *userhandle)
+{
+	violatedcuts_passparams *uh = (violatedcuts_passparams *)userhandle;
+
+	int maxnnz = (hsize * (hsize - 1)) / 2 + nteeth;
+	int *index = (int *)calloc(maxnnz, sizeof(int));
+	double *value = (double *)calloc(maxnnz, sizeof(double));
+	if (index == NULL || value == NULL)
+	{
+		log_error("error in allocating the blossom");
+		utils_safe_free(index);
+		utils_safe_free(value);
+		return 1;
+	}
+
+	double rhs;
+	int nnz = cx_blossom_row(hsize, handle, nteeth, teeth, index, value, &rhs);
+
+	const char sense = 'L';
+	const int rmatbeg = 0;
+	const int purgeable = CPX_USECUT_PURGE;
+	const int local = 0;
+
+	int ret_value = 0;
+	if (CPXcallbackaddusercuts(uh->context, 1, nnz, &rhs, &sense, &rmatbeg, index, value, &purgeable, &local))
+	{
+		log_error("CPXcallbackaddusercuts on blossom");
+		ret_value = 1;
+	}
+	else
+	{
+		uh->ncuts++;
+		st_add(ST_CUTS_BLOSSOM, 1);
+		log_debug("add blossom, |H| = %d, |T| = %d, violation %.4f", hsize, nteeth, violation);
+	}
+
+	utils_safe_free(index);
+	utils_safe_free(value);
+
+	return ret_value;
+}
+
+int cc_collect_blossom(int hsize, const int *handle, int nteeth, const int *teeth, double violation, void *userhandle)
+{
+	cutbuffer *buffer = (cutbuffer *)userhandle;
+
+	if (!err_ok(cx_cutbuffer_reserve(buffer, (hsize * (hsize - 1)) / 2 + nteeth)))
+	{
+		return 1;
+	}
+
+	buffer->matbeg[buffer->nrows] = buffer->nnz;
+	buffer->nnz += cx_blossom_row(hsize, handle, nteeth, teeth, buffer->matind + buffer->nnz, buffer->matval + buffer->nnz, &buffer->rhs[buffer->nrows]);
+	buffer->sense[buffer->nrows] = 'L';
+	buffer->nrows++;
+
+	log_debug("collected blossom, violation %.4f", violation);
+
+	return 0;
+}
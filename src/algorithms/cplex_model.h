@@ -1,5 +1,9 @@
 #include "../tsp.h"
 #include "heuristics.h"
+#include "combs.h"
+#include "onetree.h"
+#include "heurpool.h"
+#include "patching.h"
 
 #pragma GCC diagnostic push 
 #pragma GCC diagnostic ignored "-Wunused-function"
@@ -11,10 +15,40 @@
 #define EPSILON_BC 0.1
 #define THREADS 32
 
+#define ROOT_MAXITER 200        // maximum number of rounds of the root cutting-plane loop
+#define ROOT_STALL_ITERS 3      // the root loop stops after this number of rounds without improvement...
+#define ROOT_STALL_TOL 1.0E-4   // ...of at least this fraction of the bound
+
+#define ELIM_TOL 1.0E-6         // an edge is eliminated if its bound exceeds the incumbent by at least this fraction
+
 typedef struct{
     CPXCALLBACKCONTEXTptr context;
+    int ncuts;                  // number of cuts added to CPLEX
 } violatedcuts_passparams;
 
+typedef struct{
+    CPXENVptr env;
+    CPXLPptr lp;
+    int nadded;                 // number of pool cuts added to the model
+} poolcuts_passparams;
+
+typedef struct{
+    int nrows;                  // number of cuts in the buffer
+    int nnz;                    // number of non zero coefficients in the buffer
+    int rowcap;                 // capacity of rhs, sense and matbeg
+    int nzcap;                  // capacity of matind and matval
+    double* rhs;
+    char* sense;
+    int* matbeg;
+    int* matind;
+    double* matval;
+} cutbuffer;
+
+typedef struct{
+    cutbuffer* buffer;
+    int* nodes;                 // room for the nodes of a component
+} patchsecs_passparams;
+
 /**
  * @brief Solves the TSP finding the optimal solution with CPLEX, it has no subtour elimination constraint so the solution will not be valid
  * 
@@ -71,6 +105,16 @@ int cx_xpos(int i, int j, int nnodes);
  */
 ERROR_CODE cx_add_sec(CPXENVptr env, CPXLPptr lp, int* comp, int ncomp);
 
+/**
+ * @brief Appends to the cutbuffer the SEC of every component and records it in the cut pool, a component with all the
+ *        nodes is skipped
+ * 
+ * @param comp An array indicating the component to which each node belongs, labels between 1 and the number of nodes
+ * @param buffer Cutbuffer pointer
+ * @return ERROR_CODE 
+ */
+ERROR_CODE cx_collect_comp_secs(const int* comp, cutbuffer* buffer);
+
 /**
  * @brief Builds the Mixed-Integer Problem in DFJ formulation (without subtour elimination constraint)
  * 
@@ -97,17 +141,26 @@ void cx_build_sol(const double *xstar, tsp_solution* solution);
  */
 ERROR_CODE cx_handle_cplex_status(CPXENVptr env, CPXLPptr lp);
 
-
-//================================================================================
-// BENDERS UTILS
-//================================================================================
+/**
+ * @brief Adds to the model all the SECs in the cut pool, used to seed a new model with the cuts found in previous solves
+ * 
+ * @param env CPXENVptr
+ * @param lp CPXLPptr
+ * @return ERROR_CODE 
+ */
+ERROR_CODE cx_add_pool_cuts(CPXENVptr env, CPXLPptr lp);
 
 /**
- * @brief Patch together the two highest cost subtours in the current solution
+ * @brief Adds to the model the SECs inserted in the cut pool after a given clock, so that a model solved many times
+ *        keeps all the cuts separated by its previous solves
  * 
- * @param solution Current Tsp solution
+ * @param env CPXENVptr
+ * @param lp CPXLPptr
+ * @param since Pool clock of the last sync, -1 for all the cuts
+ * @return ERROR_CODE 
  */
-void cx_patching(tsp_solution* solution);
+ERROR_CODE cx_add_pool_cuts_since(CPXENVptr env, CPXLPptr lp, long since);
+
 
 //================================================================================
 // BRANCH & CUT UTILS
@@ -144,6 +197,90 @@ ERROR_CODE cx_branchcut_util(CPXENVptr env, CPXLPptr lp, int ncols, double* xsta
  */
 ERROR_CODE cx_add_mip_starts(CPXENVptr env, CPXLPptr lp, tsp_solution* solution);
 
+/**
+ * @brief Root cutting-plane loop: solves the LP relaxation, separates all the violated SECs and adds them in bulk until the bound stalls. 
+ *        The cuts are installed in the MIP before branching starts
+ * 
+ * @param env CPXENVptr
+ * @param lp CPXLPptr of the MIP
+ * @param dj Array of size ncols to receive the reduced costs of the final root LP, can be NULL
+ * @param lpbound Objective value of the final root LP, -CPX_INFBOUND if not available. Ignored if dj is NULL
+ * @return ERROR_CODE 
+ */
+ERROR_CODE cx_root_cuts(CPXENVptr env, CPXLPptr lp, double* dj, double* lpbound);
+
+/**
+ * @brief Reduced-cost edge elimination: every edge whose lower bound when forced in the tour exceeds the incumbent cost is fixed to 0.
+ *        Uses the reduced costs of the root LP and, if the Held-Karp penalties are available, the alpha values of the penalized 1-tree
+ * 
+ * @param env CPXENVptr
+ * @param lp CPXLPptr
+ * @param dj Reduced costs of the root LP, NULL to skip the LP test
+ * @param lpbound Objective value of the root LP
+ * @return ERROR_CODE 
+ */
+ERROR_CODE cx_eliminate_edges(CPXENVptr env, CPXLPptr lp, const double* dj, double lpbound);
+
+/**
+ * @brief Converts a (fractional) solution in the elist format used by Concorde, keeping only the edges with positive value
+ * 
+ * @param xstar Solution of the model
+ * @param elist Array of size 2*ncols to receive the edges, elist[2*i] and elist[2*i+1] are the endpoints of the i-th edge
+ * @param elist_x Array of size ncols to receive the values of the edges
+ * @return int Number of edges
+ */
+int cx_build_elist(const double* xstar, int* elist, double* elist_x);
+
+/**
+ * @brief Builds the row of a blossom inequality x(E(H)) + x(T) <= |H| + (|T|-1)/2
+ * 
+ * @param hsize |H|
+ * @param handle Nodes of the handle
+ * @param nteeth |T|
+ * @param teeth Endpoints of the teeth
+ * @param index Array of size hsize*(hsize-1)/2 + nteeth to receive the columns
+ * @param value Array of size hsize*(hsize-1)/2 + nteeth to receive the coefficients
+ * @param rhs Right hand side of the inequality
+ * @return int Number of non zero coefficients
+ */
+int cx_blossom_row(int hsize, const int* handle, int nteeth, const int* teeth, int* index, double* value, double* rhs);
+
+/**
+ * @brief Makes room in the cutbuffer for one more cut
+ * 
+ * @param buffer Cutbuffer pointer
+ * @param nnz Number of non zero coefficients of the cut
+ * @return ERROR_CODE 
+ */
+ERROR_CODE cx_cutbuffer_reserve(cutbuffer* buffer, int nnz);
+
+/**
+ * @brief Appends the SEC of a node set to the cutbuffer
+ * 
+ * @param buffer Cutbuffer pointer
+ * @param nodes Nodes of S, in any order
+ * @param nnodes |S|
+ * @return ERROR_CODE 
+ */
+ERROR_CODE cx_cutbuffer_add_sec(cutbuffer* buffer, const int* nodes, int nnodes);
+
+/**
+ * @brief Adds all the cuts in the cutbuffer to the model with a single CPXaddrows and empties the buffer
+ * 
+ * @param env CPXENVptr
+ * @param lp CPXLPptr
+ * @param buffer Cutbuffer pointer
+ * @return ERROR_CODE 
+ */
+ERROR_CODE cx_cutbuffer_flush(CPXENVptr env, CPXLPptr lp, cutbuffer* buffer);
+
+/**
+ * @brief Frees the arrays of the cutbuffer
+ * 
+ * @param buffer Cutbuffer pointer
+ */
+void cx_cutbuffer_free(cutbuffer* buffer);
+
 //================================================================================
 // CALLBACKS
 //================================================================================
@@ -174,6 +311,21 @@ static int CPXPUBLIC callback_candidate(CPXCALLBACKCONTEXTptr context);
  */
 static int CPXPUBLIC callback_relaxation(CPXCALLBACKCONTEXTptr context);
 
+/**
+ * @brief Posts to CPLEX the tours built by the heuristic workers since the last call, each one is checked for
+ *        feasibility by CPLEX
+ * 
+ * @param context CPXCALLBACKCONTEXTptr of the relaxation callback
+ */
+void cx_post_pool_tours(CPXCALLBACKCONTEXTptr context);
+
+/**
+ * @brief Counts the last MIP start as accepted if the first incumbent CPLEX reports has its cost
+ * 
+ * @param context CPXCALLBACKCONTEXTptr of any callback
+ */
+void cx_check_mipstart(CPXCALLBACKCONTEXTptr context);
+
 /**
  * @brief Callback function called by Concorde, corresponds to int (*doit_fn) in the documentation. 
  * 
@@ -184,3 +336,40 @@ static int CPXPUBLIC callback_relaxation(CPXCALLBACKCONTEXTptr context);
  * @return int 0 if it is successful, 1 otherwise
  */
 int cc_add_violated_sec(double cut_value, int cut_nnodes, int* cut_indexes, void* userhandle);
+
+/**
+ * @brief Callback function called by Concorde, appends the SEC of the cut to the cutbuffer if it is not in the cut pool
+ * 
+ * @param cut_value Value of the cut
+ * @param cut_nnodes Number of nodes in the cut
+ * @param cut_indexes Array that specify the index of the nodes in the cut
+ * @param userhandle pointer to a cutbuffer
+ * @return int 0 if it is successful, 1 otherwise
+ */
+int cc_collect_sec(double cut_value, int cut_nnodes, int* cut_indexes, void* userhandle);
+
+/**
+ * @brief Function called by comb_blossoms in the relaxation callback, adds the blossom as a user cut
+ * 
+ * @param hsize |H|
+ * @param handle Nodes of the handle
+ * @param nteeth |T|
+ * @param teeth Endpoints of the teeth
+ * @param violation Violation of the inequality
+ * @param userhandle pointer to violatedcuts_passparams struct
+ * @return int 0 if it is successful, 1 otherwise
+ */
+int cc_add_blossom(int hsize, const int* handle, int nteeth, const int* teeth, double violation, void* userhandle);
+
+/**
+ * @brief Function called by comb_blossoms in the root cutting-plane loop, appends the blossom to the cutbuffer
+ * 
+ * @param hsize |H|
+ * @param handle Nodes of the handle
+ * @param nteeth |T|
+ * @param teeth Endpoints of the teeth
+ * @param violation Violation of the inequality
+ * @param userhandle pointer to a cutbuffer
+ * @return int 0 if it is successful, 1 otherwise
+ */
+int cc_collect_blossom(int hsize, const int* handle, int nteeth, const int* teeth, double violation, void* userhandle);
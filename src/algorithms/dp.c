@@ -0,0 +1,220 @@
+#include "dp.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DP_X86 1
+#endif
+
+// min over k of row[k] + col[k]
+static int32_t dp_minplus_scalar(const int32_t* row, const int32_t* col, int m){
+    int32_t best = DP_INF;
+    for(int k=0; k<m; k++){
+        int32_t v = row[k] + col[k];
+        if(v < best){
+            best = v;
+        }
+    }
+    return best;
+}
+
+#ifdef DP_X86
+// same as dp_minplus_scalar, 8 lanes at a time. Compiled for AVX2 only here, it is called only if the CPU supports it
+__attribute__((target("avx2")))
+static int32_t dp_minplus_avx2(const int32_t* row, const int32_t* col, int m){
+    __m256i best = _mm256_set1_epi32(DP_INF);
+    int k = 0;
+    for(; k+8<=m; k+=8){
+        __m256i r = _mm256_loadu_si256((const __m256i*)(row + k));
+        __m256i c = _mm256_loadu_si256((const __m256i*)(col + k));
+        best = _mm256_min_epi32(best, _mm256_add_epi32(r, c));
+    }
+
+    // horizontal minimum of the 8 lanes
+    __m128i v = _mm_min_epi32(_mm256_castsi256_si128(best), _mm256_extracti128_si256(best, 1));
+    v = _mm_min_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_min_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    int32_t res = _mm_cvtsi128_si32(v);
+
+    for(; k<m; k++){
+        int32_t x = row[k] + col[k];
+        if(x < res){
+            res = x;
+        }
+    }
+    return res;
+}
+#endif
+
+static int32_t (*dp_minplus)(const int32_t*, const int32_t*, int) = dp_minplus_scalar;
+
+void* dp_layer_thread(void* arg){
+    dp_layer* l = (dp_layer*) arg;
+    int m = l->m;
+
+    // contiguous chunk of the layer, subsets next to each other share many rows
+    long len = l->end - l->begin;
+    int first = l->begin + (int)(len * l->id / l->nthreads);
+    int last = l->begin + (int)(len * (l->id + 1) / l->nthreads);
+
+    for(int s=first; s<last; s++){
+        uint32_t S = l->subsets[s];
+        int32_t* row = &l->dp[(size_t)S * m];
+
+        for(int j=0; j<m; j++){
+            if(!(S & (1u << j))){
+                row[j] = DP_INF;
+            }else if(S == (1u << j)){
+                row[j] = l->zcosts[j];
+            }else{
+                uint32_t prev = S ^ (1u << j);
+                row[j] = dp_minplus(&l->dp[(size_t)prev * m], &l->tcosts[j * m], m);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+ERROR_CODE dp_HeldKarp(void){
+    ERROR_CODE e = T_OK;
+    int n = tsp_inst.nnodes;
+    int m = n - 1;
+
+    log_info("running Held-Karp dynamic programming");
+
+    if(n < 3){
+        log_error("the instance needs at least 3 nodes");
+        return FAILED_PRECONDITION;
+    }
+    if(n > DP_MAX_NODES){
+        log_error("Held-Karp dynamic programming supports at most %d nodes", DP_MAX_NODES);
+        return INVALID_ARGUMENT;
+    }
+
+#ifdef DP_X86
+    if(__builtin_cpu_supports("avx2")){
+        dp_minplus = dp_minplus_avx2;
+        log_debug("using AVX2 min-plus reduction");
+    }
+#endif
+
+    uint32_t nsubsets = 1u << m;
+
+    int32_t* dp = (int32_t*) malloc((size_t)nsubsets * m * sizeof(int32_t));
+    int32_t* tcosts = (int32_t*) malloc(m * m * sizeof(int32_t));
+    int32_t* zcosts = (int32_t*) malloc(m * sizeof(int32_t));
+    uint32_t* subsets = (uint32_t*) malloc(nsubsets * sizeof(uint32_t));
+    int* layerbeg = (int*) calloc(m + 2, sizeof(int));
+    int* seq = (int*) malloc(m * sizeof(int));
+    int nthreads = (n >= DP_PARALLEL_NODES) ? max(1, tsp_env.threads) : 1;
+    pthread_t* threads = (pthread_t*) calloc(nthreads, sizeof(pthread_t));
+    dp_layer* layers = (dp_layer*) calloc(nthreads, sizeof(dp_layer));
+    tsp_solution solution;
+    tsp_init_solution(n, &solution);
+    if(dp == NULL || tcosts == NULL || zcosts == NULL || subsets == NULL || layerbeg == NULL || seq == NULL ||
+       threads == NULL || layers == NULL || solution.path == NULL){
+        log_error("error in allocating the dynamic programming table");
+        e = RESOURCE_EXHAUSTED;
+        goto dp_free;
+    }
+
+    // costs are rounded to integers, the longest path must fit in DP_INF
+    for(int j=0; j<m; j++){
+        zcosts[j] = (int32_t)tsp_get_cost(0, j + 1);
+        for(int k=0; k<m; k++){
+            double c = (k == j) ? 0.0 : tsp_get_cost(k + 1, j + 1);
+            if(c * n >= DP_INF){
+                log_error("edge costs too large for 32 bit dynamic programming");
+                e = INVALID_ARGUMENT;
+                goto dp_free;
+            }
+            tcosts[j * m + k] = (int32_t)c;
+        }
+    }
+
+    // subsets sorted by cardinality, each layer only depends on the previous one
+    for(uint32_t S=1; S<nsubsets; S++){
+        layerbeg[__builtin_popcount(S) + 1]++;
+    }
+    for(int c=1; c<=m+1; c++){
+        layerbeg[c] += layerbeg[c-1];
+    }
+    for(uint32_t S=1; S<nsubsets; S++){
+        subsets[layerbeg[__builtin_popcount(S)]++] = S;
+    }
+    for(int c=m+1; c>0; c--){
+        layerbeg[c] = layerbeg[c-1];
+    }
+    layerbeg[0] = 0;
+
+    for(int c=1; c<=m; c++){
+        for(int t=0; t<nthreads; t++){
+            layers[t] = (dp_layer){.dp = dp, .tcosts = tcosts, .zcosts = zcosts, .subsets = subsets,
+                                   .begin = layerbeg[c], .end = layerbeg[c+1], .id = t, .nthreads = nthreads, .m = m};
+        }
+        if(nthreads == 1){
+            dp_layer_thread(&layers[0]);
+            continue;
+        }
+        for(int t=0; t<nthreads; t++){
+            pthread_create(&threads[t], NULL, dp_layer_thread, &layers[t]);
+        }
+        for(int t=0; t<nthreads; t++){
+            pthread_join(threads[t], NULL);
+        }
+    }
+
+    // close the tour in node 0 and rebuild it backwards
+    uint32_t S = nsubsets - 1;
+    int last = 0;
+    int64_t best = INT64_MAX;
+    for(int j=0; j<m; j++){
+        int64_t c = (int64_t)dp[(size_t)S * m + j] + zcosts[j];
+        if(c < best){
+            best = c;
+            last = j;
+        }
+    }
+
+    seq[m-1] = last;
+    for(int pos=m-2; pos>=0; pos--){
+        uint32_t prev = S ^ (1u << last);
+        int32_t target = dp[(size_t)S * m + last];
+        for(int k=0; k<m; k++){
+            if((prev & (1u << k)) && dp[(size_t)prev * m + k] + tcosts[last * m + k] == target){
+                seq[pos] = k;
+                break;
+            }
+        }
+        S = prev;
+        last = seq[pos];
+    }
+
+    solution.path[0] = seq[0] + 1;
+    for(int i=0; i<m-1; i++){
+        solution.path[seq[i] + 1] = seq[i+1] + 1;
+    }
+    solution.path[seq[m-1] + 1] = 0;
+    solution.cost = tsp_solution_cost(solution.path);
+
+    log_info("Held-Karp dynamic programming: optimal tour %.2f", solution.cost);
+
+    e = tsp_update_best_solution(&solution);
+    if(e == CANCELLED){
+        e = T_OK;
+    }
+
+dp_free:
+    utils_safe_free(dp);
+    utils_safe_free(tcosts);
+    utils_safe_free(zcosts);
+    utils_safe_free(subsets);
+    utils_safe_free(layerbeg);
+    utils_safe_free(seq);
+    utils_safe_free(threads);
+    utils_safe_free(layers);
+    utils_safe_free(solution.path);
+    utils_safe_free(solution.comp);
+
+    return e;
+}
@@ -0,0 +1,56 @@
+#ifndef DP_H_
+#define DP_H_
+
+/**
+ * @file dp.h
+ * @brief Exact Held-Karp dynamic programming for tiny instances. dp[S][j] is the cost of the cheapest path that starts
+ *        from node 0, visits all the nodes of S (a subset of 1..n-1) and ends in j. Each subset is a row of n-1 int32 costs,
+ *        the minimum over the predecessors is vectorized with AVX2 when the CPU supports it
+ * @version 0.1
+ * @date 2024-06-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <pthread.h>
+#include <stdint.h>
+
+#include "../tsp.h"
+
+#define DP_MAX_NODES 22             // above this size the table does not fit in memory
+#define DP_AUTO_NODES 16            // default size below which every algorithm is replaced by the DP
+#define DP_PARALLEL_NODES 18        // below this size the threads cost more than they save
+#define DP_INF (INT32_MAX / 2)      // cost of the infeasible states, DP_INF + any edge cost does not overflow
+
+/**
+ * @brief Data shared by the threads working on the same layer
+ *
+ */
+typedef struct {
+    int32_t* dp;                    // 2^(n-1) rows of n-1 costs
+    const int32_t* tcosts;          // tcosts[j * (n-1) + k] is the cost of edge k-j, nodes shifted by one
+    const int32_t* zcosts;          // zcosts[j] is the cost of edge 0-j
+    const uint32_t* subsets;        // subsets sorted by cardinality
+    int begin;                      // subsets[begin..end) is the layer
+    int end;
+    int id;                         // thread id
+    int nthreads;
+    int m;                          // n-1
+} dp_layer;
+
+/**
+ * @brief Solves the TSP to optimality with the Held-Karp dynamic programming
+ *
+ * @return ERROR_CODE
+ */
+ERROR_CODE dp_HeldKarp(void);
+
+/**
+ * @brief Computes the rows of the subsets assigned to one thread in a layer
+ *
+ * @param arg dp_layer pointer
+ * @return void* NULL
+ */
+void* dp_layer_thread(void* arg);
+
+#endif
@@ -40,12 +40,9 @@ ERROR_CODE h_Greedy_iterative(){
 	tsp_init_solution(tsp_inst.nnodes, &solution);
 
     for(int i=0; i<tsp_inst.nnodes; i++){
-        if(tsp_env.timelimit != -1.0){
-            double ex_time = utils_timeelapsed(&tsp_inst.c);
-            if(ex_time > tsp_env.timelimit){
-                e = DEADLINE_EXCEEDED;
-                break;
-            }
+        if(dl_expired()){
+            e = DEADLINE_EXCEEDED;
+            break;
         }
 
         log_debug("starting greedy with node %d", i);
@@ -80,13 +77,10 @@ ERROR_CODE h_greedy_2opt(){
 	tsp_init_solution(tsp_inst.nnodes, &solution);
 
     for(int i=0; i<tsp_inst.nnodes; i++){
-        if(tsp_env.timelimit != -1.0){
-            double ex_time = utils_timeelapsed(&tsp_inst.c);
-            if(ex_time > tsp_env.timelimit){
-                log_warn("time limit exceeded in greedy 2opt");
-                e = DEADLINE_EXCEEDED;
-                break;
-            }
+        if(dl_expired()){
+            log_warn("time limit exceeded in greedy 2opt");
+            e = DEADLINE_EXCEEDED;
+            break;
         }
 
         log_debug("starting greedy with node %d", i);
@@ -121,12 +115,9 @@ ERROR_CODE h_Greedy_2opt_mod_costs( tsp_solution* solution, double* costs){
     //tsp_solution solution = tsp_init_solution(tsp_inst.nnodes);
 
     for(int i=0; i<tsp_inst.nnodes; i++){
-        if(tsp_env.timelimit != -1.0){
-            double ex_time = utils_timeelapsed(&tsp_inst.c);
-            if(ex_time > tsp_env.timelimit){
-                e = DEADLINE_EXCEEDED;
-                break;
-            }
+        if(dl_expired()){
+            e = DEADLINE_EXCEEDED;
+            break;
         }
 
         //log_debug("starting greedy with node %d", i);
@@ -179,8 +170,8 @@ ERROR_CODE h_ExtraMileage(){
 
         break;
     case EM_RANDOM:
-        nodeA = rand() % (tsp_inst.nnodes + 1);
-        nodeB = rand() % (tsp_inst.nnodes - nodeA + 1) + nodeA;
+        nodeA = rng_int(&tsp_inst.rng, tsp_inst.nnodes);
+        nodeB = (nodeA + 1 + rng_int(&tsp_inst.rng, tsp_inst.nnodes - 1)) % tsp_inst.nnodes;
         break;
     default:
         log_warn("aborted");
@@ -226,6 +217,7 @@ ERROR_CODE h_greedyutil( int starting_node, tsp_solution* solution, double* cost
     }
 
     ERROR_CODE e = T_OK;
+    struct timespec start = st_now();
 
     int* visited = (int*)calloc(tsp_inst.nnodes, sizeof(int));
 
@@ -237,13 +229,10 @@ ERROR_CODE h_greedyutil( int starting_node, tsp_solution* solution, double* cost
 
     while(!done){
         // check that we have not exceed time limit
-        double ex_time = utils_timeelapsed(&tsp_inst.c);
-        if(tsp_env.timelimit != -1.0){
-            if(ex_time > tsp_env.timelimit){
-                log_warn("time limit exceeded in greedy util");
-                e = DEADLINE_EXCEEDED;
-                break;
-            }
+        if(dl_expired()){
+            log_warn("time limit exceeded in greedy util");
+            e = DEADLINE_EXCEEDED;
+            break;
         }
 
         // identify minimum distance from the current node
@@ -283,12 +272,14 @@ ERROR_CODE h_greedyutil( int starting_node, tsp_solution* solution, double* cost
     solution->cost = sol_cost;
 
     utils_safe_free(visited);
+    st_time(ST_TIME_CONSTRUCTION, &start);
 
     return e;
 }
 
 ERROR_CODE h_extramileage_util( tsp_solution* solution, int nodeA, int nodeB){
     ERROR_CODE error = T_OK;    
+    struct timespec start = st_now();
 
     // initalize visited array
     bool* visited = (bool*) calloc(tsp_inst.nnodes, sizeof(int));
@@ -305,12 +296,9 @@ ERROR_CODE h_extramileage_util( tsp_solution* solution, int nodeA, int nodeB){
 
     while(num_visited < tsp_inst.nnodes){
         // time limit check
-        if(tsp_env.timelimit != -1.0){
-            double ex_time = utils_timeelapsed(&tsp_inst.c);
-            if(ex_time > tsp_env.timelimit){
-                error = DEADLINE_EXCEEDED;
-                break;
-            }
+        if(dl_expired()){
+            error = DEADLINE_EXCEEDED;
+            break;
         }
 
         double mileage = __DBL_MAX__;
@@ -362,6 +350,7 @@ ERROR_CODE h_extramileage_util( tsp_solution* solution, int nodeA, int nodeB){
 
         log_debug("current cost: %f", solution->cost);
     }
+    st_time(ST_TIME_CONSTRUCTION, &start);
 
     return error;
 }
@@ -0,0 +1,358 @@
+#include "heurpool.h"
+
+typedef struct {
+    int a;
+    int b;
+    double w;
+} hp_edge;
+
+static void hp_job_free(hp_job* job){
+    if(job == NULL){
+        return;
+    }
+    utils_safe_free(job->elist);
+    utils_safe_free(job->x);
+    free(job);
+}
+
+static int hp_compare(const void* a, const void* b){
+    double x = ((const hp_edge*)a)->w, y = ((const hp_edge*)b)->w;
+    return (x > y) - (x < y);
+}
+
+static int hp_find(int* parent, int v){
+    while(parent[v] != v){
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+ERROR_CODE hp_start(hp_pool* pool, int nworkers){
+    memset(pool, 0, sizeof(hp_pool));
+    pool->nworkers = 0;
+
+    ERROR_CODE e = hp_queue_init(&pool->jobs, HP_QUEUE_SIZE);
+    if(err_ok(e)){
+        e = hp_queue_init(&pool->tours, HP_QUEUE_SIZE);
+    }
+    if(!err_ok(e) || sem_init(&pool->pending, 0, 0) != 0){
+        log_error("error in initializing the heuristic pool");
+        utils_safe_free(pool->jobs.cells);
+        utils_safe_free(pool->tours.cells);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    nworkers = (nworkers < HP_MAX_WORKERS) ? nworkers : HP_MAX_WORKERS;
+    for(int t=0; t<nworkers; t++){
+        if(pthread_create(&pool->threads[t], NULL, hp_thread, pool) != 0){
+            log_warn("could not start heuristic worker %d", t);
+            break;
+        }
+        pool->nworkers++;
+    }
+
+    log_info("heuristic pool started with %d workers", pool->nworkers);
+
+    return T_OK;
+}
+
+void hp_stop(hp_pool* pool){
+    if(pool->jobs.cells == NULL){
+        return;
+    }
+
+    __atomic_store_n(&pool->stop, 1, __ATOMIC_RELEASE);
+    for(int t=0; t<pool->nworkers; t++){
+        sem_post(&pool->pending);
+    }
+    for(int t=0; t<pool->nworkers; t++){
+        pthread_join(pool->threads[t], NULL);
+    }
+
+    hp_job* job;
+    while((job = (hp_job*) hp_queue_pop(&pool->jobs)) != NULL){
+        hp_job_free(job);
+    }
+    hp_tour* tour;
+    while((tour = (hp_tour*) hp_queue_pop(&pool->tours)) != NULL){
+        hp_tour_free(tour);
+    }
+
+    log_info("heuristic pool: %ld fractional points submitted, %ld dropped, %ld tours built",
+             pool->submitted, pool->dropped, pool->built);
+
+    sem_destroy(&pool->pending);
+    utils_safe_free(pool->jobs.cells);
+    utils_safe_free(pool->tours.cells);
+    pool->nworkers = 0;
+}
+
+bool hp_submit(hp_pool* pool, int nedges, const int* elist, const double* x){
+    if(pool->jobs.cells == NULL || pool->nworkers == 0){
+        return false;
+    }
+
+    hp_job* job = (hp_job*) malloc(sizeof(hp_job));
+    if(job == NULL){
+        return false;
+    }
+    job->nedges = nedges;
+    job->elist = (int*) malloc(2 * nedges * sizeof(int));
+    job->x = (double*) malloc(nedges * sizeof(double));
+    if(job->elist == NULL || job->x == NULL){
+        hp_job_free(job);
+        return false;
+    }
+    memcpy(job->elist, elist, 2 * nedges * sizeof(int));
+    memcpy(job->x, x, nedges * sizeof(double));
+
+    // workers are busy with older points, this one is dropped
+    if(!hp_queue_push(&pool->jobs, job)){
+        __atomic_add_fetch(&pool->dropped, 1, __ATOMIC_RELAXED);
+        hp_job_free(job);
+        return false;
+    }
+
+    __atomic_add_fetch(&pool->submitted, 1, __ATOMIC_RELAXED);
+    sem_post(&pool->pending);
+    return true;
+}
+
+hp_tour* hp_poll(hp_pool* pool){
+    if(pool->tours.cells == NULL){
+        return NULL;
+    }
+    return (hp_tour*) hp_queue_pop(&pool->tours);
+}
+
+void hp_tour_free(hp_tour* tour){
+    if(tour == NULL){
+        return;
+    }
+    utils_safe_free(tour->path);
+    free(tour);
+}
+
+//================================================================================
+// HEURPOOL UTILS
+//================================================================================
+
+ERROR_CODE hp_queue_init(hp_queue* q, size_t size){
+    q->cells = (hp_cell*) malloc(size * sizeof(hp_cell));
+    if(q->cells == NULL){
+        return RESOURCE_EXHAUSTED;
+    }
+    for(size_t i=0; i<size; i++){
+        q->cells[i].seq = i;
+        q->cells[i].data = NULL;
+    }
+    q->mask = size - 1;
+    q->head = 0;
+    q->tail = 0;
+
+    return T_OK;
+}
+
+bool hp_queue_push(hp_queue* q, void* data){
+    size_t pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    while(1){
+        hp_cell* c = &q->cells[pos & q->mask];
+        size_t seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+        if(dif == 0){
+            // the cell is free in this turn, claim it
+            if(__atomic_compare_exchange_n(&q->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                c->data = data;
+                __atomic_store_n(&c->seq, pos + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        }else if(dif < 0){
+            // the cell still holds the element of the previous turn
+            return false;
+        }else{
+            pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+void* hp_queue_pop(hp_queue* q){
+    size_t pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    while(1){
+        hp_cell* c = &q->cells[pos & q->mask];
+        size_t seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if(dif == 0){
+            if(__atomic_compare_exchange_n(&q->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                void* data = c->data;
+                // free for the producers of the next turn
+                __atomic_store_n(&c->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+                return data;
+            }
+        }else if(dif < 0){
+            return NULL;
+        }else{
+            pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+hp_tour* hp_build_tour(cl_tour* t, const hp_job* job){
+    int n = t->n;
+    int nedges = job->nedges + n * CL_NCAND;
+
+    hp_tour* tour = (hp_tour*) malloc(sizeof(hp_tour));
+    hp_edge* edges = (hp_edge*) malloc(nedges * sizeof(hp_edge));
+    int* parent = (int*) malloc(n * sizeof(int));
+    int* deg = (int*) calloc(n, sizeof(int));
+    int* adj = (int*) malloc(2 * n * sizeof(int));
+    int* ends = (int*) malloc(n * sizeof(int));
+    bool* visited = (bool*) calloc(n, sizeof(bool));
+    if(tour == NULL || edges == NULL || parent == NULL || deg == NULL || adj == NULL || ends == NULL || visited == NULL){
+        utils_safe_free(tour);
+        tour = NULL;
+        goto hp_free;
+    }
+    tour->path = (int*) malloc(n * sizeof(int));
+    if(tour->path == NULL){
+        utils_safe_free(tour);
+        tour = NULL;
+        goto hp_free;
+    }
+
+    // support edges are cheaper the closer x is to 1, the other neighbours keep their cost
+    int m = 0;
+    for(int e=0; e<job->nedges; e++){
+        int a = job->elist[2 * e], b = job->elist[2 * e + 1];
+        double x = (job->x[e] < 1.0) ? job->x[e] : 1.0;
+        edges[m++] = (hp_edge){.a = a, .b = b, .w = tsp_get_cost(a, b) * (1.0 - x)};
+    }
+    for(int i=0; i<n; i++){
+        for(int h=0; h<CL_NCAND; h++){
+            int j = t->cand[i * CL_NCAND + h];
+            if(j > i){
+                edges[m++] = (hp_edge){.a = i, .b = j, .w = tsp_get_cost(i, j)};
+            }
+        }
+    }
+    qsort(edges, m, sizeof(hp_edge), hp_compare);
+
+    // greedy matching into paths, duplicated edges are discarded as cycles
+    for(int v=0; v<n; v++){
+        parent[v] = v;
+        adj[2 * v] = -1;
+        adj[2 * v + 1] = -1;
+    }
+    int taken = 0;
+    for(int e=0; e<m && taken<n-1; e++){
+        int a = edges[e].a, b = edges[e].b;
+        if(deg[a] >= 2 || deg[b] >= 2){
+            continue;
+        }
+        int ra = hp_find(parent, a), rb = hp_find(parent, b);
+        if(ra == rb){
+            continue;
+        }
+        parent[ra] = rb;
+        adj[2 * a + deg[a]++] = b;
+        adj[2 * b + deg[b]++] = a;
+        taken++;
+    }
+
+    // paths joined by nearest endpoint
+    int nends = 0;
+    for(int v=0; v<n; v++){
+        if(deg[v] < 2){
+            ends[nends++] = v;
+        }
+    }
+
+    int p = 0;
+    int start = ends[0];
+    while(1){
+        int prev = -1, v = start;
+        while(v >= 0){
+            visited[v] = true;
+            t->tour[p] = v;
+            t->pos[v] = p;
+            p++;
+            int next = (adj[2 * v] != prev) ? adj[2 * v] : adj[2 * v + 1];
+            prev = v;
+            v = next;
+        }
+        if(p == n){
+            break;
+        }
+
+        int best = -1;
+        double bestcost = __DBL_MAX__;
+        for(int k=0; k<nends; k++){
+            if(!visited[ends[k]]){
+                double c = tsp_get_cost(prev, ends[k]);
+                if(c < bestcost){
+                    bestcost = c;
+                    best = ends[k];
+                }
+            }
+        }
+        start = best;
+    }
+
+    cl_local_search(t, NULL, 0);
+
+    tour->cost = 0.0;
+    for(int i=0; i<n; i++){
+        tour->path[t->tour[i]] = t->tour[(i + 1) % n];
+        tour->cost += tsp_get_cost(t->tour[i], t->tour[(i + 1) % n]);
+    }
+
+hp_free:
+    utils_safe_free(edges);
+    utils_safe_free(parent);
+    utils_safe_free(deg);
+    utils_safe_free(adj);
+    utils_safe_free(ends);
+    utils_safe_free(visited);
+
+    return tour;
+}
+
+void* hp_thread(void* arg){
+    hp_pool* pool = (hp_pool*) arg;
+
+    cl_tour t;
+    if(!err_ok(cl_tour_init(&t, tsp_inst.points, tsp_inst.nnodes))){
+        log_error("heuristic worker could not allocate its tour");
+        return NULL;
+    }
+
+    while(1){
+        sem_wait(&pool->pending);
+        if(__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE)){
+            break;
+        }
+
+        hp_job* job = (hp_job*) hp_queue_pop(&pool->jobs);
+        if(job == NULL){
+            continue;
+        }
+
+        hp_tour* tour = hp_build_tour(&t, job);
+        hp_job_free(job);
+        if(tour == NULL){
+            continue;
+        }
+
+        __atomic_add_fetch(&pool->built, 1, __ATOMIC_RELAXED);
+        if(!hp_queue_push(&pool->tours, tour)){
+            // the callbacks did not collect the previous tours yet
+            hp_tour_free(tour);
+        }
+    }
+
+    cl_tour_free(&t);
+
+    return NULL;
+}
@@ -0,0 +1,172 @@
+#ifndef HEURPOOL_H_
+#define HEURPOOL_H_
+
+/**
+ * @file heurpool.h
+ * @brief Pool of heuristic threads working next to CPLEX. The relaxation callback submits the support of the fractional
+ *        point, the workers build a greedy tour on the costs weighted by (1 - x*) restricted to the support and the
+ *        neighbour lists, improve it with 2-opt and Or-opt and hand it back to be posted at the next callback. Both
+ *        directions go through bounded lock-free queues, when a queue is full the snapshot or the tour is dropped, so
+ *        the CPLEX threads never wait
+ * @version 0.1
+ * @date 2024-06-21
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <pthread.h>
+#include <semaphore.h>
+
+#include "cluster.h"
+
+#define HP_QUEUE_SIZE 16            // capacity of each queue, power of two
+#define HP_MAX_WORKERS 2            // the other cores are left to CPLEX
+
+/**
+ * @brief Cell of a bounded multi-producer multi-consumer queue
+ *
+ */
+typedef struct {
+    size_t seq;                     // turn of the cell, tells producers and consumers if it is free or full
+    void* data;
+} hp_cell;
+
+/**
+ * @brief Bounded multi-producer multi-consumer lock-free queue of pointers (Vyukov)
+ *
+ */
+typedef struct {
+    hp_cell* cells;
+    size_t mask;
+    size_t head;                    // next position to pop
+    size_t tail;                    // next position to push
+} hp_queue;
+
+/**
+ * @brief Support of a fractional point, as a list of edges
+ *
+ */
+typedef struct {
+    int nedges;
+    int* elist;                     // endpoints of edge e are elist[2e] and elist[2e+1]
+    double* x;                      // value of each edge
+} hp_job;
+
+/**
+ * @brief Tour built by a worker
+ *
+ */
+typedef struct {
+    int* path;                      // successor of each node
+    double cost;
+} hp_tour;
+
+/**
+ * @brief Heuristic worker pool
+ *
+ */
+typedef struct {
+    hp_queue jobs;
+    hp_queue tours;
+    sem_t pending;                  // number of jobs in the queue, workers sleep on it
+    pthread_t threads[HP_MAX_WORKERS];
+    int nworkers;
+    int stop;                       // set to stop the workers
+    long submitted;                 // statistics, updated atomically
+    long dropped;
+    long built;
+} hp_pool;
+
+/**
+ * @brief Starts the workers
+ *
+ * @param pool Pool
+ * @param nworkers Number of workers, at most HP_MAX_WORKERS
+ * @return ERROR_CODE
+ */
+ERROR_CODE hp_start(hp_pool* pool, int nworkers);
+
+/**
+ * @brief Stops the workers and frees the jobs and tours left in the queues. Does nothing if the pool is not running
+ *
+ * @param pool Pool
+ */
+void hp_stop(hp_pool* pool);
+
+/**
+ * @brief Copies the support of a fractional point in a new job, never blocks
+ *
+ * @param pool Pool
+ * @param nedges Number of edges of the support
+ * @param elist Endpoints of the edges
+ * @param x Value of each edge
+ * @return true If the job was queued
+ * @return false If the queue was full or the pool is not running
+ */
+bool hp_submit(hp_pool* pool, int nedges, const int* elist, const double* x);
+
+/**
+ * @brief Takes a finished tour, never blocks
+ *
+ * @param pool Pool
+ * @return hp_tour* Tour to free with hp_tour_free, NULL if none is ready
+ */
+hp_tour* hp_poll(hp_pool* pool);
+
+/**
+ * @brief Frees a tour returned by hp_poll
+ *
+ * @param tour Tour
+ */
+void hp_tour_free(hp_tour* tour);
+
+//================================================================================
+// HEURPOOL UTILS
+//================================================================================
+
+/**
+ * @brief Allocates an empty queue
+ *
+ * @param q Queue
+ * @param size Capacity, power of two
+ * @return ERROR_CODE
+ */
+ERROR_CODE hp_queue_init(hp_queue* q, size_t size);
+
+/**
+ * @brief Pushes a pointer, safe from any thread
+ *
+ * @param q Queue
+ * @param data Pointer
+ * @return true If the pointer was queued
+ * @return false If the queue is full
+ */
+bool hp_queue_push(hp_queue* q, void* data);
+
+/**
+ * @brief Pops a pointer, safe from any thread
+ *
+ * @param q Queue
+ * @return void* Pointer, NULL if the queue is empty
+ */
+void* hp_queue_pop(hp_queue* q);
+
+/**
+ * @brief Builds a tour from a fractional point: greedy matching of the support and neighbour list edges by increasing
+ *        cost*(1-x), fragments joined by nearest endpoint, then 2-opt and Or-opt on the real costs
+ *
+ * @param t Tour of the worker, its neighbour lists are used as candidate edges
+ * @param job Fractional point
+ * @return hp_tour* Tour, NULL if out of memory
+ */
+hp_tour* hp_build_tour(cl_tour* t, const hp_job* job);
+
+/**
+ * @brief Main function of a worker
+ *
+ * @param arg hp_pool pointer
+ * @return void* NULL
+ */
+void* hp_thread(void* arg);
+
+#endif
@@ -6,6 +6,8 @@ ERROR_CODE mh_HardFixing()
 
     log_info("running Hard Fixing");
 
+    hf_journal journal = {0};
+
     // open CPLEX model
     int error;
     CPXENVptr env = CPXopenCPLEX(&error);
@@ -40,19 +42,21 @@ ERROR_CODE mh_HardFixing()
     memcpy(solution.path, tsp_inst.best_solution.path, tsp_inst.nnodes * sizeof(int));
     solution.cost = tsp_inst.best_solution.cost;
 
+    e = hf_journal_init(&journal, tsp_inst.nnodes);
+    if (!err_ok(e))
+    {
+        goto mh_free;
+    }
+
     int i = 0;
     while (1)
     {
         // check if exceeds time
-        double ex_time = utils_timeelapsed(&tsp_inst.c);
-        if (tsp_env.timelimit != -1.0)
+        if (dl_expired())
         {
-            if (ex_time > tsp_env.timelimit)
-            {
-                log_warn("deadline exceeded in hard fixing");
-                e = DEADLINE_EXCEEDED;
-                break;
-            }
+            log_warn("deadline exceeded in hard fixing");
+            e = DEADLINE_EXCEEDED;
+            break;
         }
 
         log_info("iteration: %d", i);
@@ -67,11 +71,11 @@ ERROR_CODE mh_HardFixing()
 
         // set remaining time limit for cplex
         // 1/10 of the total remaining time
-        double time_remain = (tsp_env.timelimit - ex_time) / 10;
+        double time_remain = dl_remaining() / 10;
         log_debug("time assigned to mip solver : %.4f", time_remain);
 
         // FIXING
-        e = hf_fixing(env, lp, &solution);
+        e = hf_fixing(env, lp, &solution, tsp_env.hf_prob, &tsp_inst.rng, &journal);
         if (!err_ok(e))
         {
             log_error("error in fixing");
@@ -95,18 +99,25 @@ ERROR_CODE mh_HardFixing()
         }
 
         // FIXING UNDO
-        e = hf_undofixing(env, lp);
+        e = hf_undofixing(env, lp, &journal);
         if (!err_ok(e))
         {
             log_error("error in undo fixing");
             goto mh_free;
         }
 
+        if (ot_gap_reached(tsp_inst.best_solution.cost))
+        {
+            log_info("gap from the Held-Karp bound reached, stopping hard fixing");
+            break;
+        }
+
         i++;
     }
 
 mh_free:
     utils_safe_free(solution.path);
+    hf_journal_free(&journal);
 
     // free and close cplex model
     CPXfreeprob(env, &lp);
@@ -115,12 +126,103 @@ mh_free:
     return e;
 }
 
+ERROR_CODE mh_HardFixingParallel()
+{
+    ERROR_CODE e = T_OK;
+    int nworkers = tsp_env.hf_workers;
+
+    log_info("running parallel Hard Fixing with %d workers", nworkers);
+
+    hf_shared shared = {.iterations = 0, .error = T_OK};
+    pthread_mutex_init(&shared.lock, NULL);
+    pthread_t *threads = (pthread_t *)calloc(nworkers, sizeof(pthread_t));
+    hf_worker *workers = (hf_worker *)calloc(nworkers, sizeof(hf_worker));
+    if (threads == NULL || workers == NULL)
+    {
+        log_error("error in allocating memory for parallel Hard Fixing");
+        e = RESOURCE_EXHAUSTED;
+        goto mh_free;
+    }
+
+    // CPLEX gains little from many threads on the restricted MIPs, the cores go to the workers instead
+    int cpxthreads = (tsp_env.threads / nworkers > 1) ? tsp_env.threads / nworkers : 1;
+
+    // models are built one at a time, cx_initialize changes the global state
+    for (int t = 0; t < nworkers; t++)
+    {
+        hf_worker *w = &workers[t];
+        w->id = t;
+        w->shared = &shared;
+        rng_split(&tsp_inst.rng, t, &w->rng);
+
+        // portfolio of fixing probabilities around hf_prob, from larger neighbourhoods to smaller ones
+        w->prob = (nworkers > 1) ? tsp_env.hf_prob - HF_PROB_SPREAD + 2.0 * HF_PROB_SPREAD * t / (nworkers - 1) : tsp_env.hf_prob;
+        w->prob = (w->prob < HF_PROB_MIN) ? HF_PROB_MIN : w->prob;
+        w->prob = (w->prob > HF_PROB_MAX) ? HF_PROB_MAX : w->prob;
+
+        e = hf_worker_init(w, t == 0, cpxthreads);
+        if (!err_ok(e))
+        {
+            log_error("code %d : error in initializing worker %d", e, t);
+            goto mh_free;
+        }
+    }
+
+    if (!tsp_validate_solution(tsp_inst.nnodes, tsp_inst.best_solution.path))
+    {
+        e = h_Greedy();
+        if (!err_ok(e))
+        {
+            log_error("code %d : error in the initial solution of parallel Hard Fixing", e);
+            goto mh_free;
+        }
+    }
+
+    for (int t = 0; t < nworkers; t++)
+    {
+        pthread_create(&threads[t], NULL, hf_thread, &workers[t]);
+    }
+    for (int t = 0; t < nworkers; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    log_info("parallel Hard Fixing: %d iterations, best cost %.2f", shared.iterations, tsp_inst.best_solution.cost);
+
+    e = shared.error;
+    if (err_ok(e) && dl_expired())
+    {
+        log_warn("deadline exceeded in hard fixing");
+        e = DEADLINE_EXCEEDED;
+    }
+
+mh_free:
+    for (int t = 0; t < nworkers && workers != NULL; t++)
+    {
+        if (workers[t].lp != NULL)
+        {
+            CPXfreeprob(workers[t].env, &workers[t].lp);
+        }
+        if (workers[t].env != NULL)
+        {
+            CPXcloseCPLEX(&workers[t].env);
+        }
+    }
+    utils_safe_free(threads);
+    utils_safe_free(workers);
+    pthread_mutex_destroy(&shared.lock);
+
+    return e;
+}
+
 ERROR_CODE mh_LocalBranching()
 {
     ERROR_CODE e = T_OK;
 
     log_info("running Local Branching");
 
+    lb_row lb = {.row = -1};
+
     // open CPLEX model
     int error;
     CPXENVptr env = CPXopenCPLEX(&error);
@@ -172,6 +274,14 @@ ERROR_CODE mh_LocalBranching()
     int st_counter = 0;
     int small_improv = 0;
 
+    // the cuts already in the pool are in the model, the ones separated by the sub-MIPs are added as they come
+    long synced = tsp_inst.sec_pool.clock;
+    e = lb_row_init(&lb, tsp_inst.nnodes);
+    if (!err_ok(e))
+    {
+        goto mh_free;
+    }
+
     // file to hold solution value in each iteration
     FILE *f = fopen("results/LocalBranchingK.dat", "w+");
     int i = 0;
@@ -179,15 +289,11 @@ ERROR_CODE mh_LocalBranching()
     while (1)
     {
         // check if exceeds time
-        double ex_time = utils_timeelapsed(&tsp_inst.c);
-        if (tsp_env.timelimit != -1.0)
+        if (dl_expired())
         {
-            if (ex_time > tsp_env.timelimit)
-            {
-                log_warn("deadline exceeded in local branching");
-                e = DEADLINE_EXCEEDED;
-                break;
-            }
+            log_warn("deadline exceeded in local branching");
+            e = DEADLINE_EXCEEDED;
+            break;
         }
 
         log_info("iteration %d", i);
@@ -203,21 +309,29 @@ ERROR_CODE mh_LocalBranching()
             goto mh_free;
         }
 
-        // Add LB constraint
-        e = lb_add_constraint(env, lp, &solution, K);
+        // Set LB constraint
+        e = lb_set_constraint(env, lp, &lb, &solution, K);
+        if (!err_ok(e))
+        {
+            log_error("error in setting local braching constraint");
+            goto mh_free;
+        }
+
+        e = cx_add_pool_cuts_since(env, lp, synced);
         if (!err_ok(e))
         {
-            log_error("error in adding local braching constraint");
+            log_error("error in adding the cuts of the pool");
             goto mh_free;
         }
+        synced = tsp_inst.sec_pool.clock;
 
         // set remaining time limit for cplex
         // 1/10 of the total remaining time
-        double time_remain = (tsp_env.timelimit - ex_time) / 3;
+        double time_remain = dl_remaining() / 3;
         log_info("time assigned to mip solver : %.4f", time_remain);
 
-        // MIP SOLVER
-        e = mh_mipsolver2(env, lp, &solution, time_remain);
+        // MIP SOLVER, SECs are separated by the callbacks
+        e = mh_mipsolver(env, lp, &solution, time_remain);
         if (!err_ok(e))
         {
             log_error("error in mip solver");
@@ -280,12 +394,10 @@ ERROR_CODE mh_LocalBranching()
             goto mh_free;
         }
 
-        // Remove LB constraint
-        e = lb_remove_constraint(env, lp);
-        if (!err_ok(e))
+        if (ot_gap_reached(tsp_inst.best_solution.cost))
         {
-            log_error("error in removing local braching constraint");
-            goto mh_free;
+            log_info("gap from the Held-Karp bound reached, stopping local branching");
+            break;
         }
 
         i += 1;
@@ -293,6 +405,7 @@ ERROR_CODE mh_LocalBranching()
 
 mh_free:
     fclose(f);
+    lb_row_free(&lb);
     utils_safe_free(solution.path);
     utils_safe_free(solution.comp);
 
@@ -303,253 +416,902 @@ mh_free:
     return e;
 }
 
-//================================================================================
-// GENERAL UTILS
-//================================================================================
-
-ERROR_CODE mh_mipsolver(CPXENVptr env, CPXLPptr lp, tsp_solution *solution, double time_available)
+ERROR_CODE mh_ProximitySearch()
 {
     ERROR_CODE e = T_OK;
+    int n = tsp_inst.nnodes;
+    double theta = tsp_env.ps_theta;
 
-    // set the time limit
-    if (CPXsetdblparam(env, CPXPARAM_TimeLimit, time_available))
+    log_info("running Proximity Search");
+
+    // the heuristic solutions posted by the relaxation callback are not checked against the cutoff row
+    bool old_modified_costs = tsp_env.modified_costs;
+    tsp_env.modified_costs = false;
+
+    double *costs = NULL;
+    double *obj = NULL;
+    int *ind = NULL;
+    int *center = NULL;
+    tsp_solution solution = {0};
+
+    // open CPLEX model
+    int error;
+    CPXENVptr env = CPXopenCPLEX(&error);
+    if (error)
     {
-        log_error("error in CPXsetdblparam");
-        e = INTERNAL;
-        goto hf_free;
+        log_fatal("CPX code %d : CPXopenCPLEX() error", error);
+        e = FAILED_PRECONDITION;
+        goto mh_free;
+    }
+    CPXLPptr lp = CPXcreateprob(env, &error, "TSP model version 1");
+    if (error)
+    {
+        log_fatal("CPX code %d : CPXcreateprob() error", error);
+        e = FAILED_PRECONDITION;
+        goto mh_free;
     }
 
-    double *xstar = (double *)calloc(tsp_inst.ncols, sizeof(double));
-    int ncomp = 0;
-    int *comp = (int *)calloc(tsp_inst.ncols, sizeof(int));
-
-    e = cx_branchcut_util(env, lp, tsp_inst.ncols, xstar);
+    // initialize CPLEX model
+    e = cx_initialize(env, lp);
     if (!err_ok(e))
     {
-        log_error("error in branch&cut util");
-        goto hf_free;
+        log_error("error in initializing cplex model");
+        e = FAILED_PRECONDITION;
+        goto mh_free;
     }
 
-    // with the solution found by CPLEX, build the corresponding solution
-    cx_build_sol(xstar, solution);
-
-    log_info("cost: %.2f", solution->cost);
-    log_info("ncomp: %d", ncomp);
-
-hf_free:
-    utils_safe_free(xstar);
-    utils_safe_free(comp);
-    return e;
-}
+    log_info("CPLEX initialized correctly");
 
-ERROR_CODE mh_mipsolver2(CPXENVptr env, CPXLPptr lp, tsp_solution *solution, double time_available)
-{
-    int e = T_OK;
-    int cpxerror;
+    int ncols = tsp_inst.ncols;
+    costs = (double *)malloc(ncols * sizeof(double));
+    obj = (double *)malloc(ncols * sizeof(double));
+    ind = (int *)malloc(ncols * sizeof(int));
+    center = (int *)malloc(n * sizeof(int));
+    tsp_init_solution(n, &solution);
+    if (costs == NULL || obj == NULL || ind == NULL || center == NULL)
+    {
+        log_error("error in allocating memory for Proximity Search");
+        e = RESOURCE_EXHAUSTED;
+        goto mh_free;
+    }
 
-    double *xstar = (double *)malloc(tsp_inst.ncols * sizeof(double));
+    if (!tsp_validate_solution(n, tsp_inst.best_solution.path))
+    {
+        e = h_Greedy();
+        if (!err_ok(e))
+        {
+            log_error("code %d : error in the initial solution of Proximity Search", e);
+            goto mh_free;
+        }
+    }
+    memcpy(solution.path, tsp_inst.best_solution.path, n * sizeof(int));
+    solution.cost = tsp_inst.best_solution.cost;
+    memcpy(center, solution.path, n * sizeof(int));
 
-    // set the time limit
-    cpxerror = CPXsetdblparam(env, CPXPARAM_TimeLimit, time_available);
-    if (cpxerror)
+    // cutoff row, the original objective must improve the incumbent by theta
+    if (CPXgetobj(env, lp, costs, 0, ncols - 1))
     {
-        log_error("Error in tsp_cplex: CPXsetdblparam error (%d).", cpxerror);
+        log_error("error in CPXgetobj");
         e = INTERNAL;
         goto mh_free;
     }
-
-    // solve the model using cplex
-    cpxerror = CPXmipopt(env, lp);
-    if (cpxerror)
+    for (int j = 0; j < ncols; j++)
     {
-        log_error("Error in tsp_cplex: CPXmipopt error (%d).", cpxerror);
+        ind[j] = j;
+    }
+    double rhs = solution.cost - theta;
+    char sense = 'L';
+    int izero = 0;
+    char *cname = "proximity cutoff";
+    if (CPXaddrows(env, lp, 0, 1, ncols, &rhs, &sense, &izero, ind, costs, NULL, &cname))
+    {
+        log_error("error in CPXaddrows for the cutoff constraint");
         e = INTERNAL;
         goto mh_free;
     }
+    int cutoff = CPXgetnumrows(env, lp) - 1;
 
-    // get xstar
-    cpxerror = CPXgetx(env, lp, xstar, 0, CPXgetnumcols(env, lp) - 1);
-    if (cpxerror)
+    // objective: Hamming distance from the incumbent, with n edges in every tour it counts the edges not in the incumbent
+    for (int j = 0; j < ncols; j++)
     {
-        log_error("Error in tsp_cplex: CPXgetx error (%d).", cpxerror);
+        obj[j] = 1.0;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        obj[cx_xpos(i, center[i], n)] = 0.0;
+    }
+    if (CPXchgobj(env, lp, ncols, ind, obj))
+    {
+        log_error("error in CPXchgobj");
         e = INTERNAL;
         goto mh_free;
     }
 
-    cx_build_sol(xstar, solution);
-
-    log_info("solution found with %d components and cost %.0f", solution->ncomp, solution->cost);
+    // any solution of the model improves the incumbent, no need to look further
+    CPXsetintparam(env, CPX_PARAM_INTSOLLIM, 1);
 
-    // apply patching to fix the solution
-    while (solution->ncomp > 1)
+    long synced = tsp_inst.sec_pool.clock;
+    int i = 0;
+    while (1)
     {
-        cx_patching(solution);
-        log_debug("number of components: %d", solution->ncomp);
-        log_debug("current solution cost: %f", solution->cost);
-        log_debug("is solution a tour? %d", tsp_is_tour(solution->path, tsp_inst.nnodes));
-    }
-
-    log_info("applied Patching, updated cost: %.0f", solution->cost);
-
-// return status code from cplex
-mh_free:
-    utils_safe_free(xstar);
-    return e;
-}
-
-//================================================================================
-// HARD FIXING UTILS
-//================================================================================
+        // check if exceeds time
+        if (dl_expired())
+        {
+            log_warn("deadline exceeded in proximity search");
+            e = DEADLINE_EXCEEDED;
+            break;
+        }
 
-ERROR_CODE hf_fixing(CPXENVptr env, CPXLPptr lp, tsp_solution *solution)
-{
-    // choose E^tilde and set lb
+        log_info("iteration %d", i);
 
-    char *message = "executing fixing";
-    log_info(message);
+        // the incumbent violates the cutoff, CPLEX can repair it into a close solution
+        e = cx_add_mip_starts(env, lp, &solution);
+        if (!err_ok(e))
+        {
+            log_error("error add mip start");
+            goto mh_free;
+        }
 
-    ERROR_CODE e = T_OK;
-    int k = 0;
+        e = cx_add_pool_cuts_since(env, lp, synced);
+        if (!err_ok(e))
+        {
+            log_error("error in adding the cuts of the pool");
+            goto mh_free;
+        }
+        synced = tsp_inst.sec_pool.clock;
 
-    double one = 1.0;
-    const char lb = 'L';
-    for (int i = 0; i < tsp_inst.nnodes; i++)
-    {
-        // unsigned int seed = (unsigned) tsp_env.seed;
-        double prob = ((double)rand()) / RAND_MAX;
+        // 1/10 of the total remaining time
+        double time_remain = dl_remaining() / 10;
+        log_debug("time assigned to mip solver : %.4f", time_remain);
 
-        if (prob < tsp_env.hf_prob)
+        // MIP SOLVER, SECs are separated by the callbacks
+        e = mh_mipsolver(env, lp, &solution, time_remain);
+        if (!err_ok(e))
         {
-            k++;
-            log_debug("add edge (%d,%d) to E^tilde", i, solution->path[i]);
-            int index = cx_xpos(i, solution->path[i], tsp_inst.nnodes);
+            log_error("error in mip solver");
+            goto mh_free;
+        }
 
-            if (CPXchgbds(env, lp, 1, &index, &lb, &one))
+        if (solution.cost > tsp_inst.best_solution.cost - theta + PS_EPS)
+        {
+            if (CPXgetstat(env, lp) == CPXMIP_INFEASIBLE)
             {
-                log_error("error in changing the bound");
-                e = INTERNAL;
-                goto hf_free;
+                log_info("no tour improves the incumbent by %.2f, stopping proximity search", theta);
+                e = T_OK;
+                break;
             }
+            log_info("no improving tour found in time");
+            i++;
+            continue;
         }
-    }
-
-    log_status(message);
-
-    log_info("edges added: %d\n", k);
-
-hf_free:
-    return e;
-}
 
-ERROR_CODE hf_undofixing(CPXENVptr env, CPXLPptr lp)
-{
-    ERROR_CODE e = T_OK;
+        e = tsp_update_best_solution(&solution);
+        if (!err_ok(e))
+        {
+            log_error("code %d : error in updating best solution of Proximity Search", e);
+            goto mh_free;
+        }
 
-    double zero = 0.0;
-    const char lb = 'L';
-    for (int i = 0; i < tsp_inst.ncols; i++)
-    {
-        int pos = i;
-        if (CPXchgbds(env, lp, 1, &pos, &lb, &zero))
+        // recentre: the old incumbent edges cost 1 again, the new ones 0, and the cutoff follows the incumbent
+        for (int v = 0; v < n; v++)
+        {
+            ind[v] = cx_xpos(v, center[v], n);
+            obj[v] = 1.0;
+            ind[n + v] = cx_xpos(v, solution.path[v], n);
+            obj[n + v] = 0.0;
+        }
+        rhs = solution.cost - theta;
+        if (CPXchgobj(env, lp, n, ind, obj) || CPXchgobj(env, lp, n, ind + n, obj + n) ||
+            CPXchgrhs(env, lp, 1, &cutoff, &rhs))
         {
-            log_error("error in changing the bound");
+            log_error("error in recentering proximity search");
             e = INTERNAL;
-            goto hf_free;
+            goto mh_free;
         }
+        memcpy(center, solution.path, n * sizeof(int));
+
+        if (ot_gap_reached(tsp_inst.best_solution.cost))
+        {
+            log_info("gap from the Held-Karp bound reached, stopping proximity search");
+            break;
+        }
+
+        i++;
     }
 
-hf_free:
+mh_free:
+    tsp_env.modified_costs = old_modified_costs;
+    utils_safe_free(costs);
+    utils_safe_free(obj);
+    utils_safe_free(ind);
+    utils_safe_free(center);
+    utils_safe_free(solution.path);
+    utils_safe_free(solution.comp);
+
+    // free and close cplex model
+    CPXfreeprob(env, &lp);
+    CPXcloseCPLEX(&env);
+
     return e;
 }
 
-//================================================================================
-// LOCAL BRANCHING UTILS
-//================================================================================
-
-ERROR_CODE lb_add_constraint(CPXENVptr env, CPXLPptr lp, tsp_solution *solution, int k)
+ERROR_CODE mh_Popmusic()
 {
     ERROR_CODE e = T_OK;
+    int n = tsp_inst.nnodes;
 
-    int *index = (int *)calloc(tsp_inst.nnodes, sizeof(int));
-    double *value = (double *)calloc(tsp_inst.nnodes, sizeof(double));
-
-    double rhs = tsp_inst.nnodes - k;
-    char sense = 'G';
-    char **cname = (char **)malloc(1 * sizeof(char *)); // (char **) required by cplex...
-
-    size_t nbytes = snprintf(NULL, 0, "%s", "local branching") + 1; /* +1 for the '\0' */
-    cname[0] = (char *)malloc(nbytes);
-    snprintf(cname[0], nbytes, "%s", "local branching");
+    log_info("running POPMUSIC");
 
-    int izero = 0;
-
-    int nnz = 0;
-    for (int i = 0; i < tsp_inst.nnodes; i++)
+    // initial solution, the subpaths only improve it
+    e = h_Greedy();
+    if (!err_ok(e))
     {
-        index[nnz] = cx_xpos(i, solution->path[i], tsp_inst.nnodes);
-        value[nnz] = 1.0;
-        nnz++;
+        log_error("code %d : error in the initial solution of POPMUSIC", e);
+        return e;
     }
 
-    // Integrity check
-    if (nnz != tsp_inst.nnodes)
+    int r = (tsp_env.pm_r < n + 1) ? tsp_env.pm_r : n + 1;
+    int nsubpaths = (n + r - 2) / (r - 1);
+    int nthreads = (tsp_env.threads < nsubpaths) ? tsp_env.threads : nsubpaths;
+
+    int *seq = (int *)malloc((n + 1) * sizeof(int));
+    int *tmp = (int *)malloc((n + 1) * sizeof(int));
+    pthread_t *threads = (pthread_t *)calloc(nthreads, sizeof(pthread_t));
+    pm_worker *workers = (pm_worker *)calloc(nthreads, sizeof(pm_worker));
+    tsp_solution solution;
+    tsp_init_solution(n, &solution);
+    if (seq == NULL || tmp == NULL || threads == NULL || workers == NULL || solution.path == NULL)
     {
-        log_error("INTEGRITY CHECK: Error in tsp_convert_path_to_indval: k != nnodes (%d != %d).", nnz, tsp_inst.nnodes);
-        e = DATA_LOSS;
-        goto mh_free;
+        log_error("error in allocating memory for POPMUSIC");
+        e = RESOURCE_EXHAUSTED;
+        goto pm_free;
     }
 
-    for (int e = 0; e < nnz; e++)
+    // one CPLEX environment per thread, CPLEX itself runs sequentially since the parallelism is on the subpaths
+    for (int t = 0; t < nthreads; t++)
     {
-        if (index[e] < 0 || index[e] >= tsp_inst.ncols || value[e] != 1.0)
+        int error;
+        workers[t].env = CPXopenCPLEX(&error);
+        if (error)
         {
-            log_error("INTEGRITY CHECK: Error in tsp_convert_path_to_indval: filling ind or val (%d - %f).", index[e], value[e]);
-            e = INVALID_ARGUMENT;
-            goto mh_free;
+            log_fatal("CPX code %d : CPXopenCPLEX() error", error);
+            e = FAILED_PRECONDITION;
+            goto pm_free;
         }
-    }
+        CPXsetintparam(workers[t].env, CPX_PARAM_SCRIND, CPX_OFF);
+        CPXsetintparam(workers[t].env, CPX_PARAM_THREADS, 1);
+        if (CPXsetterminate(workers[t].env, &(tsp_inst.cplex_terminate)))
+        {
+            log_error("Error in CPXsetterminate");
+            e = INTERNAL;
+            goto pm_free;
+        }
+
+        workers[t].seq = seq;
+        workers[t].nsubpaths = nsubpaths;
+        workers[t].r = r;
+        workers[t].last = n;
+        workers[t].id = t;
+        workers[t].nthreads = nthreads;
+    }
+
+    log_info("%d subpaths of %d nodes, %d threads", nsubpaths, r, nthreads);
+
+    seq[0] = 0;
+    for (int i = 0; i < n; i++)
+    {
+        seq[i + 1] = tsp_inst.best_solution.path[seq[i]];
+    }
 
-    if (CPXaddrows(env, lp, 0, 1, tsp_inst.nnodes, &rhs, &sense, &izero, index, value, NULL, &cname[0]))
+    int stall = 0;
+    int sweep = 0;
+    while (stall < PM_STALL_SWEEPS)
     {
-        log_error("error in CPXaddrows for local branching constraints");
+        // check if exceeds time
+        if (dl_expired())
+        {
+            log_warn("deadline exceeded in POPMUSIC");
+            e = DEADLINE_EXCEEDED;
+            break;
+        }
+
+        // shift the cuts by half a subpath, so the endpoints of the last sweep can move
+        int shift = (r - 1) / 2;
+        for (int i = 0; i < n; i++)
+        {
+            tmp[i] = seq[(i + shift) % n];
+        }
+        memcpy(seq, tmp, n * sizeof(int));
+        seq[n] = seq[0];
+
+        if (nthreads == 1)
+        {
+            pm_thread(&workers[0]);
+        }
+        else
+        {
+            for (int t = 0; t < nthreads; t++)
+            {
+                pthread_create(&threads[t], NULL, pm_thread, &workers[t]);
+            }
+            for (int t = 0; t < nthreads; t++)
+            {
+                pthread_join(threads[t], NULL);
+            }
+        }
+
+        double gain = 0.0;
+        bool deadline = false;
+        for (int t = 0; t < nthreads; t++)
+        {
+            gain += workers[t].gain;
+            if (workers[t].error == DEADLINE_EXCEEDED || workers[t].error == CANCELLED)
+            {
+                deadline = true;
+            }
+            else if (!err_ok(workers[t].error))
+            {
+                log_error("code %d : error in POPMUSIC thread %d", workers[t].error, t);
+                e = workers[t].error;
+                goto pm_free;
+            }
+        }
+
+        log_info("sweep %d: gain %.2f", sweep, gain);
+
+        if (gain > PM_EPS)
+        {
+            // the subpaths are written back only when they improve, so the sequence is always a tour
+            for (int i = 0; i < n; i++)
+            {
+                solution.path[seq[i]] = seq[i + 1];
+            }
+            solution.cost = tsp_solution_cost(solution.path);
+
+            e = tsp_update_best_solution(&solution);
+            if (!err_ok(e))
+            {
+                log_error("code %d : error in updating best solution of POPMUSIC", e);
+                goto pm_free;
+            }
+            stall = 0;
+        }
+        else
+        {
+            stall++;
+        }
+
+        if (deadline)
+        {
+            log_warn("deadline exceeded in POPMUSIC");
+            e = DEADLINE_EXCEEDED;
+            break;
+        }
+
+        if (ot_gap_reached(tsp_inst.best_solution.cost))
+        {
+            log_info("gap from the Held-Karp bound reached, stopping POPMUSIC");
+            break;
+        }
+
+        sweep++;
+    }
+
+    if (e == CANCELLED)
+    {
+        e = T_OK;
+    }
+
+pm_free:
+    for (int t = 0; t < nthreads && workers != NULL; t++)
+    {
+        if (workers[t].env != NULL)
+        {
+            CPXcloseCPLEX(&workers[t].env);
+        }
+    }
+    utils_safe_free(seq);
+    utils_safe_free(tmp);
+    utils_safe_free(threads);
+    utils_safe_free(workers);
+    utils_safe_free(solution.path);
+
+    return e;
+}
+
+//================================================================================
+// GENERAL UTILS
+//================================================================================
+
+ERROR_CODE mh_mipsolver(CPXENVptr env, CPXLPptr lp, tsp_solution *solution, double time_available)
+{
+    ERROR_CODE e = T_OK;
+
+    double *xstar = (double *)calloc(tsp_inst.ncols, sizeof(double));
+    if (xstar == NULL)
+    {
+        log_error("error in allocating xstar");
+        return RESOURCE_EXHAUSTED;
+    }
+
+    // set the time limit
+    if (time_available > 0.0 && CPXsetdblparam(env, CPXPARAM_TimeLimit, time_available))
+    {
+        log_error("error in CPXsetdblparam");
+        e = INTERNAL;
+        goto hf_free;
+    }
+
+    e = cx_branchcut_util(env, lp, tsp_inst.ncols, xstar);
+    if (e == RESOURCE_EXHAUSTED || e == NOT_FOUND)
+    {
+        log_warn("no solution found by the mip solver, keeping the current one");
+        e = CANCELLED;
+        goto hf_free;
+    }
+    if (!err_ok(e))
+    {
+        log_error("error in branch&cut util");
+        goto hf_free;
+    }
+
+    // with the solution found by CPLEX, build the corresponding solution
+    cx_build_sol(xstar, solution);
+
+    // the candidate callback rejects every solution with subtours, patching is only a safeguard
+    if (solution->ncomp > 1)
+    {
+        log_warn("mip solution with %d components, patching", solution->ncomp);
+        e = pt_patch(solution, NULL, NULL);
+    }
+
+    log_info("cost: %.2f", solution->cost);
+
+hf_free:
+    utils_safe_free(xstar);
+    return e;
+}
+
+ERROR_CODE mh_mipsolver2(CPXENVptr env, CPXLPptr lp, tsp_solution *solution, double time_available)
+{
+    int e = T_OK;
+    int cpxerror;
+
+    double *xstar = (double *)malloc(tsp_inst.ncols * sizeof(double));
+
+    // set the time limit
+    cpxerror = CPXsetdblparam(env, CPXPARAM_TimeLimit, time_available);
+    if (cpxerror)
+    {
+        log_error("Error in tsp_cplex: CPXsetdblparam error (%d).", cpxerror);
         e = INTERNAL;
         goto mh_free;
     }
 
-mh_free:
-    utils_safe_free(cname[0]);
-    utils_safe_free(cname);
-    utils_safe_free(value);
-    utils_safe_free(index);
+    // solve the model using cplex
+    struct timespec start = st_now();
+    cpxerror = CPXmipopt(env, lp);
+    st_time(ST_TIME_MIP, &start);
+    if (cpxerror)
+    {
+        log_error("Error in tsp_cplex: CPXmipopt error (%d).", cpxerror);
+        e = INTERNAL;
+        goto mh_free;
+    }
+
+    // get xstar
+    cpxerror = CPXgetx(env, lp, xstar, 0, CPXgetnumcols(env, lp) - 1);
+    if (cpxerror)
+    {
+        log_error("Error in tsp_cplex: CPXgetx error (%d).", cpxerror);
+        e = INTERNAL;
+        goto mh_free;
+    }
 
+    cx_build_sol(xstar, solution);
+
+    log_info("solution found with %d components and cost %.0f", solution->ncomp, solution->cost);
+
+    // apply patching to fix the solution
+    e = pt_patch(solution, NULL, NULL);
+    if (!err_ok(e))
+    {
+        goto mh_free;
+    }
+
+    log_info("applied Patching, updated cost: %.0f", solution->cost);
+
+// return status code from cplex
+mh_free:
+    utils_safe_free(xstar);
     return e;
 }
 
-ERROR_CODE lb_remove_constraint(CPXENVptr env, CPXLPptr lp)
+//================================================================================
+// HARD FIXING UTILS
+//================================================================================
+
+static int hf_compare(const void *a, const void *b)
 {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+ERROR_CODE hf_fixing(CPXENVptr env, CPXLPptr lp, tsp_solution *solution, double prob, rng_state *rng, hf_journal *journal)
+{
+    // choose E^tilde and set lb
+
+    char *message = "executing fixing";
+    log_info(message);
+
     ERROR_CODE e = T_OK;
+    int n = tsp_inst.nnodes;
+
+    // WINDOW: the edges leaving the nodes closer to the center than radius stay free
+    int center = -1;
+    double radius = 0.0;
+    if (tsp_env.hf_policy == HF_WINDOW)
+    {
+        center = rng_int(rng, n);
+        for (int i = 0; i < n; i++)
+        {
+            journal->key[i] = (i == center) ? 0.0 : tsp_get_cost(center, i);
+        }
+        qsort(journal->key, n, sizeof(double), hf_compare);
+        int nfree = (int)((1.0 - prob) * n);
+        radius = (nfree < n) ? journal->key[nfree] : __DBL_MAX__;
+    }
 
-    int num_rows = CPXgetnumrows(env, lp);
-    if (num_rows == 0)
+    journal->count = 0;
+    for (int i = 0; i < n; i++)
     {
-        log_error("error in num_rows");
+        bool fix;
+        if (center >= 0)
+        {
+            fix = (i != center) && tsp_get_cost(center, i) >= radius;
+        }
+        else
+        {
+            fix = rng_double(rng) < prob;
+        }
+
+        if (fix)
+        {
+            log_debug("add edge (%d,%d) to E^tilde", i, solution->path[i]);
+            journal->index[journal->count] = cx_xpos(i, solution->path[i], n);
+            journal->lu[journal->count] = 'L';
+            journal->bd[journal->count] = 1.0;
+            journal->count++;
+        }
+    }
+
+    if (journal->count > 0 && CPXchgbds(env, lp, journal->count, journal->index, journal->lu, journal->bd))
+    {
+        log_error("error in changing the bounds");
+        journal->count = 0;
         e = INTERNAL;
-        goto lb_free;
+        goto hf_free;
     }
 
-    log_info("num_rows: %d", num_rows);
+    log_status(message);
 
-    if (CPXdelrows(env, lp, num_rows - 1, num_rows - 1))
+    log_info("edges added: %d\n", journal->count);
+
+hf_free:
+    return e;
+}
+
+ERROR_CODE hf_undofixing(CPXENVptr env, CPXLPptr lp, hf_journal *journal)
+{
+    ERROR_CODE e = T_OK;
+
+    if (journal->count == 0)
     {
+        return T_OK;
+    }
+
+    for (int i = 0; i < journal->count; i++)
+    {
+        journal->bd[i] = 0.0;
+    }
+    if (CPXchgbds(env, lp, journal->count, journal->index, journal->lu, journal->bd))
+    {
+        log_error("error in changing the bounds");
         e = INTERNAL;
-        log_error("error in CPXdelrows");
-        goto lb_free;
+        goto hf_free;
     }
+    journal->count = 0;
 
-lb_free:
+hf_free:
     return e;
 }
 
+ERROR_CODE hf_journal_init(hf_journal *journal, int nnodes)
+{
+    journal->count = 0;
+    journal->index = (int *)malloc(nnodes * sizeof(int));
+    journal->lu = (char *)malloc(nnodes * sizeof(char));
+    journal->bd = (double *)malloc(nnodes * sizeof(double));
+    journal->key = (double *)malloc(nnodes * sizeof(double));
+    if (journal->index == NULL || journal->lu == NULL || journal->bd == NULL || journal->key == NULL)
+    {
+        log_error("error in allocating the fixing journal");
+        hf_journal_free(journal);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    return T_OK;
+}
+
+void hf_journal_free(hf_journal *journal)
+{
+    utils_safe_free(journal->index);
+    utils_safe_free(journal->lu);
+    utils_safe_free(journal->bd);
+    utils_safe_free(journal->key);
+    journal->count = 0;
+}
+
+ERROR_CODE hf_worker_init(hf_worker *w, bool first, int cpxthreads)
+{
+    ERROR_CODE e = T_OK;
+
+    int error;
+    w->env = CPXopenCPLEX(&error);
+    if (error)
+    {
+        log_fatal("CPX code %d : CPXopenCPLEX() error", error);
+        return FAILED_PRECONDITION;
+    }
+    w->lp = CPXcreateprob(w->env, &error, "TSP model version 1");
+    if (error)
+    {
+        log_fatal("CPX code %d : CPXcreateprob() error", error);
+        return FAILED_PRECONDITION;
+    }
+
+    if (first)
+    {
+        e = cx_initialize(w->env, w->lp);
+        if (!err_ok(e))
+        {
+            log_error("error in initializing cplex model");
+            return FAILED_PRECONDITION;
+        }
+    }
+    else
+    {
+        // the cut pool is already filled by the first worker
+        cx_build_model(w->env, w->lp);
+        e = cx_add_pool_cuts(w->env, w->lp);
+        if (!err_ok(e))
+        {
+            log_error("error %d in add_pool_cuts", e);
+            return e;
+        }
+        if (CPXsetterminate(w->env, &(tsp_inst.cplex_terminate)))
+        {
+            log_error("Error in CPXsetterminate");
+            return INTERNAL;
+        }
+    }
+
+    CPXsetintparam(w->env, CPX_PARAM_SCRIND, CPX_OFF);
+    CPXsetintparam(w->env, CPX_PARAM_THREADS, cpxthreads);
+
+    return T_OK;
+}
+
+void *hf_thread(void *arg)
+{
+    hf_worker *w = (hf_worker *)arg;
+    hf_shared *sh = w->shared;
+    ERROR_CODE e = T_OK;
+
+    tsp_solution solution;
+    tsp_init_solution(tsp_inst.nnodes, &solution);
+    if (solution.path == NULL)
+    {
+        log_error("error in allocating the solution of worker %d", w->id);
+        e = RESOURCE_EXHAUSTED;
+        goto hf_free;
+    }
+    e = hf_journal_init(&w->journal, tsp_inst.nnodes);
+    if (!err_ok(e))
+    {
+        goto hf_free;
+    }
+
+    while (1)
+    {
+        if (dl_expired() || tsp_inst.cplex_terminate)
+        {
+            break;
+        }
+
+        // start from the best tour found by any worker
+        pthread_mutex_lock(&sh->lock);
+        bool stop = (sh->error != T_OK) || ot_gap_reached(tsp_inst.best_solution.cost);
+        memcpy(solution.path, tsp_inst.best_solution.path, tsp_inst.nnodes * sizeof(int));
+        solution.cost = tsp_inst.best_solution.cost;
+        pthread_mutex_unlock(&sh->lock);
+        if (stop)
+        {
+            break;
+        }
+
+        e = cx_add_mip_starts(w->env, w->lp, &solution);
+        if (!err_ok(e))
+        {
+            log_error("error add mip start");
+            break;
+        }
+
+        double time_remain = dl_remaining() / 10;
+
+        e = hf_fixing(w->env, w->lp, &solution, w->prob, &w->rng, &w->journal);
+        if (!err_ok(e))
+        {
+            log_error("error in fixing");
+            break;
+        }
+
+        e = mh_mipsolver2(w->env, w->lp, &solution, time_remain);
+        if (!err_ok(e))
+        {
+            log_error("error in mip solver");
+            break;
+        }
+
+        e = hf_undofixing(w->env, w->lp, &w->journal);
+        if (!err_ok(e))
+        {
+            log_error("error in undo fixing");
+            break;
+        }
+
+        pthread_mutex_lock(&sh->lock);
+        sh->iterations++;
+        ERROR_CODE update = tsp_update_best_solution(&solution);
+        pthread_mutex_unlock(&sh->lock);
+        if (update == T_OK)
+        {
+            log_info("worker %d (fixing probability %.2f) improved the incumbent", w->id, w->prob);
+        }
+    }
+
+hf_free:
+    if (!err_ok(e))
+    {
+        pthread_mutex_lock(&sh->lock);
+        if (sh->error == T_OK)
+        {
+            sh->error = e;
+        }
+        pthread_mutex_unlock(&sh->lock);
+    }
+    hf_journal_free(&w->journal);
+    utils_safe_free(solution.path);
+    utils_safe_free(solution.comp);
+
+    return NULL;
+}
+
+//================================================================================
+// LOCAL BRANCHING UTILS
+//================================================================================
+
+static int lb_compare(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+ERROR_CODE lb_row_init(lb_row *lb, int nnodes)
+{
+    lb->row = -1;
+    lb->cols = (int *)malloc(nnodes * sizeof(int));
+    lb->next = (int *)malloc(nnodes * sizeof(int));
+    lb->rowlist = (int *)malloc(2 * nnodes * sizeof(int));
+    lb->collist = (int *)malloc(2 * nnodes * sizeof(int));
+    lb->vallist = (double *)malloc(2 * nnodes * sizeof(double));
+    if (lb->cols == NULL || lb->next == NULL || lb->rowlist == NULL || lb->collist == NULL || lb->vallist == NULL)
+    {
+        log_error("error in allocating the local branching row");
+        lb_row_free(lb);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    return T_OK;
+}
+
+void lb_row_free(lb_row *lb)
+{
+    utils_safe_free(lb->cols);
+    utils_safe_free(lb->next);
+    utils_safe_free(lb->rowlist);
+    utils_safe_free(lb->collist);
+    utils_safe_free(lb->vallist);
+}
+
+ERROR_CODE lb_set_constraint(CPXENVptr env, CPXLPptr lp, lb_row *lb, tsp_solution *solution, int k)
+{
+    int n = tsp_inst.nnodes;
+    double rhs = n - k;
+
+    for (int i = 0; i < n; i++)
+    {
+        lb->next[i] = cx_xpos(i, solution->path[i], n);
+        if (lb->next[i] < 0 || lb->next[i] >= tsp_inst.ncols)
+        {
+            log_error("INTEGRITY CHECK: column %d of edge (%d,%d) out of range", lb->next[i], i, solution->path[i]);
+            return INVALID_ARGUMENT;
+        }
+    }
+    qsort(lb->next, n, sizeof(int), lb_compare);
+
+    if (lb->row < 0)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            lb->vallist[i] = 1.0;
+        }
+
+        char sense = 'G';
+        int izero = 0;
+        char *cname = "local branching";
+        if (CPXaddrows(env, lp, 0, 1, n, &rhs, &sense, &izero, lb->next, lb->vallist, NULL, &cname))
+        {
+            log_error("error in CPXaddrows for local branching constraints");
+            return INTERNAL;
+        }
+        lb->row = CPXgetnumrows(env, lp) - 1;
+    }
+    else
+    {
+        // merge of the two sorted edge sets, only the edges in one of them change coefficient
+        int nchg = 0;
+        int i = 0, j = 0;
+        while (i < n || j < n)
+        {
+            if (j == n || (i < n && lb->cols[i] < lb->next[j]))
+            {
+                lb->collist[nchg] = lb->cols[i++];
+                lb->vallist[nchg++] = 0.0;
+            }
+            else if (i == n || lb->next[j] < lb->cols[i])
+            {
+                lb->collist[nchg] = lb->next[j++];
+                lb->vallist[nchg++] = 1.0;
+            }
+            else
+            {
+                i++;
+                j++;
+            }
+        }
+        for (int c = 0; c < nchg; c++)
+        {
+            lb->rowlist[c] = lb->row;
+        }
+
+        if (nchg > 0 && CPXchgcoeflist(env, lp, nchg, lb->rowlist, lb->collist, lb->vallist))
+        {
+            log_error("error in CPXchgcoeflist for local branching constraint");
+            return INTERNAL;
+        }
+        if (CPXchgrhs(env, lp, 1, &lb->row, &rhs))
+        {
+            log_error("error in CPXchgrhs for local branching constraint");
+            return INTERNAL;
+        }
+        log_debug("local branching row updated, %d coefficients changed", nchg);
+    }
+
+    memcpy(lb->cols, lb->next, n * sizeof(int));
+
+    return T_OK;
+}
+
 ERROR_CODE lb_kstar(CPXENVptr env, CPXLPptr lp, int *Kstar)
 {
     ERROR_CODE e = T_OK;
@@ -665,3 +1427,316 @@ mh_free:
 
     return e;
 }
+
+//================================================================================
+// POPMUSIC UTILS
+//================================================================================
+
+ERROR_CODE pm_build_model(CPXENVptr env, CPXLPptr lp, const int *path, int r)
+{
+    ERROR_CODE e = T_OK;
+
+    int ncols = r * (r - 1) / 2;
+    double *obj = (double *)malloc(ncols * sizeof(double));
+    double *lb = (double *)calloc(ncols, sizeof(double));
+    double *ub = (double *)malloc(ncols * sizeof(double));
+    char *xctype = (char *)malloc(ncols * sizeof(char));
+    int *index = (int *)malloc(r * sizeof(int));
+    double *value = (double *)malloc(r * sizeof(double));
+    if (obj == NULL || lb == NULL || ub == NULL || xctype == NULL || index == NULL || value == NULL)
+    {
+        log_error("error in allocating memory for the subpath model");
+        e = RESOURCE_EXHAUSTED;
+        goto pm_free;
+    }
+
+    // binary var.s x(i,j) for i < j, positions of the subpath
+    for (int i = 0; i < r; i++)
+    {
+        for (int j = i + 1; j < r; j++)
+        {
+            int pos = cx_xpos(i, j, r);
+            obj[pos] = tsp_get_cost(path[i], path[j]);
+            ub[pos] = 1.0;
+            xctype[pos] = 'B';
+        }
+    }
+
+    // the endpoints close the path into a tour
+    int closing = cx_xpos(0, r - 1, r);
+    obj[closing] = 0.0;
+    lb[closing] = 1.0;
+
+    if (CPXnewcols(env, lp, ncols, obj, lb, ub, xctype, NULL))
+    {
+        log_error(" wrong CPXnewcols on x var.s");
+        e = INTERNAL;
+        goto pm_free;
+    }
+
+    // degree constraints
+    const double rhs = 2.0;
+    const char sense = 'E';
+    for (int h = 0; h < r; h++)
+    {
+        int nnz = 0;
+        for (int i = 0; i < r; i++)
+        {
+            if (i == h)
+                continue;
+            index[nnz] = cx_xpos(i, h, r);
+            value[nnz] = 1.0;
+            nnz++;
+        }
+        int izero = 0;
+        if (CPXaddrows(env, lp, 0, 1, nnz, &rhs, &sense, &izero, index, value, NULL, NULL))
+        {
+            log_error("CPXaddrows(): error on degree constraint");
+            e = INTERNAL;
+            goto pm_free;
+        }
+    }
+
+pm_free:
+    utils_safe_free(obj);
+    utils_safe_free(lb);
+    utils_safe_free(ub);
+    utils_safe_free(xctype);
+    utils_safe_free(index);
+    utils_safe_free(value);
+
+    return e;
+}
+
+ERROR_CODE pm_solve_subpath(CPXENVptr env, int *path, int r, double *gain)
+{
+    ERROR_CODE e = T_OK;
+    *gain = 0.0;
+
+    int error;
+    CPXLPptr lp = CPXcreateprob(env, &error, "POPMUSIC subpath");
+    if (error)
+    {
+        log_error("CPX code %d : CPXcreateprob() error", error);
+        return INTERNAL;
+    }
+
+    int ncols = r * (r - 1) / 2;
+    double *xstar = (double *)malloc(ncols * sizeof(double));
+    int *comp = (int *)malloc(r * sizeof(int));
+    int *stack = (int *)malloc(r * sizeof(int));
+    int *index = (int *)malloc(ncols * sizeof(int));
+    double *value = (double *)malloc(ncols * sizeof(double));
+    int *buffer = (int *)malloc(r * sizeof(int));
+    if (xstar == NULL || comp == NULL || stack == NULL || index == NULL || value == NULL || buffer == NULL)
+    {
+        log_error("error in allocating memory for the subpath");
+        e = RESOURCE_EXHAUSTED;
+        goto pm_free;
+    }
+
+    e = pm_build_model(env, lp, path, r);
+    if (!err_ok(e))
+    {
+        goto pm_free;
+    }
+
+    // Benders loop, the subpaths are small enough that a few rounds of SECs are enough
+    while (1)
+    {
+        if (dl_expired())
+        {
+            e = DEADLINE_EXCEEDED;
+            goto pm_free;
+        }
+        if (tsp_env.timelimit != -1.0)
+        {
+            CPXsetdblparam(env, CPX_PARAM_TILIM, dl_remaining());
+        }
+
+        struct timespec start = st_now();
+        int cpxerror = CPXmipopt(env, lp);
+        st_time(ST_TIME_MIP, &start);
+        if (cpxerror)
+        {
+            log_error("CPXmipopt() error on subpath");
+            e = INTERNAL;
+            goto pm_free;
+        }
+
+        // only an optimal solution is spliced back, otherwise the subpath is left as it is
+        int status = CPXgetstat(env, lp);
+        if (status != CPXMIP_OPTIMAL && status != CPXMIP_OPTIMAL_TOL)
+        {
+            e = cx_handle_cplex_status(env, lp);
+            if (e != DEADLINE_EXCEEDED && e != CANCELLED)
+            {
+                log_debug("subpath not solved to optimality, cplex status %d", status);
+                e = T_OK;
+            }
+            goto pm_free;
+        }
+
+        if (CPXgetx(env, lp, xstar, 0, ncols - 1))
+        {
+            log_error("CPXgetx() error on subpath");
+            e = INTERNAL;
+            goto pm_free;
+        }
+
+        // connected components of the solution
+        int ncomp = 0;
+        for (int i = 0; i < r; i++)
+        {
+            comp[i] = -1;
+        }
+        for (int start = 0; start < r; start++)
+        {
+            if (comp[start] >= 0)
+                continue;
+
+            ncomp++;
+            int top = 0;
+            stack[top++] = start;
+            comp[start] = ncomp;
+            while (top > 0)
+            {
+                int i = stack[--top];
+                for (int j = 0; j < r; j++)
+                {
+                    if (j != i && comp[j] < 0 && xstar[cx_xpos(i, j, r)] > 0.5)
+                    {
+                        comp[j] = ncomp;
+                        stack[top++] = j;
+                    }
+                }
+            }
+        }
+
+        if (ncomp == 1)
+        {
+            break;
+        }
+
+        // one SEC for each component
+        const char sense = 'L';
+        for (int k = 1; k <= ncomp; k++)
+        {
+            int nnz = 0;
+            int size = 0;
+            for (int i = 0; i < r; i++)
+            {
+                if (comp[i] != k)
+                    continue;
+                size++;
+                for (int j = i + 1; j < r; j++)
+                {
+                    if (comp[j] != k)
+                        continue;
+                    index[nnz] = cx_xpos(i, j, r);
+                    value[nnz] = 1.0;
+                    nnz++;
+                }
+            }
+
+            double rhs = size - 1.0;
+            int izero = 0;
+            if (CPXaddrows(env, lp, 0, 1, nnz, &rhs, &sense, &izero, index, value, NULL, NULL))
+            {
+                log_error("CPXaddrows(): error on subpath SEC");
+                e = INTERNAL;
+                goto pm_free;
+            }
+        }
+    }
+
+    // walk the tour from the first endpoint, leaving through the edge that does not close the path
+    buffer[0] = path[0];
+    int prev = r - 1;
+    int cur = 0;
+    double cost = 0.0;
+    for (int pos = 1; pos < r; pos++)
+    {
+        int next = -1;
+        for (int j = 0; j < r; j++)
+        {
+            if (j != cur && j != prev && xstar[cx_xpos(cur, j, r)] > 0.5)
+            {
+                next = j;
+                break;
+            }
+        }
+        if (next < 0)
+        {
+            log_error("subpath solution is not a path");
+            e = INTERNAL;
+            goto pm_free;
+        }
+        buffer[pos] = path[next];
+        cost += tsp_get_cost(path[cur], path[next]);
+        prev = cur;
+        cur = next;
+    }
+    if (cur != r - 1)
+    {
+        log_error("subpath solution does not end in the last endpoint");
+        e = INTERNAL;
+        goto pm_free;
+    }
+
+    double old = 0.0;
+    for (int i = 0; i < r - 1; i++)
+    {
+        old += tsp_get_cost(path[i], path[i + 1]);
+    }
+
+    if (cost < old - PM_EPS)
+    {
+        memcpy(path, buffer, r * sizeof(int));
+        *gain = old - cost;
+    }
+
+pm_free:
+    utils_safe_free(xstar);
+    utils_safe_free(comp);
+    utils_safe_free(stack);
+    utils_safe_free(index);
+    utils_safe_free(value);
+    utils_safe_free(buffer);
+
+    CPXfreeprob(env, &lp);
+
+    return e;
+}
+
+void *pm_thread(void *arg)
+{
+    pm_worker *w = (pm_worker *)arg;
+    w->gain = 0.0;
+    w->error = T_OK;
+
+    for (int s = w->id; s < w->nsubpaths; s += w->nthreads)
+    {
+        int start = s * (w->r - 1);
+        int len = w->last - start + 1;
+        if (len > w->r)
+        {
+            len = w->r;
+        }
+        if (len < 4)
+        {
+            // at most one interior node, nothing to reorder
+            continue;
+        }
+
+        double gain;
+        w->error = pm_solve_subpath(w->env, w->seq + start, len, &gain);
+        w->gain += gain;
+        if (w->error != T_OK)
+        {
+            break;
+        }
+    }
+
+    return NULL;
+}
@@ -1,10 +1,86 @@
 #include <cplex.h> 
+#include <pthread.h>
 #include "cplex_model.h" 
 #include "../tsp.h"
+#include "onetree.h"
 
 #define STAGNATION_THRESHOLD 5
 #define SMALL_IMPROV 3
 
+#define HF_PROB_SPREAD 0.15         // the parallel Hard Fixing workers fix edges with probabilities in hf_prob +- this
+#define HF_PROB_MIN 0.05
+#define HF_PROB_MAX 0.95
+
+#define PS_EPS 1.0E-6
+
+#define PM_STALL_SWEEPS 2           // stop after this number of sweeps without improvement
+#define PM_EPS 1.0E-6
+
+/**
+ * @brief Columns whose lower bound was raised by hf_fixing, so that hf_undofixing resets only those
+ *
+ */
+typedef struct {
+    int* index;                     // fixed columns
+    char* lu;                       // bound type of each column, always 'L'
+    double* bd;                     // new bound of each column
+    double* key;                    // distances from the center of the window policy
+    int count;
+} hf_journal;
+
+/**
+ * @brief Data shared by the parallel Hard Fixing workers
+ *
+ */
+typedef struct {
+    pthread_mutex_t lock;           // protects tsp_inst.best_solution and the fields below
+    int iterations;                 // iterations done by all the workers
+    ERROR_CODE error;               // first error met by a worker
+} hf_shared;
+
+/**
+ * @brief Parallel Hard Fixing worker, with its own CPLEX model
+ *
+ */
+typedef struct {
+    CPXENVptr env;
+    CPXLPptr lp;
+    double prob;                    // probability of fixing an edge of the incumbent
+    rng_state rng;                  // stream of the worker, split from tsp_inst.rng
+    hf_journal journal;
+    int id;
+    hf_shared* shared;
+} hf_worker;
+
+/**
+ * @brief Local branching row, sum of the edges of the reference solution >= n - k, kept in the model between iterations
+ *
+ */
+typedef struct {
+    int row;                        // index of the row in the model, -1 if not added yet
+    int* cols;                      // columns of the reference solution, sorted
+    int* next;                      // columns of the new reference solution, sorted
+    int* rowlist;                   // buffers for CPXchgcoeflist, at most 2n changes
+    int* collist;
+    double* vallist;
+} lb_row;
+
+/**
+ * @brief Subpaths assigned to a thread
+ *
+ */
+typedef struct {
+    CPXENVptr env;                  // environment of the thread
+    int* seq;                       // tour as a sequence of n+1 nodes, the first one repeated at the end
+    int nsubpaths;
+    int r;                          // subpath s covers positions s*(r-1) .. (s+1)*(r-1)
+    int last;                       // last position of the sequence
+    int id;                         // thread id
+    int nthreads;
+    double gain;                    // improvement found by the thread
+    ERROR_CODE error;
+} pm_worker;
+
 /**
  * @brief Solves the TSP using Hard Fixing
  * 
@@ -12,6 +88,14 @@
  */
 ERROR_CODE mh_HardFixing(void);
 
+/**
+ * @brief Solves the TSP using tsp_env.hf_workers Hard Fixing workers in parallel, each with its own CPLEX environment,
+ *        random fixings and fixing probability. Workers restart from the shared incumbent at each iteration
+ *
+ * @return ERROR_CODE
+ */
+ERROR_CODE mh_HardFixingParallel(void);
+
 /**
  * @brief Solves the TSP using Local Branching
  * 
@@ -19,18 +103,37 @@ ERROR_CODE mh_HardFixing(void);
  */
 ERROR_CODE mh_LocalBranching(void);
 
+/**
+ * @brief Solves the TSP using Proximity Search: the objective becomes the Hamming distance from the incumbent, a cutoff
+ *        row asks for a cost at most the incumbent one minus tsp_env.ps_theta, and the first solution found becomes
+ *        the new incumbent, around which the model is recentred
+ *
+ * @return ERROR_CODE
+ */
+ERROR_CODE mh_ProximitySearch(void);
+
+/**
+ * @brief Solves the TSP with the POPMUSIC decomposition: the incumbent is cut into subpaths of tsp_env.pm_r nodes with
+ *        fixed endpoints, each one is solved to optimality by CPLEX and spliced back. Subpaths do not overlap, so they
+ *        are solved in parallel, each thread with its own CPLEX environment
+ *
+ * @return ERROR_CODE
+ */
+ERROR_CODE mh_Popmusic(void);
+
 //================================================================================
 // GENERAL UTILS
 //================================================================================
 
 /**
- * @brief Util for running mip solver with branch&cut with candidate and relaxation callback. Currently not stable
+ * @brief Util for running mip solver with branch&cut with candidate and relaxation callback, the solution found is a
+ *        tour. If CPLEX finds no solution in the time given the solution is left unchanged
  * 
  * @param env CPXENVptr
  * @param lp CPXLPptr
  * @param solution Pointer to solution struct to hold the result found
- * * @param time_available Time assigned to the mip solver
- * @return ERROR_CODE 
+ * @param time_available Time assigned to the mip solver, the time limit of the model is kept if not positive
+ * @return ERROR_CODE CANCELLED if no solution was found
  */
 ERROR_CODE mh_mipsolver(CPXENVptr env, CPXLPptr lp,  tsp_solution* solution, double time_available);
 
@@ -50,47 +153,96 @@ ERROR_CODE mh_mipsolver2(CPXENVptr env, CPXLPptr lp,  tsp_solution* solution, do
 //================================================================================
 
 /**
- * @brief Util for fixing variables for the Hard Fixing algorithm
+ * @brief Util for fixing variables for the Hard Fixing algorithm, with the policy in tsp_env.hf_policy. RANDOM fixes
+ *        each edge of the solution with probability prob, WINDOW leaves free the edges leaving the fraction 1-prob of
+ *        nodes closest to a random node and fixes the others. The bounds are changed in a single call
  * 
  * @param env CPXENVptr
  * @param lp CPXLPptr
  * @param solution Pointer to solution struct to know what variables to fix
+ * @param prob Fraction of the edges of the solution to fix
+ * @param rng Generator of the calling thread
+ * @param journal Journal to record the fixed columns in
  * @return ERROR_CODE 
  */
-ERROR_CODE hf_fixing(CPXENVptr env, CPXLPptr lp, tsp_solution* solution);
+ERROR_CODE hf_fixing(CPXENVptr env, CPXLPptr lp, tsp_solution* solution, double prob, rng_state* rng, hf_journal* journal);
 
 /**
- * @brief Util for unfixing all previously fixed variables
+ * @brief Util for unfixing the variables recorded in the journal, in a single call
  * 
  * @param env CPXENVptr
  * @param lp CPXLPptr
+ * @param journal Journal of the fixed columns, emptied
  * @return ERROR_CODE 
  */
-ERROR_CODE hf_undofixing(CPXENVptr env, CPXLPptr lp);
+ERROR_CODE hf_undofixing(CPXENVptr env, CPXLPptr lp, hf_journal* journal);
+
+/**
+ * @brief Allocates a journal for at most nnodes fixed columns
+ *
+ * @param journal Journal
+ * @param nnodes Number of nodes
+ * @return ERROR_CODE
+ */
+ERROR_CODE hf_journal_init(hf_journal* journal, int nnodes);
+
+/**
+ * @brief Frees a journal
+ *
+ * @param journal Journal
+ */
+void hf_journal_free(hf_journal* journal);
+
+/**
+ * @brief Opens the CPLEX environment and model of a parallel Hard Fixing worker
+ *
+ * @param w Worker
+ * @param first If true the model is initialized by cx_initialize, which also computes the warm start and the cut pool
+ * @param cpxthreads Number of threads of CPLEX
+ * @return ERROR_CODE
+ */
+ERROR_CODE hf_worker_init(hf_worker* w, bool first, int cpxthreads);
+
+/**
+ * @brief Main function of a parallel Hard Fixing worker, runs until the time limit or the gap is reached
+ *
+ * @param arg hf_worker pointer
+ * @return void* NULL
+ */
+void* hf_thread(void* arg);
 
 //================================================================================
 // LOCAL BRANCHING UTILS
 //================================================================================
 
 /**
- * @brief Util to add the local branching constraint
+ * @brief Allocates the local branching row, it is added to the model by the first lb_set_constraint
  * 
- * @param env CPXENVptr
- * @param lp CPXLPptr
- * @param solution Pointer to solution struct to know how to write the constraint
- * @param k Degree of freedom 
+ * @param lb Local branching row
+ * @param nnodes Number of nodes
  * @return ERROR_CODE 
  */
-ERROR_CODE lb_add_constraint(CPXENVptr env, CPXLPptr lp,  tsp_solution* solution, int k);
+ERROR_CODE lb_row_init(lb_row* lb, int nnodes);
+
+/**
+ * @brief Frees the local branching row, the row stays in the model
+ * 
+ * @param lb Local branching row
+ */
+void lb_row_free(lb_row* lb);
 
 /**
- * @brief Util to remove the last constraint added which corresponds to the local branching constraint
+ * @brief Util to set the local branching constraint around a solution. The row is added once, then only the
+ *        coefficients that differ from the previous solution and the right hand side are changed in place
  * 
  * @param env CPXENVptr
  * @param lp CPXLPptr
+ * @param lb Local branching row
+ * @param solution Pointer to solution struct to know how to write the constraint
+ * @param k Degree of freedom 
  * @return ERROR_CODE 
  */
-ERROR_CODE lb_remove_constraint(CPXENVptr env, CPXLPptr lp);
+ERROR_CODE lb_set_constraint(CPXENVptr env, CPXLPptr lp, lb_row* lb, tsp_solution* solution, int k);
 
 /**
  * @brief Computes Kstar, the minimum value of K needed to avoid generating cuts.
@@ -101,3 +253,38 @@ ERROR_CODE lb_remove_constraint(CPXENVptr env, CPXLPptr lp);
  * @return ERROR_CODE 
  */
 ERROR_CODE lb_kstar(CPXENVptr env, CPXLPptr lp, int* Kstar);
+
+//================================================================================
+// POPMUSIC UTILS
+//================================================================================
+
+/**
+ * @brief Builds the model of the path-TSP over the nodes of a subpath: the edge between the two endpoints is fixed to
+ *        1 with cost 0, so an optimal tour is an optimal path between them
+ *
+ * @param env CPXENVptr
+ * @param lp CPXLPptr
+ * @param path Nodes of the subpath
+ * @param r Number of nodes
+ * @return ERROR_CODE
+ */
+ERROR_CODE pm_build_model(CPXENVptr env, CPXLPptr lp, const int* path, int r);
+
+/**
+ * @brief Solves the path-TSP of a subpath with a Benders loop and rewrites the subpath in place if it improves
+ *
+ * @param env CPXENVptr of the calling thread
+ * @param path Nodes of the subpath, the first and the last one stay in place
+ * @param r Number of nodes
+ * @param gain Pointer to hold the improvement of the subpath cost, 0 if it is already optimal
+ * @return ERROR_CODE
+ */
+ERROR_CODE pm_solve_subpath(CPXENVptr env, int* path, int r, double* gain);
+
+/**
+ * @brief Main function of a thread, re-optimizes its subpaths
+ *
+ * @param arg pm_worker pointer
+ * @return void* NULL
+ */
+void* pm_thread(void* arg);
@@ -32,7 +32,7 @@ ERROR_CODE tabu_random_policy(tabu_search* t){
         return ALREADY_EXISTS;
     }
 
-    t->tenure = (int)(rand() / RAND_MAX) * (t->max_tenure - t->min_tenure) + t->min_tenure;
+    t->tenure = rng_int(&tsp_inst.rng, t->max_tenure - t->min_tenure + 1) + t->min_tenure;
 
     return T_OK;
 }
@@ -112,14 +112,14 @@ ERROR_CODE mh_TabuSearch(){
     log_debug("2opt greedy sol cost: %f", solution.cost);
 
     // tabu search with 2opt moves
+    struct timespec start = st_now();
     for(int k=0; k < tsp_env.k; k++){
+        st_add(ST_TABU_ITERATIONS, 1);
 
         // check if exceeds time
-        double ex_time = utils_timeelapsed(&tsp_inst.c);
-        if(tsp_env.timelimit != -1.0){
-            if(ex_time > tsp_env.timelimit){
-                e = DEADLINE_EXCEEDED;
-            }
+        if(dl_expired()){
+            e = DEADLINE_EXCEEDED;
+            break;
         }
 
         // update tenure
@@ -163,7 +163,13 @@ ERROR_CODE mh_TabuSearch(){
 
         // save current iteration and current solution cost to file for the plot
         fprintf(f, "%d,%f\n", k, solution.cost);
+
+        if(ot_gap_reached(tsp_inst.best_solution.cost)){
+            log_info("gap from the Held-Karp bound reached, stopping tabu search");
+            break;
+        }
     }
+    st_time(ST_TIME_REFINEMENT, &start);
 
     fclose(f);
 
@@ -278,12 +284,9 @@ ERROR_CODE mh_VNS(){
     // call 3 opt k times
     for(int i=0; i<tsp_env.k; i++){
         // check if exceeds time
-        double ex_time = utils_timeelapsed(&tsp_inst.c);
-        if(tsp_env.timelimit != -1.0){
-            if(ex_time > tsp_env.timelimit){
-               e = DEADLINE_EXCEEDED;
-               break;
-            }
+        if(dl_expired()){
+            e = DEADLINE_EXCEEDED;
+            break;
         }
 
         // local search
@@ -304,8 +307,13 @@ ERROR_CODE mh_VNS(){
         // save current iteration and current solution cost to file for the plot
         fprintf(f, "%d,%f\n", i, solution.cost);
 
+        if(ot_gap_reached(best_vns.cost)){
+            log_info("gap from the Held-Karp bound reached, stopping VNS");
+            break;
+        }
+
         // kick
-        int r = rand() % (UPPER - LOWER + 1) - LOWER;
+        int r = rng_int(&tsp_inst.rng, UPPER - LOWER + 1) + LOWER;
         for(int j=0; j<r; j++){
             e = vns_kick( &solution);
             if(!err_ok(e)){
@@ -342,6 +350,7 @@ ERROR_CODE mh_VNS(){
 
 // 3 opt kick
 ERROR_CODE vns_kick( tsp_solution* solution){
+    st_add(ST_KICKS, 1);
 
     log_debug("KICK");
 
@@ -365,7 +374,7 @@ ERROR_CODE vns_kick( tsp_solution* solution){
     for (i = 0; i < 3; i++) {
         int random_number;
         do {
-            random_number = rand() % (tsp_inst.nnodes);
+            random_number = rng_int(&tsp_inst.rng, tsp_inst.nnodes);
             // Check if the number is already generated
             for (j = 0; j < i; j++) {
                 // no same number or predecessor/successor
@@ -2,6 +2,7 @@
 #define MHEUR_H_
 
 #include "heuristics.h"
+#include "onetree.h"
 
 // maximum and minimum number of kicks in VNS
 #define UPPER 10
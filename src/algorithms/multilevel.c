@@ -0,0 +1,223 @@
+#include "multilevel.h"
+
+ERROR_CODE ml_Solve(void){
+    ERROR_CODE e = T_OK;
+    int n = tsp_inst.nnodes;
+
+    log_info("running multilevel refinement");
+
+    if(n < 8){
+        log_error("multilevel refinement needs at least 8 nodes");
+        return FAILED_PRECONDITION;
+    }
+
+    ml_level levels[ML_MAX_LEVELS] = {0};
+    levels[0] = (ml_level){.n = n, .points = tsp_inst.points, .child = NULL};
+    int nlevels = 1;
+
+    cl_tour t = {0};
+    int* seq = (int*) malloc(n * sizeof(int));
+    int* out = (int*) malloc(n * sizeof(int));
+    tsp_solution solution;
+    tsp_init_solution(n, &solution);
+    if(seq == NULL || out == NULL || solution.path == NULL){
+        log_error("error in allocating memory for the multilevel refinement");
+        e = RESOURCE_EXHAUSTED;
+        goto ml_free;
+    }
+
+    while(nlevels < ML_MAX_LEVELS && levels[nlevels-1].n > tsp_env.ml_coarsest){
+        e = ml_coarsen(&levels[nlevels-1], &levels[nlevels]);
+        if(!err_ok(e)){
+            goto ml_free;
+        }
+        nlevels++;
+        log_debug("level %d: %d nodes", nlevels - 1, levels[nlevels-1].n);
+
+        // few nodes found a free neighbour, another level would not be much smaller
+        if(levels[nlevels-1].n > ML_MIN_REDUCTION * levels[nlevels-2].n){
+            break;
+        }
+    }
+    int top = nlevels - 1;
+    log_info("%d levels, the coarsest has %d nodes", nlevels, levels[top].n);
+
+    e = cl_tour_init(&t, levels[top].points, levels[top].n);
+    if(!err_ok(e)){
+        goto ml_free;
+    }
+    e = cl_nearest_neighbour(&t, 0);
+    if(err_ok(e)){
+        e = cl_local_search(&t, NULL, 0);
+    }
+    if(!err_ok(e)){
+        goto ml_free;
+    }
+    memcpy(seq, t.tour, levels[top].n * sizeof(int));
+    cl_tour_free(&t);
+
+    // once the time is over the remaining levels are only projected, to get a tour of the whole instance
+    bool refine = (e != DEADLINE_EXCEEDED);
+    for(int l=top; l>0; l--){
+        ml_level* fine = &levels[l-1];
+        ml_project(fine, &levels[l], seq, out);
+
+        if(refine){
+            e = cl_tour_init(&t, fine->points, fine->n);
+            if(!err_ok(e)){
+                goto ml_free;
+            }
+            for(int i=0; i<fine->n; i++){
+                t.tour[i] = out[i];
+                t.pos[out[i]] = i;
+            }
+
+            e = cl_local_search(&t, NULL, 0);
+            if(!err_ok(e)){
+                goto ml_free;
+            }
+            memcpy(out, t.tour, fine->n * sizeof(int));
+            cl_tour_free(&t);
+
+            if(e == DEADLINE_EXCEEDED){
+                log_warn("time limit reached at level %d, the finer levels are only projected", l - 1);
+                refine = false;
+            }
+        }
+
+        int* tmp = seq;
+        seq = out;
+        out = tmp;
+    }
+
+    for(int i=0; i<n; i++){
+        solution.path[seq[i]] = seq[(i + 1) % n];
+    }
+    solution.cost = tsp_solution_cost(solution.path);
+    log_info("multilevel refinement: cost %.2f", solution.cost);
+
+    ERROR_CODE error = tsp_update_best_solution(&solution);
+    if(!err_ok(error)){
+        log_error("code %d : error in updating the best solution of the multilevel refinement", error);
+        e = error;
+    }
+
+ml_free:
+    cl_tour_free(&t);
+    for(int l=1; l<nlevels; l++){
+        ml_level_free(&levels[l]);
+    }
+    utils_safe_free(seq);
+    utils_safe_free(out);
+    utils_safe_free(solution.path);
+    utils_safe_free(solution.comp);
+
+    return e;
+}
+
+//================================================================================
+// MULTILEVEL UTILS
+//================================================================================
+
+ERROR_CODE ml_coarsen(const ml_level* fine, ml_level* coarse){
+    int n = fine->n;
+
+    coarse->n = 0;
+    coarse->points = (point*) malloc(n * sizeof(point));
+    coarse->child = (int*) malloc(2 * n * sizeof(int));
+    int* cand = (int*) malloc((size_t)n * CL_NCAND * sizeof(int));
+    int* order = (int*) malloc(n * sizeof(int));
+    int* match = (int*) malloc(n * sizeof(int));
+    if(coarse->points == NULL || coarse->child == NULL || cand == NULL || order == NULL || match == NULL){
+        log_error("error in allocating a level of the multilevel refinement");
+        ml_level_free(coarse);
+        utils_safe_free(cand);
+        utils_safe_free(order);
+        utils_safe_free(match);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    ERROR_CODE e = cl_knn(fine->points, n, CL_NCAND, cand);
+    if(!err_ok(e)){
+        ml_level_free(coarse);
+        goto ml_coarsen_free;
+    }
+
+    for(int i=0; i<n; i++){
+        order[i] = i;
+        match[i] = -1;
+    }
+    for(int i=n-1; i>0; i--){
+        int j = rng_int(&tsp_inst.rng, i + 1);
+        int tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    int m = 0;
+    for(int i=0; i<n; i++){
+        int v = order[i];
+        if(match[v] >= 0){
+            continue;
+        }
+
+        // neighbour lists are sorted, the first free one is the nearest
+        int u = -1;
+        for(int h=0; h<CL_NCAND; h++){
+            int c = cand[v * CL_NCAND + h];
+            if(c < 0){
+                break;
+            }
+            if(match[c] < 0){
+                u = c;
+                break;
+            }
+        }
+
+        match[v] = m;
+        coarse->child[2 * m] = v;
+        coarse->child[2 * m + 1] = u;
+        coarse->points[m] = fine->points[v];
+        if(u >= 0){
+            match[u] = m;
+            coarse->points[m].x = (fine->points[v].x + fine->points[u].x) / 2.0;
+            coarse->points[m].y = (fine->points[v].y + fine->points[u].y) / 2.0;
+        }
+        m++;
+    }
+    coarse->n = m;
+
+ml_coarsen_free:
+    utils_safe_free(cand);
+    utils_safe_free(order);
+    utils_safe_free(match);
+
+    return e;
+}
+
+void ml_project(const ml_level* fine, const ml_level* coarse, const int* seq, int* out){
+    int m = coarse->n;
+    int p = 0;
+
+    for(int i=0; i<m; i++){
+        int a = coarse->child[2 * seq[i]];
+        int b = coarse->child[2 * seq[i] + 1];
+        if(b < 0){
+            out[p++] = a;
+            continue;
+        }
+
+        // the previous node is already placed, the next pair is only known by its midpoint
+        const point* prev = (p > 0) ? &fine->points[out[p-1]] : &coarse->points[seq[m-1]];
+        const point* next = &coarse->points[seq[(i + 1) % m]];
+        double ab = tsp_distance(prev, &fine->points[a]) + tsp_distance(&fine->points[b], next);
+        double ba = tsp_distance(prev, &fine->points[b]) + tsp_distance(&fine->points[a], next);
+        out[p++] = (ab <= ba) ? a : b;
+        out[p++] = (ab <= ba) ? b : a;
+    }
+}
+
+void ml_level_free(ml_level* l){
+    utils_safe_free(l->points);
+    utils_safe_free(l->child);
+}
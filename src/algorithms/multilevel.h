@@ -0,0 +1,70 @@
+#ifndef MULTILEVEL_H_
+#define MULTILEVEL_H_
+
+/**
+ * @file multilevel.h
+ * @brief Multilevel refinement in the style of Walshaw. Each node is matched with its nearest unmatched neighbour and
+ *        the pair becomes a fixed edge, represented at the coarser level by a single node in its midpoint. Coarsening
+ *        goes on until few nodes are left, the coarsest tour is built by nearest neighbour and local search, then it is
+ *        projected back level by level, expanding each pair in its best orientation and refining with 2-opt and Or-opt
+ *        on neighbour lists. Each level takes O(n) memory, the cost matrix is never stored
+ * @version 0.1
+ * @date 2024-06-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "cluster.h"
+
+#define ML_MAX_LEVELS 64
+#define ML_MIN_REDUCTION 0.9        // coarsening stops when a level keeps more than this fraction of the nodes
+
+/**
+ * @brief Level of the hierarchy
+ *
+ */
+typedef struct {
+    int n;
+    point* points;                  // coordinates, the midpoint of the matched pair for coarse levels
+    int* child;                     // the 2 nodes of the finer level merged in each node, the second is -1 if unmatched
+} ml_level;
+
+/**
+ * @brief Solves the TSP with the multilevel scheme
+ *
+ * @return ERROR_CODE
+ */
+ERROR_CODE ml_Solve(void);
+
+//================================================================================
+// MULTILEVEL UTILS
+//================================================================================
+
+/**
+ * @brief Builds the next coarser level matching each node with its nearest unmatched neighbour, visited in random order
+ *
+ * @param fine Finer level
+ * @param coarse Coarser level to fill
+ * @return ERROR_CODE
+ */
+ERROR_CODE ml_coarsen(const ml_level* fine, ml_level* coarse);
+
+/**
+ * @brief Projects a tour of the coarse level to the finer one, the two nodes of each pair are placed in the order that
+ *        best connects them to the previous node and to the next pair
+ *
+ * @param fine Finer level
+ * @param coarse Coarser level
+ * @param seq Tour of the coarse level as a sequence of nodes
+ * @param out Array of fine->n nodes to hold the tour of the finer level
+ */
+void ml_project(const ml_level* fine, const ml_level* coarse, const int* seq, int* out);
+
+/**
+ * @brief Frees a coarse level
+ *
+ * @param l Level
+ */
+void ml_level_free(ml_level* l);
+
+#endif
@@ -0,0 +1,351 @@
+#include "onetree.h"
+
+ERROR_CODE ot_init(ot_tree* tree, int nnodes){
+    tree->nnodes = nnodes;
+    tree->first = -1;
+    tree->second = -1;
+    tree->value = 0.0;
+
+    tree->parent = (int*) malloc(nnodes * sizeof(int));
+    tree->order = (int*) malloc(nnodes * sizeof(int));
+    tree->degree = (int*) calloc(nnodes, sizeof(int));
+    if(tree->parent == NULL || tree->order == NULL || tree->degree == NULL){
+        log_error("error in allocating the 1-tree");
+        ot_free(tree);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    return T_OK;
+}
+
+void ot_free(ot_tree* tree){
+    utils_safe_free(tree->parent);
+    utils_safe_free(tree->order);
+    utils_safe_free(tree->degree);
+}
+
+ERROR_CODE ot_compute(ot_tree* tree, const double* pi){
+    return ot_compute_fixed(tree, pi, NULL);
+}
+
+ERROR_CODE ot_compute_fixed(ot_tree* tree, const double* pi, const signed char* fixed){
+    int n = tree->nnodes;
+    if(n < 3){
+        log_error("1-tree needs at least 3 nodes");
+        return INVALID_ARGUMENT;
+    }
+
+    // the graph is complete, so Prim with an array of keys is O(n^2), a heap would only add a log factor
+    double* key = (double*) malloc(n * sizeof(double));
+    bool* keyfixed = (bool*) calloc(n, sizeof(bool));
+    bool* intree = (bool*) calloc(n, sizeof(bool));
+    if(key == NULL || keyfixed == NULL || intree == NULL){
+        log_error("error in allocating memory for Prim");
+        utils_safe_free(key);
+        utils_safe_free(keyfixed);
+        utils_safe_free(intree);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    ERROR_CODE e = T_OK;
+
+    double sumpi = 0.0;
+    int nfixed = 0;
+    for(int i=0; i<n; i++){
+        key[i] = __DBL_MAX__;
+        tree->parent[i] = -1;
+        tree->degree[i] = 0;
+        sumpi += (pi != NULL) ? pi[i] : 0.0;
+        for(int j=i+1; j<n && fixed != NULL && i > 0; j++){
+            nfixed += (fixed[i * n + j] == OT_INCLUDED);
+        }
+    }
+
+    double value = 0.0;
+
+    // spanning tree on nodes 1..n-1, rooted at node 1. Included edges always win over free ones, so they are all
+    // in the tree unless they close a cycle
+    key[1] = 0.0;
+    for(int k=0; k<n-1; k++){
+        int v = -1;
+        for(int i=1; i<n; i++){
+            if(!intree[i] && (v < 0 || (keyfixed[i] && !keyfixed[v]) || (keyfixed[i] == keyfixed[v] && key[i] < key[v]))){
+                v = i;
+            }
+        }
+
+        if(key[v] == __DBL_MAX__){
+            // all the edges towards the remaining nodes are excluded
+            e = NOT_FOUND;
+            goto ot_free_prim;
+        }
+
+        intree[v] = true;
+        tree->order[k] = v;
+        value += key[v];
+        nfixed -= keyfixed[v];
+        if(tree->parent[v] >= 0){
+            tree->degree[v]++;
+            tree->degree[tree->parent[v]]++;
+        }
+
+        double pv = (pi != NULL) ? pi[v] : 0.0;
+        for(int i=1; i<n; i++){
+            if(intree[i]){
+                continue;
+            }
+            signed char state = (fixed != NULL) ? fixed[v * n + i] : OT_FREE;
+            if(state == OT_EXCLUDED){
+                continue;
+            }
+            bool isfixed = (state == OT_INCLUDED);
+            double c = tsp_inst.costs[v * n + i] + pv + ((pi != NULL) ? pi[i] : 0.0);
+            if((isfixed && !keyfixed[i]) || (isfixed == keyfixed[i] && c < key[i])){
+                key[i] = c;
+                keyfixed[i] = isfixed;
+                tree->parent[i] = v;
+            }
+        }
+    }
+
+    if(nfixed > 0){
+        // some included edges close a cycle
+        e = NOT_FOUND;
+        goto ot_free_prim;
+    }
+
+    // the two cheapest edges incident to node 0, included edges first
+    double best1 = __DBL_MAX__, best2 = __DBL_MAX__;
+    bool fixed1 = false, fixed2 = false;
+    tree->first = -1;
+    tree->second = -1;
+    double p0 = (pi != NULL) ? pi[0] : 0.0;
+    int nfixed0 = 0;
+    for(int i=1; i<n && fixed != NULL; i++){
+        nfixed0 += (fixed[i] == OT_INCLUDED);
+    }
+    if(nfixed0 > 2){
+        e = NOT_FOUND;
+        goto ot_free_prim;
+    }
+    for(int i=1; i<n; i++){
+        signed char state = (fixed != NULL) ? fixed[i] : OT_FREE;
+        if(state == OT_EXCLUDED){
+            continue;
+        }
+        bool isfixed = (state == OT_INCLUDED);
+        double c = tsp_inst.costs[i] + p0 + ((pi != NULL) ? pi[i] : 0.0);
+        if((isfixed && !fixed1) || (isfixed == fixed1 && c < best1)){
+            best2 = best1;
+            fixed2 = fixed1;
+            tree->second = tree->first;
+            best1 = c;
+            fixed1 = isfixed;
+            tree->first = i;
+        }else if((isfixed && !fixed2) || (isfixed == fixed2 && c < best2)){
+            best2 = c;
+            fixed2 = isfixed;
+            tree->second = i;
+        }
+    }
+    if(tree->second < 0){
+        e = NOT_FOUND;
+        goto ot_free_prim;
+    }
+    value += best1 + best2;
+    tree->degree[0] = 2;
+    tree->degree[tree->first]++;
+    tree->degree[tree->second]++;
+
+    tree->value = value - 2.0 * sumpi;
+
+ot_free_prim:
+    utils_safe_free(key);
+    utils_safe_free(keyfixed);
+    utils_safe_free(intree);
+
+    return e;
+}
+
+#define OT_PCOST(i, j) (tsp_get_cost((i), (j)) + ((pi != NULL) ? pi[(i)] + pi[(j)] : 0.0))
+
+void ot_alpha_row(const ot_tree* tree, const double* pi, int a, double* alpha, int* mark){
+    int n = tree->nnodes;
+
+    // an edge from node 0 replaces the most expensive of its two 1-tree edges
+    double maxzero = OT_PCOST(0, tree->second);
+
+    if(a == 0){
+        for(int b=1; b<n; b++){
+            alpha[b] = OT_PCOST(0, b) - maxzero;
+        }
+        return;
+    }
+
+    // alpha is first filled with beta[b], the cost of the most expensive edge in the tree path from a to b:
+    // first along the path from a to the root...
+    alpha[a] = -__DBL_MAX__;
+    mark[a] = a;
+    for(int b=a; tree->parent[b] >= 0; b=tree->parent[b]){
+        int p = tree->parent[b];
+        alpha[p] = max(alpha[b], OT_PCOST(b, p));
+        mark[p] = a;
+    }
+    // ...then down, every node comes after its parent in tree->order
+    for(int t=0; t<n-1; t++){
+        int b = tree->order[t];
+        if(mark[b] != a){
+            int p = tree->parent[b];
+            alpha[b] = max(alpha[p], OT_PCOST(b, p));
+        }
+    }
+
+    alpha[0] = OT_PCOST(a, 0) - maxzero;
+    for(int b=1; b<n; b++){
+        if(b != a){
+            alpha[b] = OT_PCOST(a, b) - alpha[b];
+        }
+    }
+}
+
+#undef OT_PCOST
+
+// cost of the nearest neighbour tour from node 0, used as upper bound when none is given
+static double ot_nn_cost(void){
+    int n = tsp_inst.nnodes;
+    bool* visited = (bool*) calloc(n, sizeof(bool));
+    if(visited == NULL){
+        return -1.0;
+    }
+
+    double cost = 0.0;
+    int current = 0;
+    visited[0] = true;
+    for(int k=1; k<n; k++){
+        int next = -1;
+        for(int i=0; i<n; i++){
+            if(!visited[i] && (next < 0 || tsp_get_cost(current, i) < tsp_get_cost(current, next))){
+                next = i;
+            }
+        }
+        cost += tsp_get_cost(current, next);
+        visited[next] = true;
+        current = next;
+    }
+    cost += tsp_get_cost(current, 0);
+
+    utils_safe_free(visited);
+    return cost;
+}
+
+ERROR_CODE ot_HeldKarp(double upper_bound){
+    ERROR_CODE e = T_OK;
+    int n = tsp_inst.nnodes;
+
+    log_info("computing Held-Karp lower bound");
+
+    if(n < 3){
+        log_error("Held-Karp bound needs at least 3 nodes");
+        return FAILED_PRECONDITION;
+    }
+
+    if(upper_bound <= 0.0){
+        upper_bound = ot_nn_cost();
+    }
+
+    ot_tree tree;
+    e = ot_init(&tree, n);
+    if(!err_ok(e)){
+        return e;
+    }
+
+    bool budget = false;
+    double* pi = (double*) calloc(n, sizeof(double));
+    double* best_pi = (double*) calloc(n, sizeof(double));
+    if(pi == NULL || best_pi == NULL){
+        log_error("error in allocating the penalties");
+        e = RESOURCE_EXHAUSTED;
+        goto ot_free_all;
+    }
+
+    double best = -__DBL_MAX__;
+    double lambda = OT_INIT_LAMBDA;
+    int stall = 0;
+    int iter;
+
+    // the bound is only a support for the algorithm, do not use more than 1/10 of the time
+    budget = (tsp_env.timelimit != -1.0 && err_ok(dl_push(tsp_env.timelimit / 10.0)));
+
+    for(iter=0; iter<OT_MAXITER && lambda >= OT_MIN_LAMBDA; iter++){
+        if(dl_expired()){
+            log_warn("time limit reached in Held-Karp, keeping the best bound found");
+            break;
+        }
+
+        e = ot_compute(&tree, pi);
+        if(!err_ok(e)){
+            log_error("error in computing the 1-tree");
+            goto ot_free_all;
+        }
+
+        if(tree.value > best + 1.0E-9){
+            best = tree.value;
+            memcpy(best_pi, pi, n * sizeof(double));
+            stall = 0;
+        }else if(++stall >= OT_STALL_ITERS){
+            lambda /= 2.0;
+            stall = 0;
+        }
+
+        int norm = 0;
+        for(int i=0; i<n; i++){
+            norm += (tree.degree[i] - 2) * (tree.degree[i] - 2);
+        }
+        if(norm == 0){
+            log_info("the 1-tree is a tour, the bound is optimal");
+            break;
+        }
+        if(upper_bound - tree.value <= 0.0){
+            break;
+        }
+
+        // Polyak step towards the upper bound
+        double t = lambda * (upper_bound - tree.value) / norm;
+        for(int i=0; i<n; i++){
+            pi[i] += t * (tree.degree[i] - 2);
+        }
+    }
+
+    // costs are rounded to integers, so is the optimal tour
+    tsp_inst.lower_bound = ceil(best - 1.0E-6);
+    utils_safe_free(tsp_inst.hk_pi);
+    tsp_inst.hk_pi = best_pi;
+    best_pi = NULL;
+
+    log_info("Held-Karp bound %.2f after %d iterations", tsp_inst.lower_bound, iter);
+
+ot_free_all:
+    if(budget){
+        dl_pop();
+    }
+    utils_safe_free(pi);
+    utils_safe_free(best_pi);
+    ot_free(&tree);
+
+    return e;
+}
+
+double ot_gap(double cost){
+    if(tsp_inst.lower_bound < 0.0 || cost <= 0.0 || cost == __DBL_MAX__){
+        return -1.0;
+    }
+    return (cost - tsp_inst.lower_bound) / cost;
+}
+
+bool ot_gap_reached(double cost){
+    if(tsp_env.gap < 0.0){
+        return false;
+    }
+    double gap = ot_gap(cost);
+    return gap >= 0.0 && gap <= tsp_env.gap;
+}
@@ -0,0 +1,113 @@
+#ifndef ONETREE_H_
+#define ONETREE_H_
+
+/**
+ * @file onetree.h
+ * @brief Held-Karp lower bound: minimum 1-trees on the costs c_ij + pi_i + pi_j, with the node penalties pi
+ *        optimized by subgradient ascent
+ * @version 0.1
+ * @date 2024-06-13
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "../tsp.h"
+
+#define OT_MAXITER 1000             // maximum number of subgradient iterations
+#define OT_INIT_LAMBDA 2.0          // initial Polyak step coefficient
+#define OT_MIN_LAMBDA 1.0E-4        // the ascent stops when the coefficient falls below it
+#define OT_STALL_ITERS 20           // iterations without improvement before halving the coefficient
+
+// state of an edge in ot_compute_fixed
+#define OT_FREE 0
+#define OT_INCLUDED 1
+#define OT_EXCLUDED -1
+
+/**
+ * @brief Minimum 1-tree: a spanning tree on the nodes 1..n-1 plus the two cheapest edges incident to node 0
+ *
+ */
+typedef struct {
+    int nnodes;
+    int* parent;                    // parent of each node in the spanning tree rooted at node 1, -1 for nodes 0 and 1
+    int* order;                     // nodes 1..n-1 in the order they entered the tree, each node comes after its parent
+    int* degree;                    // degree of each node in the 1-tree
+    int first;                      // nodes adjacent to node 0
+    int second;
+    double value;                   // L(pi) = cost of the 1-tree on the penalized costs - 2 * sum(pi)
+} ot_tree;
+
+/**
+ * @brief Allocates the arrays of a 1-tree
+ *
+ * @param tree ot_tree pointer
+ * @param nnodes Number of nodes
+ * @return ERROR_CODE
+ */
+ERROR_CODE ot_init(ot_tree* tree, int nnodes);
+
+/**
+ * @brief Computes the minimum 1-tree on the penalized costs with Prim's algorithm
+ *
+ * @param tree ot_tree pointer, must be initialized
+ * @param pi Node penalties, NULL means all zeros
+ * @return ERROR_CODE
+ */
+ERROR_CODE ot_compute(ot_tree* tree, const double* pi);
+
+/**
+ * @brief Computes the minimum 1-tree on the penalized costs that contains all the included edges and none of the excluded ones
+ *
+ * @param tree ot_tree pointer, must be initialized
+ * @param pi Node penalties, NULL means all zeros
+ * @param fixed n*n symmetric matrix with the state of each edge (OT_FREE, OT_INCLUDED or OT_EXCLUDED), NULL means all free
+ * @return ERROR_CODE NOT_FOUND if no 1-tree satisfies the fixings
+ */
+ERROR_CODE ot_compute_fixed(ot_tree* tree, const double* pi, const signed char* fixed);
+
+/**
+ * @brief Computes alpha(a,b) for every node b, i.e. the increase of the cost of the 1-tree when edge a-b is forced in.
+ *        Runs in O(n) time visiting the tree in topological order
+ *
+ * @param tree 1-tree computed with ot_compute on the same penalties
+ * @param pi Node penalties, NULL means all zeros
+ * @param a Node
+ * @param alpha Array of size n to receive the values, alpha[a] is meaningless
+ * @param mark Work array of size n, must be initialized to -1 before the first call on a tree
+ */
+void ot_alpha_row(const ot_tree* tree, const double* pi, int a, double* alpha, int* mark);
+
+/**
+ * @brief Frees the arrays of a 1-tree
+ *
+ * @param tree ot_tree pointer
+ */
+void ot_free(ot_tree* tree);
+
+/**
+ * @brief Subgradient optimization of the Held-Karp bound. The bound is saved in tsp_inst.lower_bound and the
+ *        penalties giving it in tsp_inst.hk_pi
+ *
+ * @param upper_bound Cost of a tour used in the Polyak step, if not positive a nearest neighbour tour is used
+ * @return ERROR_CODE
+ */
+ERROR_CODE ot_HeldKarp(double upper_bound);
+
+/**
+ * @brief Relative gap between a tour cost and the Held-Karp bound
+ *
+ * @param cost Tour cost
+ * @return double (cost - bound) / cost, or -1 if the bound has not been computed
+ */
+double ot_gap(double cost);
+
+/**
+ * @brief Checks the gap-based stopping rule set with -gap
+ *
+ * @param cost Cost of the best tour found
+ * @return true If the bound is available and the gap is at most tsp_env.gap
+ * @return false Otherwise
+ */
+bool ot_gap_reached(double cost);
+
+#endif
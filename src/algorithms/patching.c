@@ -0,0 +1,210 @@
+#include "patching.h"
+
+ERROR_CODE pt_patch(tsp_solution* solution, pt_merge_fn fn, void* userhandle){
+    int n = tsp_inst.nnodes;
+    if(solution->ncomp <= 1){
+        return T_OK;
+    }
+
+    ERROR_CODE e = T_OK;
+    pt_heap heap = {0};
+    int k = (tsp_inst.cand != NULL) ? tsp_inst.ncand : CL_NCAND;
+    int* knn = NULL;
+    const int* cand = tsp_inst.cand;
+    int* size = (int*) calloc(n + 1, sizeof(int));
+    if(size == NULL){
+        log_error("error in allocating memory for patching");
+        return RESOURCE_EXHAUSTED;
+    }
+    if(cand == NULL){
+        knn = (int*) malloc((size_t)n * k * sizeof(int));
+        if(knn == NULL){
+            log_error("error in allocating memory for patching");
+            e = RESOURCE_EXHAUSTED;
+            goto pt_free;
+        }
+        e = cl_knn(tsp_inst.points, n, k, knn);
+        if(!err_ok(e)){
+            goto pt_free;
+        }
+        cand = knn;
+    }
+
+    for(int i=0; i<n; i++){
+        size[solution->comp[i]]++;
+    }
+
+    for(int a=0; a<n && err_ok(e); a++){
+        for(int h=0; h<k && err_ok(e); h++){
+            int b = cand[a * k + h];
+            if(b >= 0 && solution->comp[a] != solution->comp[b]){
+                e = pt_heap_push(&heap, pt_evaluate(solution, a, b));
+            }
+        }
+    }
+
+    int ncomp = solution->ncomp;
+    while(err_ok(e) && solution->ncomp > 1){
+        if(heap.size == 0){
+            // the neighbour lists of the smallest component stay inside it, try all its pairs
+            int smallest = solution->comp[0];
+            for(int i=0; i<n; i++){
+                if(size[solution->comp[i]] < size[smallest]){
+                    smallest = solution->comp[i];
+                }
+            }
+            for(int a=0; a<n && err_ok(e); a++){
+                if(solution->comp[a] != smallest){
+                    continue;
+                }
+                for(int b=0; b<n && err_ok(e); b++){
+                    if(solution->comp[b] != smallest){
+                        e = pt_heap_push(&heap, pt_evaluate(solution, a, b));
+                    }
+                }
+            }
+            continue;
+        }
+
+        pt_merge m = pt_heap_pop(&heap);
+        if(solution->comp[m.a] == solution->comp[m.b]){
+            continue;
+        }
+        if(solution->path[m.a] != m.sa || solution->path[m.b] != m.sb){
+            e = pt_heap_push(&heap, pt_evaluate(solution, m.a, m.b));
+            continue;
+        }
+
+        pt_apply(solution, &m, size);
+
+        if(fn != NULL && solution->ncomp > 1){
+            e = fn(solution, m.a, userhandle);
+        }
+    }
+
+    log_debug("patching merged %d components, cost %.2f", ncomp - solution->ncomp + 1, solution->cost);
+
+pt_free:
+    utils_safe_free(size);
+    utils_safe_free(knn);
+    utils_safe_free(heap.items);
+
+    return e;
+}
+
+//================================================================================
+// PATCHING UTILS
+//================================================================================
+
+pt_merge pt_evaluate(const tsp_solution* solution, int a, int b){
+    int sa = solution->path[a];
+    int sb = solution->path[b];
+    double removed = tsp_get_cost(a, sa) + tsp_get_cost(b, sb);
+
+    double swapped = tsp_get_cost(a, sb) + tsp_get_cost(b, sa) - removed;
+    double reversed = tsp_get_cost(a, b) + tsp_get_cost(sa, sb) - removed;
+
+    return (pt_merge){
+        .delta = (reversed < swapped) ? reversed : swapped,
+        .a = a,
+        .b = b,
+        .sa = sa,
+        .sb = sb,
+        .reversed = (reversed < swapped)
+    };
+}
+
+void pt_apply(tsp_solution* solution, const pt_merge* m, int* size){
+    int* path = solution->path;
+    int ca = solution->comp[m->a];
+    int cb = solution->comp[m->b];
+    bool small_a = (size[ca] < size[cb]);
+    int big = small_a ? cb : ca;
+
+    if(!m->reversed){
+        // a -> succ(b) ... b -> succ(a) ... a, the smaller subtour keeps its direction
+        path[m->a] = m->sb;
+        path[m->b] = m->sa;
+        int v = small_a ? m->sa : m->sb;
+        int last = small_a ? m->a : m->b;
+        while(1){
+            solution->comp[v] = big;
+            if(v == last){
+                break;
+            }
+            v = path[v];
+        }
+    }else{
+        // reverse the smaller subtour, then a-b and succ(a)-succ(b) close the tour
+        int start = small_a ? m->a : m->b;
+        int prev = start;
+        int v = path[start];
+        while(1){
+            int next = path[v];
+            path[v] = prev;
+            solution->comp[v] = big;
+            if(v == start){
+                break;
+            }
+            prev = v;
+            v = next;
+        }
+        if(small_a){
+            path[m->b] = m->a;
+            path[m->sa] = m->sb;
+        }else{
+            path[m->a] = m->b;
+            path[m->sb] = m->sa;
+        }
+    }
+
+    size[big] = size[ca] + size[cb];
+    size[small_a ? ca : cb] = 0;
+    solution->cost += m->delta;
+    solution->ncomp--;
+}
+
+ERROR_CODE pt_heap_push(pt_heap* heap, pt_merge m){
+    if(heap->size == heap->capacity){
+        int capacity = max(64, 2 * heap->capacity);
+        pt_merge* items = (pt_merge*) realloc(heap->items, capacity * sizeof(pt_merge));
+        if(items == NULL){
+            log_error("error in allocating the patching heap");
+            return RESOURCE_EXHAUSTED;
+        }
+        heap->items = items;
+        heap->capacity = capacity;
+    }
+
+    int i = heap->size++;
+    while(i > 0 && heap->items[(i - 1) / 2].delta > m.delta){
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i] = m;
+
+    return T_OK;
+}
+
+pt_merge pt_heap_pop(pt_heap* heap){
+    pt_merge top = heap->items[0];
+    pt_merge last = heap->items[--heap->size];
+
+    int i = 0;
+    while(2 * i + 1 < heap->size){
+        int c = 2 * i + 1;
+        if(c + 1 < heap->size && heap->items[c + 1].delta < heap->items[c].delta){
+            c++;
+        }
+        if(heap->items[c].delta >= last.delta){
+            break;
+        }
+        heap->items[i] = heap->items[c];
+        i = c;
+    }
+    if(heap->size > 0){
+        heap->items[i] = last;
+    }
+
+    return top;
+}
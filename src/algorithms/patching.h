@@ -0,0 +1,104 @@
+#ifndef PATCHING_H_
+#define PATCHING_H_
+
+/**
+ * @file patching.h
+ * @brief Repairs a solution made of several subtours into a single tour. Only the pairs of nodes in different components
+ *        that are in each other's neighbour list are candidates: a merge removes the edges leaving a and b and either
+ *        links a-succ(b), b-succ(a) or a-b, succ(a)-succ(b) reversing one of the two subtours. Merges are kept in a
+ *        heap by cost increase, entries made stale by a previous merge are evaluated again when they reach the top and
+ *        the smaller component is the one relabelled or reversed, so the repair takes about O(n k log n) instead of
+ *        O(c n^2) for c subtours
+ * @version 0.1
+ * @date 2024-06-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "cluster.h"
+
+/**
+ * @brief Candidate merge of the component of a with the component of b
+ *
+ */
+typedef struct {
+    double delta;                   // cost increase
+    int a;
+    int b;
+    int sa;                         // successors of a and b when the merge was evaluated
+    int sb;
+    bool reversed;                  // true for a-b, succ(a)-succ(b)
+} pt_merge;
+
+/**
+ * @brief Binary min-heap of merges
+ *
+ */
+typedef struct {
+    pt_merge* items;
+    int size;
+    int capacity;
+} pt_heap;
+
+/**
+ * @brief Function called after each merge that leaves more than one component
+ *
+ * @param solution Solution after the merge
+ * @param node A node of the merged component, its subtour can be followed along solution->path
+ * @param userhandle Pointer passed to pt_patch
+ * @return ERROR_CODE, the repair stops if it is not ok
+ */
+typedef ERROR_CODE (*pt_merge_fn)(const tsp_solution* solution, int node, void* userhandle);
+
+/**
+ * @brief Merges all the components of the solution into a single tour, updating path, comp, ncomp and cost. Uses the
+ *        candidate lists in tsp_inst.cand if they are built, the nearest neighbours of each point otherwise
+ *
+ * @param solution Solution with comp labels between 1 and the number of nodes
+ * @param fn Function called after each merge, can be NULL
+ * @param userhandle Pointer passed to fn
+ * @return ERROR_CODE
+ */
+ERROR_CODE pt_patch(tsp_solution* solution, pt_merge_fn fn, void* userhandle);
+
+//================================================================================
+// PATCHING UTILS
+//================================================================================
+
+/**
+ * @brief Best of the two ways to merge the components of a and b, with the current successors
+ *
+ * @param solution Solution
+ * @param a Node
+ * @param b Node of another component
+ * @return pt_merge
+ */
+pt_merge pt_evaluate(const tsp_solution* solution, int a, int b);
+
+/**
+ * @brief Applies a merge, the smaller component is relabelled and, for a reversed merge, reversed
+ *
+ * @param solution Solution
+ * @param m Merge, evaluated with the current successors
+ * @param size Number of nodes of each component label, updated
+ */
+void pt_apply(tsp_solution* solution, const pt_merge* m, int* size);
+
+/**
+ * @brief Inserts a merge in the heap
+ *
+ * @param heap Heap
+ * @param m Merge
+ * @return ERROR_CODE
+ */
+ERROR_CODE pt_heap_push(pt_heap* heap, pt_merge m);
+
+/**
+ * @brief Removes the merge of least cost increase from a non empty heap
+ *
+ * @param heap Heap
+ * @return pt_merge
+ */
+pt_merge pt_heap_pop(pt_heap* heap);
+
+#endif
@@ -11,20 +11,19 @@ ERROR_CODE ref_2opt(tsp_solution* solution, double* costs, bool update_incumbent
     ERROR_CODE e = T_OK;
     
     double delta = 0;
+    struct timespec start = st_now();
 
     do {
         // see if it exceeds the time limit
-        if(tsp_env.timelimit != -1.0){
-            double ex_time = utils_timeelapsed(&tsp_inst.c);
-            if(ex_time > tsp_env.timelimit){
-                log_debug("time limit exceeded in 2opt");
-                e = DEADLINE_EXCEEDED;
-                break;
-            }
+        if(dl_expired()){
+            log_debug("time limit exceeded in 2opt");
+            e = DEADLINE_EXCEEDED;
+            break;
         }
 
-        delta = ref_2opt_once( solution, costs);
+        delta = (tsp_inst.cand != NULL) ? ref_2opt_once_cand( solution, costs) : ref_2opt_once( solution, costs);
     }while(delta < EPSILON);
+    st_time(ST_TIME_REFINEMENT, &start);
     
     if(update_incumbent){
         ERROR_CODE error = tsp_update_best_solution( solution);
@@ -69,6 +68,8 @@ double ref_2opt_once( tsp_solution* solution, double* costs){
     }
 
 
+    st_add(ST_2OPT_EVALUATED, (long)tsp_inst.nnodes * (tsp_inst.nnodes - 1) / 2);
+
     // execute best swap
 
     if(best_delta < EPSILON){
@@ -77,6 +78,7 @@ double ref_2opt_once( tsp_solution* solution, double* costs){
         log_debug("best swap is %d, %d: executing swap...", a, b);
         int succ_a = solution->path[a]; //successor of a
         int succ_b = solution->path[b]; //successor of b
+        st_add(ST_2OPT_APPLIED, 1);
                     
         //Reverse the path from the b to the successor of a
         ref_reverse_path(a, succ_a, b, succ_b, prev, solution->path);
@@ -92,6 +94,73 @@ double ref_2opt_once( tsp_solution* solution, double* costs){
 
 }
 
+double ref_2opt_once_cand(tsp_solution* solution, double* costs){
+    double best_delta = 0;
+    int best_swap[2] = {-1, -1};
+
+    int *prev = calloc(tsp_inst.nnodes, sizeof(int));          // save the path of the solution without 2opt
+    for (int i = 0; i < tsp_inst.nnodes; i++) {
+        prev[solution->path[i]] = i;
+    }
+
+    // scan the candidates of each node to find best swap
+    for (int a = 0; a < tsp_inst.nnodes; a++) {
+        for (int k = 0; k < tsp_inst.ncand; k++) {
+            int c = tsp_inst.cand[a * tsp_inst.ncand + k];
+
+            // new edge a-c replacing the edges leaving a and c...
+            int succ_a = solution->path[a];
+            int succ_c = solution->path[c];
+            if (succ_a != c && succ_c != a) {
+                double delta = costs[a * tsp_inst.nnodes + c] + costs[succ_a * tsp_inst.nnodes + succ_c]
+                             - costs[a * tsp_inst.nnodes + succ_a] - costs[c * tsp_inst.nnodes + succ_c];
+                if (delta < best_delta) {
+                    best_delta = delta;
+                    best_swap[0] = a;
+                    best_swap[1] = c;
+                }
+            }
+
+            // ...or the edges entering a and c
+            int prev_a = prev[a];
+            int prev_c = prev[c];
+            if (prev_a != c && prev_c != a) {
+                double delta = costs[a * tsp_inst.nnodes + c] + costs[prev_a * tsp_inst.nnodes + prev_c]
+                             - costs[prev_a * tsp_inst.nnodes + a] - costs[prev_c * tsp_inst.nnodes + c];
+                if (delta < best_delta) {
+                    best_delta = delta;
+                    best_swap[0] = prev_a;
+                    best_swap[1] = prev_c;
+                }
+            }
+        }
+    }
+
+    st_add(ST_2OPT_EVALUATED, 2L * tsp_inst.nnodes * tsp_inst.ncand);
+
+    // execute best swap
+
+    if(best_delta < EPSILON){
+        int a = best_swap[0];
+        int b = best_swap[1];
+        log_debug("best swap is %d, %d: executing swap...", a, b);
+        int succ_a = solution->path[a]; //successor of a
+        int succ_b = solution->path[b]; //successor of b
+        st_add(ST_2OPT_APPLIED, 1);
+
+        //Reverse the path from the b to the successor of a
+        ref_reverse_path(a, succ_a, b, succ_b, prev, solution->path);
+
+        // update solution cost
+        solution->cost += best_delta;
+        log_debug("2-opt improved solution: new cost: %f", solution->cost);
+    }
+
+    utils_safe_free(prev);
+
+    return best_delta;
+}
+
 void ref_reverse_path(int a, int succ_a, int b, int succ_b, int *prev, int* solution_path) {
     //Swap the 2 edges
     solution_path[a] = b;
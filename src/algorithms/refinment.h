@@ -34,6 +34,15 @@ ERROR_CODE ref_2opt(tsp_solution* solution, double* costs, bool update_incumbent
  */
 double ref_2opt_once(tsp_solution* solution, double* costs);
 
+/**
+ * @brief Util for one 2opt move restricted to the candidate lists: one of the two new edges must be a-c with c candidate of a
+ * 
+ * @param solution Tsp_solution to hold the best solution
+ * @param costs Matrix of costs
+ * @return double Best delta
+ */
+double ref_2opt_once_cand(tsp_solution* solution, double* costs);
+
 /**
  * @brief Util to reverse a path from start_node to end_node in solution_path
  * 
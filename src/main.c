@@ -1,10 +1,54 @@
 #include "algorithms/matheuristics.h"
 #include "algorithms/metaheuristic.h"
+#include "algorithms/candidates.h"
+#include "algorithms/bnb.h"
+#include "algorithms/dp.h"
+#include "algorithms/balas.h"
+#include "algorithms/cluster.h"
+#include "algorithms/multilevel.h"
 
 ERROR_CODE tsp_run_algorithm(){
     ERROR_CODE e = T_OK;
     tsp_inst.best_solution.path = (int*) calloc(tsp_inst.nnodes, sizeof(int));
 
+    // tiny instances are solved to optimality by the DP faster than any other algorithm gets started
+    if(tsp_inst.nnodes <= tsp_env.dp_nodes && tsp_inst.nnodes >= 3 && tsp_inst.alg != ALG_HELD_KARP_DP){
+        log_info("%d nodes, switching to Held-Karp dynamic programming", tsp_inst.nnodes);
+        tsp_inst.alg = ALG_HELD_KARP_DP;
+    }
+
+    // without the cost matrix only the geometric algorithms and the DP, which reads the costs through tsp_get_cost, can run
+    if(tsp_inst.costs == NULL && !TSP_GEOMETRIC_ALG(tsp_inst.alg) && tsp_inst.alg != ALG_HELD_KARP_DP){
+        log_error("%d nodes are too many for the cost matrix, use -alg CLUSTER or MULTILEVEL", tsp_inst.nnodes);
+        return FAILED_PRECONDITION;
+    }
+
+    // every random choice derives from this generator, the parallel algorithms split it into streams
+    rng_seed(&tsp_inst.rng, (tsp_env.seed == -1) ? (uint64_t)time(NULL) : (uint64_t)tsp_env.seed);
+
+    // the watchdog raises the stop flag polled by the algorithms and the CPLEX terminate flag at the time limit
+    e = dl_start(&tsp_inst.c, tsp_env.timelimit, &tsp_inst.cplex_terminate);
+    if(!err_ok(e)){
+        return e;
+    }
+
+    if(tsp_env.hk_bound && tsp_inst.costs == NULL){
+        log_warn("Held-Karp bound needs the cost matrix, gap will not be reported");
+    }else if(tsp_env.hk_bound){
+        e = ot_HeldKarp(-1.0);
+        if(!err_ok(e)){
+            log_warn("Held-Karp bound not available, gap will not be reported");
+            e = T_OK;
+        }
+    }
+
+    // the geometric algorithms build their own neighbour lists on a grid
+    e = TSP_GEOMETRIC_ALG(tsp_inst.alg) ? T_OK : cand_build();
+    if(!err_ok(e)){
+        log_warn("candidate lists not available, local searches will use all the neighbours");
+        e = T_OK;
+    }
+
     switch (tsp_inst.alg)
     {
     case ALG_GREEDY:
@@ -63,7 +107,7 @@ ERROR_CODE tsp_run_algorithm(){
         }
         break;
     case ALG_HARD_FIXING:
-        e = mh_HardFixing();
+        e = (tsp_env.hf_workers > 1) ? mh_HardFixingParallel() : mh_HardFixing();
         if(!err_ok(e)){
             log_fatal("Hard Fixing did not finish correctly");
         }
@@ -74,11 +118,57 @@ ERROR_CODE tsp_run_algorithm(){
             log_fatal("Local branching did not finish correctly");
         }
         break;
+    case ALG_BNB_1TREE:
+        e = bnb_Solve();
+        if(!err_ok(e)){
+            log_fatal("1-tree branch-and-bound did not finish correctly");
+        }
+        break;
+    case ALG_HELD_KARP_DP:
+        e = dp_HeldKarp();
+        if(!err_ok(e)){
+            log_fatal("Held-Karp dynamic programming did not finish correctly");
+        }
+        break;
+    case ALG_PROXIMITY_SEARCH:
+        e = mh_ProximitySearch();
+        if(!err_ok(e)){
+            log_fatal("Proximity Search did not finish correctly");
+        }
+        break;
+    case ALG_POPMUSIC:
+        e = mh_Popmusic();
+        if(!err_ok(e)){
+            log_fatal("POPMUSIC did not finish correctly");
+        }
+        break;
+    case ALG_CLUSTER:
+        e = cl_Solve();
+        if(!err_ok(e)){
+            log_fatal("cluster decomposition did not finish correctly");
+        }
+        break;
+    case ALG_MULTILEVEL:
+        e = ml_Solve();
+        if(!err_ok(e)){
+            log_fatal("multilevel refinement did not finish correctly");
+        }
+        break;
     default:
         log_error("cannot run any algorithm");
         break;
     }
 
+    if(err_ok(e) && tsp_env.bs_k > 0){
+        e = bs_Polish();
+        if(!err_ok(e)){
+            log_warn("Balas-Simonetti polish failed, keeping the solution of the algorithm");
+            e = T_OK;
+        }
+    }
+
+    dl_stop();
+
     if(err_ok(e)){
         tsp_plot_solution();
     }
@@ -127,6 +217,7 @@ return_struct* tsp_webapp_run(const char* path, int seed, int time_limit, int al
     // end options
 
     // run selected algorithm
+    utils_startclock(&tsp_inst.c);
     e = tsp_run_algorithm();
     if(!err_ok(e)){
         log_error("error while running the algorithm");
@@ -156,6 +247,7 @@ return_struct* tsp_webapp_run(const char* path, int seed, int time_limit, int al
 }
 
 int main(int argc, char* argv[]){
+    struct timespec parse = st_now();
     ERROR_CODE e = tsp_parse_commandline(argc, argv);
     if(!err_ok(e)){
         log_error("error in command line parsing, error code: %d", e);
@@ -169,6 +261,7 @@ int main(int argc, char* argv[]){
     if(tsp_env.graph_random){
         tsp_generate_randompoints();
     }
+    st_time(ST_TIME_PARSE, &parse);
 
     err_setinfo(tsp_inst.alg, tsp_inst.nnodes, tsp_env.graph_random, tsp_env.inputfile, tsp_env.timelimit, tsp_env.seed, tsp_env.policy, tsp_env.mileage_init, tsp_env.init_mip, tsp_env.skip_policy, tsp_env.callback_relaxation, tsp_env.lb_improv, tsp_env.lb_delta, tsp_env.lb_kstar);
 
@@ -184,7 +277,11 @@ int main(int argc, char* argv[]){
     }
     
     double ex_time = utils_timeelapsed(&tsp_inst.c);
-    err_printoutput(tsp_inst.best_solution.cost, ex_time, tsp_inst.alg);
+    err_printoutput(tsp_inst.best_solution.cost, ex_time, tsp_inst.alg, tsp_inst.lower_bound);
+
+    if(tsp_env.stats_file != NULL){
+        st_dump(tsp_env.stats_file, tsp_inst.alg, tsp_inst.best_solution.cost, ex_time);
+    }
 
     tsp_free_instance();
     
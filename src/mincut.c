@@ -1,5 +1,19 @@
 #include "mincut.h"
 
+static int fill_flowgraph(graph *G, int ncount, int ecount, int *elist, double *ecap);
+static int buildgraph_ws(CCcut_workspace *W, int ncount, int ecount, int *elist, double *ecap);
+static int mincut_st_ws(CCcut_workspace *W, int ncount, int ecount, int *elist, double *ecap,
+                        int s, int t, double *value, int **cut, int *cutcount);
+static void srk_fill_graph(CC_SRKgraph *G, int *degree, int ncount, int ecount, int *elist, double *dlen);
+static int srk_buildgraph_ws(CCcut_workspace *W, CC_SRKgraph *G, int ncount, int ecount,
+                             int *elist, double *dlen);
+static void srk_count_edges(CC_SRKgraph *G, int *oncount, int *oecount);
+static int srk_fill_edges(CC_SRKgraph *G, int *olist, double *olen);
+static int srk_grab_edges_ws(CCcut_workspace *W, CC_SRKgraph *G, int *oncount, int *oecount);
+static int shrunk_mincut(CCcut_workspace *W, CC_SRKgraph *G, double *minval, double cutoff,
+                         CC_SRKcallback *cb, int **cut, int *cutcount,
+                         int (*doit_fn)(double, int, int *, void *), void *pass_param);
+
 
 int CCcut_connect_components(int ncount, int ecount, int* elist, double* x, int* ncomp, int** compscount, int** comps)
 {
@@ -86,6 +100,106 @@ CLEANUP:
     return rval;
 }
 
+int CCcut_violated_cuts_shrunk(int ncount, int ecount, int* elist,
+    double* dlen, double cutoff, int (*doit_fn) (double, int, int*, void*),
+    void* pass_param, int* ncomp, CCcut_workspace* W)
+{
+    int rval = 0;
+    CCcut_workspace localW;
+    CC_SRKgraph G;
+    CC_SRKexpinfo E;
+    CC_SRKcallback cb;
+    int i, k, sncount, secount;
+    int* compscount = (int*)NULL;
+    int* comps = (int*)NULL;
+    double minval = CC_MINCUT_BIGDOUBLE;
+
+    if (!W) {
+        CCcut_init_workspace(&localW);
+        W = &localW;
+    }
+
+    CCcut_SRK_init_graph(&G);
+    CCcut_SRK_init_expinfo(&E);
+    CCcut_SRK_init_callback(&cb);
+    cb.cutoff = cutoff;
+    cb.pass_param = pass_param;
+    cb.doit_fn = doit_fn;
+    *ncomp = 0;
+
+    /* Padberg-Rinaldi shrinking on the whole support graph, done only once */
+
+    rval = srk_buildgraph_ws(W, &G, ncount, ecount, elist, dlen);
+    if (rval) {
+        fprintf(stderr, "srk_buildgraph_ws failed\n"); goto CLEANUP;
+    }
+    rval = CCcut_SRK_subtour_shrink(&G, &minval, CC_MINCUT_ONE_EPSILON,
+        &cb, (int**)NULL, (int*)NULL);
+    if (rval) {
+        fprintf(stderr, "CCcut_SRK_subtour_shrink failed\n"); goto CLEANUP;
+    }
+
+    rval = srk_grab_edges_ws(W, &G, &sncount, &secount);
+    if (rval) {
+        fprintf(stderr, "srk_grab_edges_ws failed\n"); goto CLEANUP;
+    }
+    rval = CCcut_SRK_grab_nodes(&G, &E);
+    if (rval) {
+        fprintf(stderr, "CCcut_SRK_grab_nodes failed\n"); goto CLEANUP;
+    }
+    sncount = E.ncount;
+
+    if (sncount <= 1) {
+        *ncomp = 1;
+        goto CLEANUP;
+    }
+
+    /* connected components of the shrunk graph, each one is expanded */
+    /* back to the original nodes and passed as a violated cut         */
+
+    rval = CCcut_connect_components(sncount, secount, W->slist, W->slen,
+        ncomp, &compscount, &comps);
+    if (rval) {
+        fprintf(stderr, "CCcut_connect_components failed\n"); goto CLEANUP;
+    }
+
+    if (*ncomp > 1) {
+        for (i = 0, k = 0; i < *ncomp; k += compscount[i], i++) {
+            int* fcut = (int*)NULL;
+            int fcutcount = 0;
+
+            rval = CCcut_SRK_expand(&E, comps + k, compscount[i], &fcut,
+                &fcutcount);
+            if (rval) {
+                fprintf(stderr, "CCcut_SRK_expand failed\n"); goto CLEANUP;
+            }
+            rval = doit_fn(0.0, fcutcount, fcut, pass_param);
+            CC_IFFREE(fcut, int);
+            if (rval) {
+                fprintf(stderr, "doit_fn failed\n"); goto CLEANUP;
+            }
+        }
+    }
+    else {
+        rval = shrunk_mincut(W, &G, &minval, cutoff, &cb, (int**)NULL,
+            (int*)NULL, doit_fn, pass_param);
+        if (rval) {
+            fprintf(stderr, "shrunk_mincut failed\n"); goto CLEANUP;
+        }
+    }
+
+CLEANUP:
+
+    CC_IFFREE(compscount, int);
+    CC_IFFREE(comps, int);
+    CCcut_SRK_free_expinfo(&E);
+    if (W == &localW) {
+        CCcut_free_workspace(&localW);
+    }
+
+    return rval;
+}
+
 void* CCutil_allocrus(size_t size)
 {
     void* mem = (void*)NULL;
@@ -101,6 +215,22 @@ void* CCutil_allocrus(size_t size)
     return mem;
 }
 
+void* CCutil_reallocrus(void* ptr, size_t size)
+{
+    void* mem = (void*)NULL;
+
+    if (size == 0) {
+        fprintf(stderr, "Warning: 0 bytes reallocated\n");
+    }
+
+    mem = (void*)realloc(ptr, size);
+    if (mem == (void*)NULL) {
+        fprintf(stderr, "Out of memory. Asked for %d bytes\n", (int)size);
+        free(ptr);
+    }
+    return mem;
+}
+
 void CCutil_freerus(void* p)
 {
     if (!p) {
@@ -284,22 +414,13 @@ static int mincut_work(int ncount, int ecount, int* elist, double* dlen,
     int (*doit_fn) (double, int, int*, void*), void* pass_param)
 {
     int rval = 0;
+    CCcut_workspace W;
     CC_SRKgraph G;
-    CC_SRKexpinfo E;
-    int i, sncount, secount;
-    int* slist = (int*)NULL;
-    double* slen = (double*)NULL;
     double minval = CC_MINCUT_BIGDOUBLE;
-    double val;
-    CC_SRKnode* squeue = (CC_SRKnode*)NULL;
-    CC_SRKedge* f;
-    int* tcut = (int*)NULL;
-    int** mytcut = (int**)NULL;
-    int tcount = 0;
     CC_SRKcallback* cb = (CC_SRKcallback*)NULL;
 
+    CCcut_init_workspace(&W);
     CCcut_SRK_init_graph(&G);
-    CCcut_SRK_init_expinfo(&E);
     if (cut) {
         *cut = (int*)NULL;
         if (cutcount) {
@@ -310,12 +431,6 @@ static int mincut_work(int ncount, int ecount, int* elist, double* dlen,
             rval = 1; goto CLEANUP;
         }
     }
-    if (cut || doit_fn) {
-        mytcut = &tcut;
-    }
-    else {
-        mytcut = (int**)NULL;
-    }
     if (cutval) {
         *cutval = CC_MINCUT_BIGDOUBLE;
     }
@@ -330,7 +445,7 @@ static int mincut_work(int ncount, int ecount, int* elist, double* dlen,
         cb->doit_fn = doit_fn;
     }
 
-    rval = CCcut_SRK_buildgraph(&G, ncount, ecount, elist, dlen);
+    rval = srk_buildgraph_ws(&W, &G, ncount, ecount, elist, dlen);
     if (rval) {
         fprintf(stderr, "buildgraph failed in shrink_ones\n"); goto CLEANUP;
     }
@@ -340,29 +455,82 @@ static int mincut_work(int ncount, int ecount, int* elist, double* dlen,
         fprintf(stderr, "CCcut_SRK_subtour_shrink failed\n"); goto CLEANUP;
     }
 
-    if (CCcut_SRK_grab_edges(&G, &sncount, &secount, &slist, &slen,
-        (CC_SRKexpinfo*)NULL)) {
+    rval = shrunk_mincut(&W, &G, &minval, cutoff, cb, cut, cutcount, doit_fn,
+        pass_param);
+    if (rval) {
+        fprintf(stderr, "shrunk_mincut failed\n"); goto CLEANUP;
+    }
+
+    if (cutval) {
+        *cutval = minval;
+    }
+
+    if (cut) {
+        if (*cutcount > ncount / 2) {
+            rval = flip_the_cut(ncount, cut, cutcount);
+            if (rval) {
+                fprintf(stderr, "flip_the_cut failed\n"); goto CLEANUP;
+            }
+        }
+    }
+
+CLEANUP:
+
+    if (rval) {
+        if (cut) {
+            CC_IFFREE(*cut, int);
+        }
+    }
+    CCcut_free_workspace(&W);
+    CC_IFFREE(cb, CC_SRKcallback);
+
+    return rval;
+}
+
+static int shrunk_mincut(CCcut_workspace* W, CC_SRKgraph* G, double* minval,
+    double cutoff, CC_SRKcallback* cb, int** cut, int* cutcount,
+    int (*doit_fn) (double, int, int*, void*), void* pass_param)
+{
+    int rval = 0;
+    CC_SRKexpinfo E;
+    int i, sncount, secount;
+    double val;
+    CC_SRKnode* squeue = (CC_SRKnode*)NULL;
+    CC_SRKedge* f;
+    int* tcut = (int*)NULL;
+    int** mytcut = (int**)NULL;
+    int tcount = 0;
+
+    CCcut_SRK_init_expinfo(&E);
+    if (cut || doit_fn) {
+        mytcut = &tcut;
+    }
+    else {
+        mytcut = (int**)NULL;
+    }
+
+    if (srk_grab_edges_ws(W, G, &sncount, &secount)) {
         fprintf(stderr, "grab edges failed in shrink_ones\n");
         rval = 1; goto CLEANUP;
     }
 
     while (sncount > 1) {
-        if (G.head->adj == (CC_SRKedge*)NULL ||
-            G.head->next->adj == (CC_SRKedge*)NULL) {
+        if (G->head->adj == (CC_SRKedge*)NULL ||
+            G->head->next->adj == (CC_SRKedge*)NULL) {
             fprintf(stderr, "Disconnected graph\n");
             rval = 1; goto CLEANUP;
         }
-        rval = CCcut_mincut_st(sncount, secount, slist, slen, 0, 1,
+        rval = mincut_st_ws(W, sncount, secount, W->slist, W->slen, 0, 1,
             &val, mytcut, &tcount);
         if (rval) {
-            fprintf(stderr, "CCcut_mincut_st failed\n");
+            fprintf(stderr, "mincut_st_ws failed\n");
             goto CLEANUP;
         }
-        if (val < minval) {
-            minval = val;
+        if (val < *minval) {
+            *minval = val;
             if (cut) {
                 CC_IFFREE(*cut, int);
-                rval = CCcut_SRK_grab_nodes(&G, &E);
+                rval = CCcut_SRK_grab_nodes(G, &E);
                 if (rval) {
                     fprintf(stderr, "CCcut_SRK_grab_nodes failed\n");
                     goto CLEANUP;
@@ -375,7 +543,7 @@ static int mincut_work(int ncount, int ecount, int* elist, double* dlen,
             int* fcut = (int*)NULL;
             int fcutcount = 0;
 
-            rval = CCcut_SRK_grab_nodes(&G, &E);
+            rval = CCcut_SRK_grab_nodes(G, &E);
             if (rval) {
                 fprintf(stderr, "CCcut_SRK_grab_nodes failed\n");
                 goto CLEANUP;
@@ -395,57 +563,32 @@ static int mincut_work(int ncount, int ecount, int* elist, double* dlen,
             CC_IFFREE(tcut, int);
         }
 
-        CCcut_SRK_identify_nodes(&G, G.head, G.head->next);
+        CCcut_SRK_identify_nodes(G, G->head, G->head->next);
 
         squeue = (CC_SRKnode*)NULL;
-        for (f = G.head->adj; f; f = f->next) {
+        for (f = G->head->adj; f; f = f->next) {
             f->end->qnext = squeue;
             squeue = f->end;
         }
-        G.head->qnext = squeue;
-        squeue = G.head;
+        G->head->qnext = squeue;
+        squeue = G->head;
 
-        CCcut_SRK_identify_pr_edges(&G, &minval, &i, squeue,
+        CCcut_SRK_identify_pr_edges(G, minval, &i, squeue,
             CC_MINCUT_ONE_EPSILON, cb, cut, cutcount);
 
         /* if (i) { printf ("[%d]", i); fflush (stdout); } */
 
-        CC_IFFREE(slist, int);
-        CC_IFFREE(slen, double);
-        rval = CCcut_SRK_grab_edges(&G, &sncount, &secount, &slist, &slen,
-            (CC_SRKexpinfo*)NULL);
+        rval = srk_grab_edges_ws(W, G, &sncount, &secount);
         if (rval) {
             fprintf(stderr, "grab edges failed in shrink_ones\n");
             goto CLEANUP;
         }
     }
 
-    if (cutval) {
-        *cutval = minval;
-    }
-
-    if (cut) {
-        if (*cutcount > ncount / 2) {
-            rval = flip_the_cut(ncount, cut, cutcount);
-            if (rval) {
-                fprintf(stderr, "flip_the_cut failed\n"); goto CLEANUP;
-            }
-        }
-    }
-
 CLEANUP:
 
-    if (rval) {
-        if (cut) {
-            CC_IFFREE(*cut, int);
-        }
-    }
-    CC_IFFREE(slist, int);
-    CC_IFFREE(slen, double);
     CC_IFFREE(tcut, int);
-    CCcut_SRK_free_graph(&G);
     CCcut_SRK_free_expinfo(&E);
-    CC_IFFREE(cb, CC_SRKcallback);
 
     return rval;
 }
@@ -612,18 +755,75 @@ int CCcut_SRK_buildgraph(CC_SRKgraph* G, int ncount, int ecount, int* elist,
     int i;
     int* degree = (int*)NULL;
     int newecount = 0;
-    CC_SRKnode* nodespace, * n, * n1, * n2;
-    CC_SRKedge* e, * adj1, * adj2;
-    CC_SRKedge** hit;
+
+    for (i = 0; i < ecount; i++) {
+        if (dlen[i] > SRK_ZERO_EPSILON) {
+            newecount++;
+        }
+    }
 
     G->nodespace = CC_SAFE_MALLOC(ncount, CC_SRKnode);
     G->hit = CC_SAFE_MALLOC(ncount, CC_SRKedge*);
-    if (!G->nodespace || !G->hit) {
+    G->edgespace = CC_SAFE_MALLOC(2 * newecount, CC_SRKedge);
+    degree = CC_SAFE_MALLOC(ncount, int);
+    if (!G->nodespace || !G->hit || !G->edgespace || !degree) {
         fprintf(stderr, "out of memory in CCcut_SRK_buildgraph\n");
         CC_IFFREE(G->nodespace, CC_SRKnode);
         CC_IFFREE(G->hit, CC_SRKedge*);
+        CC_IFFREE(G->edgespace, CC_SRKedge);
+        CC_IFFREE(degree, int);
         return 1;
     }
+
+    srk_fill_graph(G, degree, ncount, ecount, elist, dlen);
+
+    CC_IFFREE(degree, int);
+    return 0;
+}
+
+static int srk_buildgraph_ws(CCcut_workspace* W, CC_SRKgraph* G, int ncount,
+    int ecount, int* elist, double* dlen)
+{
+    if (ncount > W->srk_nodecap) {
+        W->srk_nodecap = 0;
+        W->srk_nodespace = CC_SAFE_REALLOC(W->srk_nodespace, ncount, CC_SRKnode);
+        W->srk_hit = CC_SAFE_REALLOC(W->srk_hit, ncount, CC_SRKedge*);
+        W->srk_degree = CC_SAFE_REALLOC(W->srk_degree, ncount, int);
+        if (!W->srk_nodespace || !W->srk_hit || !W->srk_degree) {
+            fprintf(stderr, "out of memory in srk_buildgraph_ws\n");
+            return 1;
+        }
+        W->srk_nodecap = ncount;
+    }
+    /* 2 * ecount is an upper bound on the number of half edges */
+    if (2 * ecount > W->srk_edgecap) {
+        W->srk_edgecap = 0;
+        W->srk_edgespace = CC_SAFE_REALLOC(W->srk_edgespace, 2 * ecount,
+            CC_SRKedge);
+        if (!W->srk_edgespace) {
+            fprintf(stderr, "out of memory in srk_buildgraph_ws\n");
+            return 1;
+        }
+        W->srk_edgecap = 2 * ecount;
+    }
+
+    G->nodespace = W->srk_nodespace;
+    G->hit = W->srk_hit;
+    G->edgespace = W->srk_edgespace;
+
+    srk_fill_graph(G, W->srk_degree, ncount, ecount, elist, dlen);
+
+    return 0;
+}
+
+static void srk_fill_graph(CC_SRKgraph* G, int* degree, int ncount,
+    int ecount, int* elist, double* dlen)
+{
+    int i;
+    CC_SRKnode* nodespace, * n, * n1, * n2;
+    CC_SRKedge* e, * adj1, * adj2;
+    CC_SRKedge** hit;
+
     nodespace = G->nodespace;
     hit = G->hit;
     G->head = nodespace;
@@ -631,14 +831,6 @@ int CCcut_SRK_buildgraph(CC_SRKgraph* G, int ncount, int ecount, int* elist,
     G->original_ecount = ecount;
     G->marker = 0;
 
-    degree = CC_SAFE_MALLOC(ncount, int);
-    if (!degree) {
-        fprintf(stderr, "out of memory in CCcut_SRK_buildgraph\n");
-        CC_IFFREE(G->nodespace, CC_SRKnode);
-        CC_IFFREE(G->hit, CC_SRKedge*);
-        return 1;
-    }
-
     for (i = 0, n = nodespace; i < ncount; i++, n++) {
         n->prev = n - 1;
         n->next = n + 1;
@@ -657,18 +849,10 @@ int CCcut_SRK_buildgraph(CC_SRKgraph* G, int ncount, int ecount, int* elist,
 
     for (i = 0; i < ecount; i++) {
         if (dlen[i] > SRK_ZERO_EPSILON) {
-            newecount++;
             degree[elist[2 * i]]++;
             degree[elist[2 * i + 1]]++;
         }
     }
-    G->edgespace = CC_SAFE_MALLOC(2 * newecount, CC_SRKedge);
-    if (!G->edgespace) {
-        fprintf(stderr, "out of memory in CCcut_SRK_buildgraph\n");
-        CC_IFFREE(G->nodespace, CC_SRKnode);
-        CC_IFFREE(G->hit, CC_SRKedge*);
-        return 1;
-    }
 
     for (e = G->edgespace, i = 0; i < ncount; i++) {
         nodespace[i].adj = e;
@@ -715,9 +899,6 @@ int CCcut_SRK_buildgraph(CC_SRKgraph* G, int ncount, int ecount, int* elist,
             n->weight += e->weight;
         }
     }
-
-    CC_IFFREE(degree, int);
-    return 0;
 }
 
 int CCcut_SRK_subtour_shrink(CC_SRKgraph* G, double* minval, double epsilon,
@@ -756,10 +937,7 @@ int CCcut_SRK_grab_edges(CC_SRKgraph* G, int* oncount, int* oecount,
     int** olist, double** olen, CC_SRKexpinfo* expand)
 {
     int rval = 0;
-    int k, num;
     int ncount = 0, ecount = 0;
-    CC_SRKnode* n;
-    CC_SRKedge* e;
 
     *oncount = 0;
     *oecount = 0;
@@ -769,12 +947,7 @@ int CCcut_SRK_grab_edges(CC_SRKgraph* G, int* oncount, int* oecount,
         CCcut_SRK_init_expinfo(expand);
     }
 
-    for (n = G->head; n; n = n->next) {
-        n->newnum = ncount;
-        for (e = n->adj; e; e = e->next)
-            ecount++;
-        ncount++;
-    }
+    srk_count_edges(G, &ncount, &ecount);
 
     if (ecount % 2) {
         fprintf(stderr, "Error in grab_edges\n");
@@ -795,18 +968,7 @@ int CCcut_SRK_grab_edges(CC_SRKgraph* G, int* oncount, int* oecount,
         rval = 1; goto CLEANUP;
     }
 
-    k = 0;
-    for (n = G->head; n; n = n->next) {
-        num = n->newnum;
-        for (e = n->adj; e; e = e->next) {
-            if (num < e->end->newnum) {
-                (*olist)[2 * k] = num;
-                (*olist)[2 * k + 1] = e->end->newnum;
-                (*olen)[k++] = e->weight;
-            }
-        }
-    }
-    if (k != ecount) {
+    if (srk_fill_edges(G, *olist, *olen) != ecount) {
         fprintf(stderr, "Error in grab_edges\n");
         rval = 1; goto CLEANUP;
     }
@@ -834,6 +996,84 @@ CLEANUP:
     return rval;
 }
 
+static void srk_count_edges(CC_SRKgraph* G, int* oncount, int* oecount)
+{
+    int ncount = 0, ecount = 0;
+    CC_SRKnode* n;
+    CC_SRKedge* e;
+
+    for (n = G->head; n; n = n->next) {
+        n->newnum = ncount;
+        for (e = n->adj; e; e = e->next)
+            ecount++;
+        ncount++;
+    }
+
+    *oncount = ncount;
+    *oecount = ecount;
+}
+
+static int srk_fill_edges(CC_SRKgraph* G, int* olist, double* olen)
+{
+    int k = 0, num;
+    CC_SRKnode* n;
+    CC_SRKedge* e;
+
+    for (n = G->head; n; n = n->next) {
+        num = n->newnum;
+        for (e = n->adj; e; e = e->next) {
+            if (num < e->end->newnum) {
+                olist[2 * k] = num;
+                olist[2 * k + 1] = e->end->newnum;
+                olen[k++] = e->weight;
+            }
+        }
+    }
+
+    return k;
+}
+
+static int srk_grab_edges_ws(CCcut_workspace* W, CC_SRKgraph* G, int* oncount,
+    int* oecount)
+{
+    int ncount = 0, ecount = 0;
+
+    *oncount = 0;
+    *oecount = 0;
+
+    srk_count_edges(G, &ncount, &ecount);
+
+    if (ecount % 2) {
+        fprintf(stderr, "Error in srk_grab_edges_ws\n");
+        return 1;
+    }
+    ecount /= 2;
+
+    if (ecount > W->slistcap) {
+        W->slistcap = 0;
+        W->slist = CC_SAFE_REALLOC(W->slist, 2 * ecount, int);
+        W->slen = CC_SAFE_REALLOC(W->slen, ecount, double);
+        if (!W->slist || !W->slen) {
+            fprintf(stderr, "out of memory in srk_grab_edges_ws\n");
+            return 1;
+        }
+        W->slistcap = ecount;
+    }
+
+    if (ecount && srk_fill_edges(G, W->slist, W->slen) != ecount) {
+        fprintf(stderr, "Error in srk_grab_edges_ws\n");
+        return 1;
+    }
+
+    /* same convention of CCcut_SRK_grab_edges: no nodes if no edges */
+    if (ecount) {
+        *oncount = ncount;
+        *oecount = ecount;
+    }
+
+    return 0;
+}
+
 int CCcut_SRK_grab_nodes(CC_SRKgraph* G, CC_SRKexpinfo* expand)
 {
     int rval = 0;
@@ -898,7 +1138,7 @@ int CCcut_mincut_st(int ncount, int ecount, int* elist, double* ecap,
     }
     *value = flow(&G, G.nodelist + s, G.nodelist + t);
     if (cut) {
-        rval = grab_the_cut(&G, G.nodelist + t, cut, cutcount);
+        rval = grab_the_cut(&G, G.nodelist + t, cut, cutcount, (int*)NULL);
         if (rval) {
             fprintf(stderr, "grab_the_cut failed\n"); goto CLEANUP;
         }
@@ -911,6 +1151,70 @@ CLEANUP:
     return rval;
 }
 
+static int mincut_st_ws(CCcut_workspace* W, int ncount, int ecount, int* elist,
+    double* ecap, int s, int t, double* value, int** cut, int* cutcount)
+{
+    int rval = 0;
+    graph* G = &W->flow;
+
+    if (cut) {
+        *cut = (int*)NULL;
+        if (cutcount) {
+            *cutcount = 0;
+        }
+        else {
+            fprintf(stderr, "cut is specified but not cutcount\n");
+            return 1;
+        }
+    }
+
+    rval = buildgraph_ws(W, ncount, ecount, elist, ecap);
+    if (rval) {
+        fprintf(stderr, "buildgraph_ws failed\n");
+        return rval;
+    }
+    *value = flow(G, G->nodelist + s, G->nodelist + t);
+    if (cut) {
+        rval = grab_the_cut(G, G->nodelist + t, cut, cutcount, W->tcut);
+        if (rval) {
+            fprintf(stderr, "grab_the_cut failed\n");
+        }
+    }
+
+    return rval;
+}
+
+void CCcut_init_workspace(CCcut_workspace* W)
+{
+    init_graph(&W->flow);
+    W->flow.magicnum = 0;
+    W->flow_nodecap = 0;
+    W->flow_edgecap = 0;
+    W->tcut = (int*)NULL;
+    W->srk_nodespace = (CC_SRKnode*)NULL;
+    W->srk_hit = (CC_SRKedge**)NULL;
+    W->srk_degree = (int*)NULL;
+    W->srk_nodecap = 0;
+    W->srk_edgespace = (CC_SRKedge*)NULL;
+    W->srk_edgecap = 0;
+    W->slist = (int*)NULL;
+    W->slen = (double*)NULL;
+    W->slistcap = 0;
+}
+
+void CCcut_free_workspace(CCcut_workspace* W)
+{
+    free_graph_aux(&W->flow, true);
+    CC_IFFREE(W->tcut, int);
+    CC_IFFREE(W->srk_nodespace, CC_SRKnode);
+    CC_IFFREE(W->srk_hit, CC_SRKedge*);
+    CC_IFFREE(W->srk_degree, int);
+    CC_IFFREE(W->srk_edgespace, CC_SRKedge);
+    CC_IFFREE(W->slist, int);
+    CC_IFFREE(W->slen, double);
+    CCcut_init_workspace(W);
+}
+
 int CCcut_SRK_expand(CC_SRKexpinfo* expand, int* arr, int size, int** pnewarr,
     int* pnewsize)
 {
@@ -1212,8 +1516,6 @@ static int buildgraph(graph* G, int ncount, int ecount, int* elist,
     double* ecap)
 {
     int i;
-    edge* edgelist;
-    node* nodelist;
 
     G->nodelist = (node*)NULL;
     G->edgelist = (edge*)NULL;
@@ -1225,8 +1527,6 @@ static int buildgraph(graph* G, int ncount, int ecount, int* elist,
 #endif
 
     G->magicnum = 0;
-    G->nnodes = ncount;
-    G->nedges = ecount;
     G->nodelist = CC_SAFE_MALLOC(ncount, node);
     G->edgelist = CC_SAFE_MALLOC(ecount, edge);
     if (!G->nodelist || !G->edgelist) {
@@ -1243,9 +1543,6 @@ static int buildgraph(graph* G, int ncount, int ecount, int* elist,
         CC_IFFREE(G->edgelist, edge);
         return 1;
     }
-    for (i = 0; i < ncount; i++)
-        G->level[i] = (node*)NULL;
-    G->level[ncount] = (node*)NULL;  /* A guard dog for a while loop */
 #endif
 
 #ifdef HIGHEST_LABEL_PRF
@@ -1258,13 +1555,89 @@ static int buildgraph(graph* G, int ncount, int ecount, int* elist,
     }
 #endif
 
-    nodelist = G->nodelist;
-    edgelist = G->edgelist;
+    for (i = 0; i < ncount; i++) {
+        G->nodelist[i].magiclabel = 0;
+    }
+
+    return fill_flowgraph(G, ncount, ecount, elist, ecap);
+}
+
+static int buildgraph_ws(CCcut_workspace* W, int ncount, int ecount,
+    int* elist, double* ecap)
+{
+    int i;
+    graph* G = &W->flow;
+
+    if (ncount > W->flow_nodecap) {
+        int oldcap = W->flow_nodecap;
+
+        W->flow_nodecap = 0;
+        G->nodelist = CC_SAFE_REALLOC(G->nodelist, ncount, node);
+        W->tcut = CC_SAFE_REALLOC(W->tcut, ncount, int);
+#ifdef USE_GAP
+        G->level = CC_SAFE_REALLOC(G->level, ncount + 1, node*);
+        if (!G->level) {
+            fprintf(stderr, "Out of memory in buildgraph_ws\n");
+            return 1;
+        }
+#endif
+#ifdef HIGHEST_LABEL_PRF
+        G->high = CC_SAFE_REALLOC(G->high, ncount, node*);
+        if (!G->high) {
+            fprintf(stderr, "Out of memory in buildgraph_ws\n");
+            return 1;
+        }
+#endif
+        if (!G->nodelist || !W->tcut) {
+            fprintf(stderr, "Out of memory in buildgraph_ws\n");
+            return 1;
+        }
+        /* only the new nodes need a label, the old ones are below magicnum */
+        for (i = oldcap; i < ncount; i++) {
+            G->nodelist[i].magiclabel = 0;
+        }
+        W->flow_nodecap = ncount;
+    }
+    if (ecount > W->flow_edgecap) {
+        W->flow_edgecap = 0;
+        G->edgelist = CC_SAFE_REALLOC(G->edgelist, ecount, edge);
+        if (!G->edgelist) {
+            fprintf(stderr, "Out of memory in buildgraph_ws\n");
+            return 1;
+        }
+        W->flow_edgecap = ecount;
+    }
+
+    /* magicnum is never reset, unless it is about to overflow */
+    if (G->magicnum > CC_INFINITY) {
+        for (i = 0; i < W->flow_nodecap; i++) {
+            G->nodelist[i].magiclabel = 0;
+        }
+        G->magicnum = 0;
+    }
+
+    return fill_flowgraph(G, ncount, ecount, elist, ecap);
+}
+
+static int fill_flowgraph(graph* G, int ncount, int ecount, int* elist,
+    double* ecap)
+{
+    int i;
+    edge* edgelist = G->edgelist;
+    node* nodelist = G->nodelist;
+
+    G->nnodes = ncount;
+    G->nedges = ecount;
+
+#ifdef USE_GAP
+    for (i = 0; i < ncount; i++)
+        G->level[i] = (node*)NULL;
+    G->level[ncount] = (node*)NULL;  /* A guard dog for a while loop */
+#endif
 
     for (i = 0; i < ncount; i++) {
         nodelist[i].in = (edge*)NULL;
         nodelist[i].out = (edge*)NULL;
-        nodelist[i].magiclabel = 0;
     }
 
     for (i = 0; i < ecount; i++) {
@@ -1287,7 +1660,8 @@ static int buildgraph(graph* G, int ncount, int ecount, int* elist,
     return 0;
 }
 
-static int grab_the_cut(graph* G, node* n, int** cut, int* cutcount)
+static int grab_the_cut(graph* G, node* n, int** cut, int* cutcount,
+    int* buffer)
 {
     int rval = 0;
     edge* e;
@@ -1300,7 +1674,7 @@ static int grab_the_cut(graph* G, node* n, int** cut, int* cutcount)
     *cut = (int*)NULL;
     *cutcount = 0;
 
-    tcut = CC_SAFE_MALLOC(G->nnodes, int);
+    tcut = buffer ? buffer : CC_SAFE_MALLOC(G->nnodes, int);
     if (!tcut) {
         fprintf(stderr, "out of memory in grab_the_cut\n");
         rval = 1; goto CLEANUP;
@@ -1352,7 +1726,9 @@ CLEANUP:
     if (rval) {
         CC_IFFREE(*cut, int);
     }
-    CC_IFFREE(tcut, int);
+    if (tcut != buffer) {
+        CC_IFFREE(tcut, int);
+    }
     return rval;
     }
 
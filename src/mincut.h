@@ -147,6 +147,9 @@
 #define CC_SAFE_MALLOC(nnum, type) \
     (type *)CCutil_allocrus(((size_t)(nnum)) * sizeof(type))
 
+#define CC_SAFE_REALLOC(object, nnum, type) \
+    (type *)CCutil_reallocrus((void *)(object), ((size_t)(nnum)) * sizeof(type))
+
 #define CC_FREE(object, type)             \
     {                                     \
         CCutil_freerus((void *)(object)); \
@@ -279,6 +282,31 @@ typedef struct edge
     double flow;
 } edge;
 
+/* Separation workspace: the arrays are allocated once for the largest     */
+/* graph seen so far and reused by the following calls, so that the shrink */
+/* graph, the edge lists of the shrunk graph and the flow graph are rebuilt */
+/* in O(n + m) without allocations. magicnum is never reset, therefore the  */
+/* magiclabels of the flow nodes do not need to be cleared between calls.   */
+
+typedef struct CCcut_workspace
+{
+    graph flow;
+    int flow_nodecap;
+    int flow_edgecap;
+    int *tcut;
+
+    CC_SRKnode *srk_nodespace;
+    CC_SRKedge **srk_hit;
+    int *srk_degree;
+    int srk_nodecap;
+    CC_SRKedge *srk_edgespace;
+    int srk_edgecap;
+
+    int *slist;
+    double *slen;
+    int slistcap;
+} CCcut_workspace;
+
 static int
 buildgraph(graph *G, int ncount, int ecount, int *elist, double *gap),
     flip_the_cut(int ncount, int **cut, int *cutcount);
@@ -287,7 +315,7 @@ static double flow(graph *G, node *s, node *t);
 static void merge_adj(CC_SRKgraph *G, CC_SRKnode *n, CC_SRKnode *m);
 static int build_graph(graph *G, int ncount, int ecount, int *elist, double *x);
 
-static int grab_the_cut(graph *G, node *n, int **cut, int *cutcount);
+static int grab_the_cut(graph *G, node *n, int **cut, int *cutcount, int *buffer);
 static int test_node(CC_SRKnode *n, double *minval, CC_SRKcallback *cb, int **cut, int *cutcount);
 static int expand_the_node(CC_SRKnode *n, int *cutcount, int **cut);
 static int expand_and_pass(CC_SRKnode *n, int (*doit_fn)(double, int, int *, void *), void *pass_param);
@@ -301,6 +329,7 @@ free_graph(graph *G),
     init_graph(graph *G),
     free_graph_aux(graph *G, bool aux);
 void *CCutil_allocrus(size_t size);
+void *CCutil_reallocrus(void *ptr, size_t size);
 void CCutil_freerus(void *p);
 #ifdef __cplusplus
 extern "C"
@@ -312,12 +341,17 @@ extern "C"
         CCcut_SRK_init_expinfo(CC_SRKexpinfo *expand),
         CCcut_SRK_free_expinfo(CC_SRKexpinfo *expand),
         CCcut_SRK_init_callback(CC_SRKcallback *cb),
-        CCcut_SRK_identify_nodes(CC_SRKgraph *G, CC_SRKnode *n, CC_SRKnode *m);
+        CCcut_SRK_identify_nodes(CC_SRKgraph *G, CC_SRKnode *n, CC_SRKnode *m),
+        CCcut_init_workspace(CCcut_workspace *W),
+        CCcut_free_workspace(CCcut_workspace *W);
 
     int
     CCcut_violated_cuts(int ncount, int ecount, int *elist, double *dlen,
                         double cutoff, int (*doit_fn)(double, int, int *, void *),
                         void *pass_param),
+        CCcut_violated_cuts_shrunk(int ncount, int ecount, int *elist, double *dlen,
+                                   double cutoff, int (*doit_fn)(double, int, int *, void *),
+                                   void *pass_param, int *ncomp, CCcut_workspace *W),
         CCcut_connect_components(int ncount, int ecount, int *elist, double *x,
                                  int *ncomp, int **compscount, int **comps),
         CCcut_SRK_buildgraph(CC_SRKgraph *G, int ncount, int ecount, int *elist,
@@ -11,6 +11,14 @@ void tsp_init(){
     tsp_env.seed = -1;
     tsp_env.tofile = false;
     tsp_env.k = __INT_MAX__;
+    tsp_env.threads = max(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
+    tsp_env.gap = -1.0;
+    tsp_env.hk_bound = false;
+    tsp_env.cand = CAND_NONE;
+    tsp_env.cand_k = 5;
+    tsp_env.dp_nodes = 16;
+    tsp_env.bs_k = 0;
+    tsp_env.stats_file = NULL;
 
     tsp_env.policy = POL_LINEAR;
 
@@ -22,8 +30,12 @@ void tsp_init(){
     tsp_env.skip_policy = 0;
     tsp_env.callback_relaxation = true;
     tsp_env.modified_costs = false;
+    tsp_env.bc_rootcuts = true;
+    tsp_env.bc_elim = true;
 
     tsp_env.hf_prob = 0.7;
+    tsp_env.hf_workers = 1;
+    tsp_env.hf_policy = HF_RANDOM;
 
     tsp_env.lb_dynk = false;
     tsp_env.lb_initk = 10;
@@ -31,6 +43,14 @@ void tsp_init(){
     tsp_env.lb_delta = 10;
     tsp_env.lb_kstar = false;
 
+    tsp_env.ps_theta = 1.0;
+
+    tsp_env.pm_r = 40;
+
+    tsp_env.cl_size = 1000;
+
+    tsp_env.ml_coarsest = 100;
+
 
     // instance initialization
     tsp_inst.nnodes = -1;
@@ -39,6 +59,10 @@ void tsp_init(){
     tsp_inst.alg = ALG_GREEDY;
     tsp_inst.cplex_terminate = 0;
     tsp_inst.ncols = -1;
+    tsp_inst.lower_bound = -1.0;
+    tsp_inst.hk_pi = NULL;
+    tsp_inst.cand = NULL;
+    tsp_inst.ncand = 0;
 
     err_setverbosity(NORMAL);
 }
@@ -151,6 +175,24 @@ ERROR_CODE tsp_parse_commandline(int argc, char** argv){
             }else if (strcmp("LOCAL_BRANCHING", method) == 0){
                 tsp_inst.alg = ALG_LOCAL_BRANCHING;
                 log_info("selected Hard Fixing");
+            }else if (strcmp("BNB_1TREE", method) == 0){
+                tsp_inst.alg = ALG_BNB_1TREE;
+                log_info("selected 1-tree branch-and-bound");
+            }else if (strcmp("HELD_KARP_DP", method) == 0){
+                tsp_inst.alg = ALG_HELD_KARP_DP;
+                log_info("selected Held-Karp dynamic programming");
+            }else if (strcmp("POPMUSIC", method) == 0){
+                tsp_inst.alg = ALG_POPMUSIC;
+                log_info("selected POPMUSIC");
+            }else if (strcmp("CLUSTER", method) == 0){
+                tsp_inst.alg = ALG_CLUSTER;
+                log_info("selected cluster decomposition");
+            }else if (strcmp("MULTILEVEL", method) == 0){
+                tsp_inst.alg = ALG_MULTILEVEL;
+                log_info("selected multilevel refinement");
+            }else if (strcmp("PROXIMITY_SEARCH", method) == 0){
+                tsp_inst.alg = ALG_PROXIMITY_SEARCH;
+                log_info("selected proximity search");
             }else{
                 log_warn("algorithm not recognized, using greedy as default");
             }
@@ -187,6 +229,18 @@ ERROR_CODE tsp_parse_commandline(int argc, char** argv){
             continue;
         }
 
+        if(strcmp("--stats", argv[i]) == 0){
+
+            if(utils_invalid_input(i + 1, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            utils_safe_free(tsp_env.stats_file);
+            tsp_env.stats_file = strdup(argv[++i]);
+            continue;
+        }
+
         if(strcmp("--to_file", argv[i]) == 0){
             log_info("plots will be saved to directory /plots");
 
@@ -260,6 +314,28 @@ ERROR_CODE tsp_parse_commandline(int argc, char** argv){
             continue;
         }
 
+        if(strcmp("--no_rootcuts", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            tsp_env.bc_rootcuts = false;
+            continue;
+        }
+
+        if(strcmp("--no_elim", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            tsp_env.bc_elim = false;
+            continue;
+        }
+
         if (strcmp("-hf_prob", argv[i]) == 0){
 
             if(utils_invalid_input(i, argc, &help)){
@@ -276,6 +352,108 @@ ERROR_CODE tsp_parse_commandline(int argc, char** argv){
             continue;
         }
 
+        if (strcmp("-hf_workers", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const int w = atoi(argv[++i]);
+            if(w < 1){
+                log_warn("hf_workers must be at least 1");
+                continue;
+            }
+            tsp_env.hf_workers = w;
+            continue;
+        }
+
+        if (strcmp("-hf_policy", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const char* method = argv[++i];
+
+            if (strcmp("RANDOM", method) == 0){
+                tsp_env.hf_policy = HF_RANDOM;
+            }else if (strcmp("WINDOW", method) == 0){
+                tsp_env.hf_policy = HF_WINDOW;
+                log_info("selected geometric window fixing");
+            }else{
+                log_warn("fixing policy not recognized, using random fixing");
+                tsp_env.hf_policy = HF_RANDOM;
+            }
+
+            continue;
+        }
+
+        if (strcmp("-pm_r", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const int r = atoi(argv[++i]);
+            if(r < 4 || r > 200){
+                log_warn("pm_r must be in range [4,200]");
+                continue;
+            }
+            tsp_env.pm_r = r;
+            continue;
+        }
+
+        if (strcmp("-ps_theta", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const double t = atof(argv[++i]);
+            if(t <= 0.0){
+                log_warn("ps_theta must be positive");
+                continue;
+            }
+            tsp_env.ps_theta = t;
+            continue;
+        }
+
+        if (strcmp("-cl_size", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const int s = atoi(argv[++i]);
+            if(s < 8){
+                log_warn("cl_size must be at least 8");
+                continue;
+            }
+            tsp_env.cl_size = s;
+            continue;
+        }
+
+        if (strcmp("-ml_coarsest", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const int s = atoi(argv[++i]);
+            if(s < 8){
+                log_warn("ml_coarsest must be at least 8");
+                continue;
+            }
+            tsp_env.ml_coarsest = s;
+            continue;
+        }
+
         if (strcmp("--lb_dynk", argv[i]) == 0){
 
             if(utils_invalid_input(i, argc, &help)){
@@ -357,6 +535,123 @@ ERROR_CODE tsp_parse_commandline(int argc, char** argv){
             continue;
         }
 
+        if(strcmp("-threads", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const int t = atoi(argv[++i]);
+            if(t <= 0){
+                log_warn("number of threads must be positive");
+                continue;
+            }
+            tsp_env.threads = t;
+            continue;
+        }
+
+        if(strcmp("-gap", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const double g = atof(argv[++i]);
+            if(g < 0.0 || g >= 1.0){
+                log_warn("gap must be in [0,1)");
+                continue;
+            }
+            tsp_env.gap = g;
+            tsp_env.hk_bound = true;
+            continue;
+        }
+
+        if(strcmp("--hk_bound", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            tsp_env.hk_bound = true;
+            continue;
+        }
+
+        if(strcmp("-cand", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const char* method = argv[++i];
+
+            if (strcmp("NONE", method) == 0){
+                tsp_env.cand = CAND_NONE;
+            }else if (strcmp("KNN", method) == 0){
+                tsp_env.cand = CAND_KNN;
+                log_info("selected nearest neighbour candidates");
+            }else if (strcmp("ALPHA", method) == 0){
+                tsp_env.cand = CAND_ALPHA;
+                log_info("selected alpha-nearness candidates");
+            }else{
+                log_warn("candidate type not recognized, using all the neighbours");
+                tsp_env.cand = CAND_NONE;
+            }
+
+            continue;
+        }
+
+        if(strcmp("-cand_k", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const int k = atoi(argv[++i]);
+            if(k <= 0){
+                log_warn("cand_k must be positive");
+                continue;
+            }
+            tsp_env.cand_k = k;
+            continue;
+        }
+
+        if(strcmp("-dp_max", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const int d = atoi(argv[++i]);
+            if(d < 0 || d > 22){
+                log_warn("dp_max must be in range [0,22]");
+                continue;
+            }
+            tsp_env.dp_nodes = d;
+            continue;
+        }
+
+        if(strcmp("-bs", argv[i]) == 0){
+
+            if(utils_invalid_input(i, argc, &help)){
+                log_warn("invalid input");
+                continue;
+            }
+
+            const int k = atoi(argv[++i]);
+            if(k < 0 || k == 1 || k > 10){
+                log_warn("bs must be 0 or in range [2,10]");
+                continue;
+            }
+            tsp_env.bs_k = k;
+            continue;
+        }
+
         if(strcmp("-em", argv[i]) == 0){
 
             if(utils_invalid_input(i, argc, &help)){
@@ -412,7 +707,7 @@ ERROR_CODE tsp_parse_commandline(int argc, char** argv){
         printf("tsp - Traveling Salesman Solver\n\n");
         printf(COLOR_BOLD "USAGE:\n" COLOR_OFF);
         printf("tsp [--help, -help, -h] [--all_algs] [-file, -f <path>] [-time, -t <value>] [-seed <value>] [-alg <option>] [-n <value>] [--to_file]\n");
-        printf("    [-k <value>] [-em <option>] [--init_mip] [-skip <option>] [--no_relax] [-q, (DEFAULT), -v, -vv] \n\n");
+        printf("    [-k <value>] [-threads <value>] [-gap <value>] [--hk_bound] [-cand <option>] [-cand_k <value>] [-dp_max <value>] [-bs <value>] [-em <option>] [--stats <path>] [--init_mip] [-skip <option>] [--no_relax] [--no_rootcuts] [--no_elim] [-q, (DEFAULT), -v, -vv] \n\n");
         printf(COLOR_BOLD "OPTIONS:\n" COLOR_OFF);
         printf("    --help, -help, -h       prints this text\n");
         printf("    -file, -f <path>        input a TSPLIB file format\n");
@@ -421,20 +716,40 @@ ERROR_CODE tsp_parse_commandline(int argc, char** argv){
         printf("    -alg <option>           selects the algorithm to solve TSP, run --all_algs to see the options\n");
         printf("    -n <value>              number of nodes\n");
         printf("    -k <value>              number of iterations of some tabu search and vns, defaults to the maximum value possible\n");
+        printf("    -threads <value>        number of threads of the parallel algorithms, defaults to the number of cores\n");
+        printf("    -gap <value>            stop VNS, tabu search and matheuristics when the gap from the Held-Karp bound is at most value\n");
+        printf("    --hk_bound              compute the Held-Karp 1-tree lower bound and report the gap\n");
+        printf("    -cand <option>          candidate lists for 2opt, options: NONE, KNN, ALPHA. Defaults to NONE\n");
+        printf("    -cand_k <value>         number of candidates per node, defaults to 5\n");
+        printf("    -dp_max <value>         solve instances up to value nodes with the Held-Karp DP whatever the algorithm, 0 to disable. Defaults to 16\n");
+        printf("    -bs <value>             polish the final solution with Balas-Simonetti, no node moves more than value places. Must be 0 or in range [2,10], defaults to 0\n");
         printf("    -em <option>            initialization for Extra Mileage, options: MAX, RANDOM. Defaults to MAX\n");
         printf("    --all_algs              prints all possible algorithms\n");
         printf("    --to_file               if present, plots will be saved in directory /plots\n");
+        printf("    --stats <path>          write counters and phase times of the run as JSON to path\n");
         printf(COLOR_BOLD "  Branch&Cut\n" COLOR_OFF);
         printf("    --init_mip              use a custom heuristic to be set as MIP start\n");
         printf("    -skip                   skip policy for branch&cut. Either 0 (thread seeds), 1 (number of cplex nodes), 2 (if depth>3)\n");
         printf("    --no_relax              turn off CPLEX relaxation callback function\n");
-        printf("    --modify_costs          in the relaxation callback, post to CPLEX an heuristic solution with modified costs\n");
+        printf("    --modify_costs          in the relaxation callback, post to CPLEX tours guided by the fractional point, built by background workers\n");
+        printf("    --no_rootcuts           turn off the SEC cutting-plane loop on the root LP before branching\n");
+        printf("    --no_elim               turn off reduced-cost edge elimination before branching\n");
         printf(COLOR_BOLD "  Hard Fixing\n" COLOR_OFF);
         printf("    -hf_prob <value>        probability of setting an edge. Must be in range [0,1)\n");
+        printf("    -hf_workers <value>     number of parallel workers with different fixings and probabilities, defaults to 1\n");
+        printf("    -hf_policy <option>     edges to fix, options: RANDOM, WINDOW (all but a random geometric window). Defaults to RANDOM\n");
         printf(COLOR_BOLD "  Local Branching\n" COLOR_OFF);
         printf("    -lb_improv <value>      improvement w.r.t. last iteration objective value needed to increase K. Must be in range (0,1)\n");
         printf("    -lb_delta <value>       corresponds to %lcK, represents the amount by which K is changed\n", 0x0394);
         printf("    --lb_kstar              flag to turn on dynamic K\n");
+        printf(COLOR_BOLD "  Proximity Search\n" COLOR_OFF);
+        printf("    -ps_theta <value>       improvement of the cost asked to each sub-MIP, defaults to 1\n");
+        printf(COLOR_BOLD "  POPMUSIC\n" COLOR_OFF);
+        printf("    -pm_r <value>           number of nodes of the subpaths solved by CPLEX. Must be in range [4,200], defaults to 40\n");
+        printf(COLOR_BOLD "  Cluster Decomposition\n" COLOR_OFF);
+        printf("    -cl_size <value>        maximum number of nodes of a cluster, defaults to 1000\n");
+        printf(COLOR_BOLD "  Multilevel\n" COLOR_OFF);
+        printf("    -ml_coarsest <value>    number of nodes at which coarsening stops, defaults to 100\n");
         printf(COLOR_BOLD "  Verbosity\n" COLOR_OFF);
         printf("    -q                      quiet verbosity level, prints only output\n");
         printf("    DEFAULT                 if no flag is set, prints warnings, erros or fatal errors\n");
@@ -458,6 +773,12 @@ ERROR_CODE tsp_parse_commandline(int argc, char** argv){
         printf("    - CPLEX_BRANCH_CUT\n");
         printf("    - HARD_FIXING\n");
         printf("    - LOCAL_BRANCHING\n");
+        printf("    - BNB_1TREE\n");
+        printf("    - HELD_KARP_DP\n");
+        printf("    - POPMUSIC\n");
+        printf("    - CLUSTER\n");
+        printf("    - MULTILEVEL\n");
+        printf("    - PROXIMITY_SEARCH\n");
         
         exit(EXIT_SUCCESS);
     }
@@ -466,13 +787,15 @@ ERROR_CODE tsp_parse_commandline(int argc, char** argv){
 }
 
 ERROR_CODE tsp_generate_randompoints(){
-    srand(tsp_env.seed);
+    // the instance depends only on the seed, not on the generator the algorithms use afterwards
+    rng_state r;
+    rng_seed(&r, (uint64_t)tsp_env.seed);
 
     tsp_inst.points = (point*) calloc(tsp_inst.nnodes, sizeof(point));
 
     for(int i=0; i<tsp_inst.nnodes; i++){
-        tsp_inst.points[i].x = TSP_RAND();
-        tsp_inst.points[i].y = TSP_RAND();
+        tsp_inst.points[i].x = TSP_RAND(&r);
+        tsp_inst.points[i].y = TSP_RAND(&r);
     }
 
     tsp_compute_costs();
@@ -482,9 +805,8 @@ ERROR_CODE tsp_generate_randompoints(){
 
 ERROR_CODE tsp_plot_points(){
     int i;
-    char* plotfile;
-    plotfile = basename(tsp_env.inputfile);
-    utils_format_title(plotfile, tsp_inst.alg);
+    char plotfile[FILENAME_MAX];
+    utils_format_title(plotfile, sizeof(plotfile), basename(tsp_env.inputfile), tsp_inst.alg);
     PLOT plot = plot_open(plotfile);
 
     if(tsp_env.tofile){
@@ -503,9 +825,8 @@ ERROR_CODE tsp_plot_points(){
 }
 
 ERROR_CODE tsp_plot_solution(){
-    char* plotfile;
-    plotfile = basename(tsp_env.inputfile);
-    utils_format_title(plotfile, tsp_inst.alg);
+    char plotfile[FILENAME_MAX];
+    utils_format_title(plotfile, sizeof(plotfile), basename(tsp_env.inputfile), tsp_inst.alg);
 
     PLOT plot = plot_open(plotfile);
     if(tsp_env.tofile){
@@ -611,7 +932,19 @@ ERROR_CODE tsp_compute_costs(){
         tsp_handlefatal();
     }
 
-    tsp_inst.costs = (double *) calloc(tsp_inst.nnodes * tsp_inst.nnodes, sizeof(double));
+    // the matrix would not fit in memory, or the algorithm never needs all the pairs
+    if(tsp_inst.nnodes > TSP_MAX_MATRIX_NODES || TSP_GEOMETRIC_ALG(tsp_inst.alg)){
+        log_info("cost matrix not stored, costs are computed on the fly");
+        tsp_inst.costs = NULL;
+        return T_OK;
+    }
+
+    struct timespec start = st_now();
+    tsp_inst.costs = (double *) calloc((size_t)tsp_inst.nnodes * tsp_inst.nnodes, sizeof(double));
+    if(tsp_inst.costs == NULL){
+        log_fatal("error in allocating the cost matrix");
+        tsp_handlefatal();
+    }
 
     for (int i = 0; i < tsp_inst.nnodes; i++) {
         // Initialize each element of the matrix to -1 -> infinite cost
@@ -626,16 +959,24 @@ ERROR_CODE tsp_compute_costs(){
             if (j == i){
                 continue;
             }
-            double distance = (double) ((int) (sqrtf(pow(tsp_inst.points[j].x - tsp_inst.points[i].x, 2) + pow(tsp_inst.points[j].y - tsp_inst.points[i].y, 2)) + 0.5));
+            double distance = tsp_distance(&tsp_inst.points[i], &tsp_inst.points[j]);
             tsp_inst.costs[i* tsp_inst.nnodes + j] = distance;
             tsp_inst.costs[j* tsp_inst.nnodes + i] = distance;
         }
     }
+    st_time(ST_TIME_COSTS, &start);
 
     return T_OK;
 }
 
+double tsp_distance(const point* a, const point* b){
+    return (double) ((int) (sqrtf(pow(b->x - a->x, 2) + pow(b->y - a->y, 2)) + 0.5));
+}
+
 double tsp_get_cost(int i, int j){
+    if(tsp_inst.costs == NULL){
+        return (i == j) ? -1.0 : tsp_distance(&tsp_inst.points[i], &tsp_inst.points[j]);
+    }
     return tsp_inst.costs[i * tsp_inst.nnodes + j];
 }
 
@@ -743,9 +1084,13 @@ void tsp_handlefatal(){
 
 void tsp_free_instance(){
     utils_safe_free(tsp_env.inputfile);
+    utils_safe_free(tsp_env.stats_file);
     utils_safe_free(tsp_inst.points);
     utils_safe_free(tsp_inst.costs);
     utils_safe_free(tsp_inst.best_solution.path);
     utils_safe_free(tsp_inst.best_solution.comp);
-    utils_safe_free(tsp_inst.threads_seeds);
+    utils_safe_free(tsp_inst.threads_rng);
+    cp_free(&tsp_inst.sec_pool);
+    utils_safe_free(tsp_inst.hk_pi);
+    utils_safe_free(tsp_inst.cand);
 }
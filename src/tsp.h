@@ -12,11 +12,16 @@
  * 
  */
 #include "utils/plot.h"
+#include "utils/cutpool.h"
+#include "utils/deadline.h"
+#include "utils/stats.h"
 
 #include <libgen.h>
 #include <math.h>
 
 #define EPSILON -1.0E-7
+#define TSP_MAX_MATRIX_NODES 40000  // above this size the cost matrix is not stored, costs are computed from the points
+#define TSP_GEOMETRIC_ALG(alg) ((alg) == ALG_CLUSTER || (alg) == ALG_MULTILEVEL)    // algorithms working on the points only
 
 /**
  * @brief Policies for Tabu Search
@@ -40,6 +45,17 @@ typedef enum{
     BC_DEPTH = 2
 } bc_skip;
 
+typedef enum{
+    HF_RANDOM = 0,
+    HF_WINDOW = 1
+} hf_policies;
+
+typedef enum{
+    CAND_NONE = 0,
+    CAND_KNN = 1,
+    CAND_ALPHA = 2
+} cand_type;
+
 typedef enum {
     ALG_GREEDY = 0,
     ALG_GREEDY_ITER = 1,
@@ -52,7 +68,13 @@ typedef enum {
     ALG_CX_BENDERS_PAT = 8,
     ALG_CX_BRANCH_AND_CUT = 9,
     ALG_HARD_FIXING = 10,
-    ALG_LOCAL_BRANCHING = 11
+    ALG_LOCAL_BRANCHING = 11,
+    ALG_BNB_1TREE = 12,
+    ALG_HELD_KARP_DP = 13,
+    ALG_POPMUSIC = 14,
+    ALG_CLUSTER = 15,
+    ALG_MULTILEVEL = 16,
+    ALG_PROXIMITY_SEARCH = 17
 } algorithms;
 
 typedef struct {
@@ -72,6 +94,14 @@ typedef struct {
     char* inputfile;            // input file path
     bool tofile;                // if true, plots will be saved in directory /plots
     int k;                      // number of iterations of VNS and Tabu Search, by default sets to the maximum integer
+    int threads;                // number of threads of the parallel algorithms, defaults to the number of cores
+    double gap;                 // heuristics stop when the gap from the Held-Karp bound is at most gap, -1 if not set
+    bool hk_bound;              // if true, the Held-Karp lower bound is computed before running the algorithm
+    cand_type cand;             // candidate lists used by the local searches, defaults to none (all the neighbours)
+    int cand_k;                 // number of candidates per node
+    int dp_nodes;               // instances with at most dp_nodes nodes are solved with the Held-Karp DP, 0 to disable
+    int bs_k;                   // size of the Balas-Simonetti polish applied to the final solution, 0 to disable
+    char* stats_file;           // counters and timers are written as JSON to this file, NULL if not requested
 
     // Tabu Search options
     ts_policies policy;         // how to update tenure
@@ -87,9 +117,13 @@ typedef struct {
     bc_skip skip_policy;        // skip policy for branch & cut fractional callback
     bool callback_relaxation;   // if true, it also calls callback for relaxation
     bool modified_costs;        // if true, post to CPLEX an heuristic solution with modified costs    
+    bool bc_rootcuts;           // if true, run a cutting-plane loop on the root LP before branching
+    bool bc_elim;               // if true, fix to 0 the edges whose reduced cost exceeds the gap before branching
 
     // Hard Fixing options
     double hf_prob;             // probability to set an edge
+    int hf_workers;             // number of parallel workers, each with its own CPLEX environment
+    hf_policies hf_policy;      // how to choose the edges to fix
 
     // Local Branching options
     bool lb_dynk;               // flag to indicate if use dynamic k
@@ -98,6 +132,18 @@ typedef struct {
     int lb_delta;               // deltaK
     bool lb_kstar;              // calculate Kstar and pick the average between 0 and Kstar as K starting point
 
+    // Proximity Search options
+    double ps_theta;            // minimum improvement of the cost asked to each sub-MIP
+
+    // POPMUSIC options
+    int pm_r;                   // number of nodes of each subpath re-optimized by CPLEX
+
+    // Cluster decomposition options
+    int cl_size;                // maximum number of nodes of a cluster
+
+    // Multilevel options
+    int ml_coarsest;            // coarsening stops at this number of nodes
+
 } options;
 
 typedef struct {
@@ -120,17 +166,26 @@ typedef struct {
     
     point* points;              // dynamic array of points
        
-    double* costs;              // matrix of costs between pairs of points
+    double* costs;              // matrix of costs between pairs of points, NULL if costs are computed on the fly
 
     tsp_solution best_solution; // current best solution found
 
     int starting_node;          // save the starting node of the best tour
 
-    int* threads_seeds;         // seed for each thread
+    rng_state rng;              // generator of the main thread, seeded at the start of each algorithm
+    rng_state* threads_rng;     // generator of each CPLEX thread, split from rng
 
     int ncols;                  // # of columns of the cplex model
     int cplex_terminate;        // flag to signal cplex to stop
 
+    cutpool sec_pool;           // subtour elimination constraints separated so far
+
+    double lower_bound;         // Held-Karp lower bound, -1 if not computed
+    double* hk_pi;              // node penalties giving the Held-Karp bound
+
+    int* cand;                  // candidate lists, ncand neighbours per node, NULL if not used
+    int ncand;                  // number of candidates per node
+
 } instance;
 
 /**
@@ -186,11 +241,21 @@ void tsp_handlefatal(void);
 void tsp_read_input(void);
 
 /**
- * @brief Precomputes costs and keeps them in matrix costs of the instance
+ * @brief Precomputes costs and keeps them in matrix costs of the instance. The matrix is skipped for the geometric
+ *        algorithms (TSP_GEOMETRIC_ALG) and for instances above TSP_MAX_MATRIX_NODES, tsp_get_cost then computes each cost from the points
  * 
  */
 ERROR_CODE tsp_compute_costs(void);
 
+/**
+ * @brief Rounded euclidean distance between two points
+ * 
+ * @param a first point
+ * @param b second point
+ * @return double distance
+ */
+double tsp_distance(const point* a, const point* b);
+
 /**
  * @brief Validates a tsp solution
  * 
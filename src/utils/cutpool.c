@@ -0,0 +1,213 @@
+#include "cutpool.h"
+
+// splitmix64, only used to generate the Zobrist keys
+static uint64_t cp_splitmix(uint64_t* state){
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static int cp_compare_int(const void* a, const void* b){
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// doubles the number of buckets, caller must hold the lock
+static void cp_rehash(cutpool* pool){
+    int nbuckets = pool->nbuckets * 2;
+    cp_cut** buckets = (cp_cut**) calloc(nbuckets, sizeof(cp_cut*));
+    if(buckets == NULL){
+        // keep the old table, chains will just be longer
+        return;
+    }
+
+    for(int b=0; b<pool->nbuckets; b++){
+        cp_cut* c = pool->buckets[b];
+        while(c != NULL){
+            cp_cut* next = c->next;
+            int idx = (int)(c->hash & (uint64_t)(nbuckets - 1));
+            c->next = buckets[idx];
+            buckets[idx] = c;
+            c = next;
+        }
+    }
+
+    free(pool->buckets);
+    pool->buckets = buckets;
+    pool->nbuckets = nbuckets;
+}
+
+// caller must hold the lock
+static int cp_purge_unlocked(cutpool* pool, int min_hits, long max_age){
+    int removed = 0;
+    for(int b=0; b<pool->nbuckets; b++){
+        cp_cut** link = &pool->buckets[b];
+        while(*link != NULL){
+            cp_cut* c = *link;
+            if(c->hits < min_hits && pool->clock - c->last_seen > max_age){
+                *link = c->next;
+                free(c->nodes);
+                free(c);
+                removed++;
+            }else{
+                link = &c->next;
+            }
+        }
+    }
+    pool->ncuts -= removed;
+    return removed;
+}
+
+ERROR_CODE cp_init(cutpool* pool, int nnodes, unsigned int seed){
+    pool->nnodes = nnodes;
+    pool->nbuckets = CP_INIT_BUCKETS;
+    pool->ncuts = 0;
+    pool->purge_at = CP_PURGE_THRESHOLD;
+    pool->clock = 0;
+    pool->duplicates = 0;
+
+    pool->keys = (uint64_t*) malloc(nnodes * sizeof(uint64_t));
+    pool->buckets = (cp_cut**) calloc(pool->nbuckets, sizeof(cp_cut*));
+    if(pool->keys == NULL || pool->buckets == NULL){
+        log_error("cut pool allocation failed");
+        utils_safe_free(pool->keys);
+        utils_safe_free(pool->buckets);
+        return RESOURCE_EXHAUSTED;
+    }
+
+    uint64_t state = seed;
+    for(int i=0; i<nnodes; i++){
+        pool->keys[i] = cp_splitmix(&state);
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+
+    return T_OK;
+}
+
+bool cp_insert(cutpool* pool, const int* nodes, int nnodes){
+    if(pool->keys == NULL || nnodes <= 0){
+        // pool not initialized, every cut is new
+        return true;
+    }
+
+    // the hash does not depend on the order of the nodes
+    uint64_t hash = 0;
+    for(int i=0; i<nnodes; i++){
+        hash ^= pool->keys[nodes[i]];
+    }
+
+    int* sorted = (int*) malloc(nnodes * sizeof(int));
+    if(sorted == NULL){
+        return true;
+    }
+    memcpy(sorted, nodes, nnodes * sizeof(int));
+    qsort(sorted, nnodes, sizeof(int), cp_compare_int);
+
+    pthread_mutex_lock(&pool->lock);
+
+    pool->clock++;
+
+    int idx = (int)(hash & (uint64_t)(pool->nbuckets - 1));
+    for(cp_cut* c = pool->buckets[idx]; c != NULL; c = c->next){
+        if(c->hash == hash && c->nnodes == nnodes && memcmp(c->nodes, sorted, nnodes * sizeof(int)) == 0){
+            c->hits++;
+            c->last_seen = pool->clock;
+            pool->duplicates++;
+            pthread_mutex_unlock(&pool->lock);
+            free(sorted);
+            return false;
+        }
+    }
+
+    cp_cut* cut = (cp_cut*) malloc(sizeof(cp_cut));
+    if(cut == NULL){
+        pthread_mutex_unlock(&pool->lock);
+        free(sorted);
+        return true;
+    }
+    cut->hash = hash;
+    cut->nnodes = nnodes;
+    cut->nodes = sorted;
+    cut->hits = 1;
+    cut->last_seen = pool->clock;
+    cut->born = pool->clock;
+    cut->next = pool->buckets[idx];
+    pool->buckets[idx] = cut;
+    pool->ncuts++;
+
+    if(pool->ncuts > pool->purge_at){
+        int removed = cp_purge_unlocked(pool, CP_MIN_HITS, CP_MAX_AGE);
+        log_debug("cut pool full, purged %d cuts", removed);
+
+        // if most cuts are still binding the purge frees little, so move the watermark away to keep
+        // the full scan amortized over the insertions
+        pool->purge_at = 2 * pool->ncuts > CP_PURGE_THRESHOLD ? 2 * pool->ncuts : CP_PURGE_THRESHOLD;
+    }
+
+    if(pool->ncuts > 2 * pool->nbuckets){
+        cp_rehash(pool);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return true;
+}
+
+int cp_purge(cutpool* pool, int min_hits, long max_age){
+    if(pool->keys == NULL){
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    int removed = cp_purge_unlocked(pool, min_hits, max_age);
+    pthread_mutex_unlock(&pool->lock);
+
+    return removed;
+}
+
+int cp_foreach(cutpool* pool, int (*fn)(const int* nodes, int nnodes, void* userhandle), void* userhandle){
+    return cp_foreach_since(pool, -1, fn, userhandle);
+}
+
+int cp_foreach_since(cutpool* pool, long since, int (*fn)(const int* nodes, int nnodes, void* userhandle), void* userhandle){
+    if(pool->keys == NULL){
+        return 0;
+    }
+
+    int rval = 0;
+    pthread_mutex_lock(&pool->lock);
+    for(int b=0; b<pool->nbuckets && !rval; b++){
+        for(cp_cut* c = pool->buckets[b]; c != NULL && !rval; c = c->next){
+            if(c->born > since){
+                rval = fn(c->nodes, c->nnodes, userhandle);
+            }
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return rval;
+}
+
+void cp_free(cutpool* pool){
+    if(pool->keys == NULL){
+        return;
+    }
+
+    for(int b=0; b<pool->nbuckets; b++){
+        cp_cut* c = pool->buckets[b];
+        while(c != NULL){
+            cp_cut* next = c->next;
+            free(c->nodes);
+            free(c);
+            c = next;
+        }
+    }
+
+    utils_safe_free(pool->buckets);
+    utils_safe_free(pool->keys);
+    pool->ncuts = 0;
+    pthread_mutex_destroy(&pool->lock);
+}
@@ -0,0 +1,108 @@
+#ifndef CUTPOOL_H_
+#define CUTPOOL_H_
+
+/**
+ * @file cutpool.h
+ * @brief Thread-safe pool of subtour elimination constraints. Each cut is identified by its node set S,
+ *        hashed with a Zobrist-style XOR of random per-node keys. The pool records which cuts were separated and
+ *        how often, and seeds the models built later; violated cuts are always passed to CPLEX since a pooled copy
+ *        may have been purged or belong to another model
+ * @version 0.1
+ * @date 2024-06-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <pthread.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+#define CP_INIT_BUCKETS 1024        // initial number of buckets of the hash table (power of two)
+#define CP_PURGE_THRESHOLD 50000    // number of cuts after which rarely binding cuts are purged
+#define CP_MIN_HITS 2               // cuts separated less than this number of times can be purged...
+#define CP_MAX_AGE 20000            // ...if they have not been separated in the last CP_MAX_AGE lookups
+
+typedef struct cp_cut {
+    uint64_t hash;                  // Zobrist hash of the node set
+    int nnodes;                     // |S|
+    int* nodes;                     // nodes of S, sorted
+    int hits;                       // number of times the cut has been separated
+    long last_seen;                 // pool clock the last time the cut has been separated
+    long born;                      // pool clock when the cut was inserted
+    struct cp_cut* next;            // next cut in the same bucket
+} cp_cut;
+
+typedef struct {
+    int nnodes;                     // number of nodes of the instance
+    uint64_t* keys;                 // random key of each node
+    cp_cut** buckets;               // hash table with chaining
+    int nbuckets;                   // number of buckets, always a power of two
+    int ncuts;                      // number of cuts in the pool
+    int purge_at;                   // next purge happens when ncuts exceeds this watermark
+    long clock;                     // incremented at each insertion, used to age the cuts
+    long duplicates;                // number of cuts separated again after their first insertion
+    pthread_mutex_t lock;
+} cutpool;
+
+/**
+ * @brief Initializes an empty cut pool
+ *
+ * @param pool Cutpool pointer
+ * @param nnodes Number of nodes of the instance
+ * @param seed Seed used to generate the Zobrist keys
+ * @return ERROR_CODE
+ */
+ERROR_CODE cp_init(cutpool* pool, int nnodes, unsigned int seed);
+
+/**
+ * @brief Looks up the cut with node set S in the pool. If it is already there its hit count and age are updated,
+ *        otherwise the cut is inserted
+ *
+ * @param pool Cutpool pointer
+ * @param nodes Nodes of S, in any order
+ * @param nnodes |S|
+ * @return true If the cut is new
+ * @return false If the cut is a duplicate
+ */
+bool cp_insert(cutpool* pool, const int* nodes, int nnodes);
+
+/**
+ * @brief Removes the cuts separated less than min_hits times and not seen in the last max_age insertions
+ *
+ * @param pool Cutpool pointer
+ * @param min_hits Minimum number of hits to keep a cut
+ * @param max_age Maximum age to keep a cut
+ * @return int Number of removed cuts
+ */
+int cp_purge(cutpool* pool, int min_hits, long max_age);
+
+/**
+ * @brief Calls fn on every cut of the pool, used to seed a new model with the cuts found so far
+ *
+ * @param pool Cutpool pointer
+ * @param fn Function called with the (sorted) nodes of each cut
+ * @param userhandle Pointer passed to fn
+ * @return int 0 if fn never failed, the first non zero value returned by fn otherwise
+ */
+int cp_foreach(cutpool* pool, int (*fn)(const int* nodes, int nnodes, void* userhandle), void* userhandle);
+
+/**
+ * @brief Calls fn on the cuts inserted after a given clock, used to keep a model in sync with the pool
+ *
+ * @param pool Cutpool pointer
+ * @param since Pool clock of the last sync, -1 for all the cuts
+ * @param fn Function called with the (sorted) nodes of each cut
+ * @param userhandle Pointer passed to fn
+ * @return int 0 if fn never failed, the first non zero value returned by fn otherwise
+ */
+int cp_foreach_since(cutpool* pool, long since, int (*fn)(const int* nodes, int nnodes, void* userhandle), void* userhandle);
+
+/**
+ * @brief Frees all the resources of the pool
+ *
+ * @param pool Cutpool pointer
+ */
+void cp_free(cutpool* pool);
+
+#endif
@@ -0,0 +1,189 @@
+#include "deadline.h"
+
+static struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;        // signalled when the budgets change
+    struct timespec end[DL_MAX_DEPTH];  // end of each budget on CLOCK_MONOTONIC, tv_sec < 0 if unlimited
+    int depth;
+    bool running;
+    bool quit;
+    int* terminate;
+    int expired;                // read without the lock by dl_expired
+} dl;
+
+static bool dl_passed(const struct timespec* end, const struct timespec* now){
+    if(end->tv_sec < 0){
+        return false;
+    }
+    return (now->tv_sec > end->tv_sec) || (now->tv_sec == end->tv_sec && now->tv_nsec >= end->tv_nsec);
+}
+
+static struct timespec dl_after(const struct timespec* from, double seconds){
+    struct timespec t = *from;
+    long ns = (long)((seconds - (long)seconds) * 1.0E9);
+    t.tv_sec += (time_t)seconds;
+    t.tv_nsec += ns;
+    if(t.tv_nsec >= 1000000000L){
+        t.tv_sec++;
+        t.tv_nsec -= 1000000000L;
+    }
+    return t;
+}
+
+// updates the flags and returns the next instant the watchdog has to wake up at, NULL if none, caller must hold the lock
+static const struct timespec* dl_refresh(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    const struct timespec* inner = &dl.end[dl.depth - 1];
+    const struct timespec* outer = &dl.end[0];
+
+    __atomic_store_n(&dl.expired, dl_passed(inner, &now), __ATOMIC_RELAXED);
+    if(dl_passed(outer, &now)){
+        if(dl.terminate != NULL){
+            __atomic_store_n(dl.terminate, 1, __ATOMIC_RELAXED);
+        }
+        return NULL;
+    }
+
+    // nested budgets end no later than the outermost one
+    if(inner->tv_sec >= 0 && !dl_passed(inner, &now)){
+        return inner;
+    }
+    return (outer->tv_sec >= 0) ? outer : NULL;
+}
+
+static void* dl_watchdog(void* arg){
+    (void)arg;
+
+    pthread_mutex_lock(&dl.lock);
+    while(!dl.quit){
+        const struct timespec* wake = dl_refresh();
+        if(wake == NULL){
+            pthread_cond_wait(&dl.cond, &dl.lock);
+        }else{
+            struct timespec until = *wake;
+            pthread_cond_timedwait(&dl.cond, &dl.lock, &until);
+        }
+    }
+    pthread_mutex_unlock(&dl.lock);
+
+    return NULL;
+}
+
+ERROR_CODE dl_start(const struct timespec* start, double seconds, int* terminate){
+    if(dl.running){
+        dl_stop();
+    }
+
+    dl.depth = 1;
+    dl.end[0] = (seconds > 0.0) ? dl_after(start, seconds) : (struct timespec){.tv_sec = -1, .tv_nsec = 0};
+    dl.terminate = terminate;
+    dl.quit = false;
+    dl.expired = 0;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int error = pthread_cond_init(&dl.cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if(error != 0 || pthread_mutex_init(&dl.lock, NULL) != 0){
+        log_error("error in initializing the deadline watchdog");
+        return INTERNAL;
+    }
+
+    if(pthread_create(&dl.thread, NULL, dl_watchdog, NULL) != 0){
+        log_error("error in starting the deadline watchdog");
+        pthread_cond_destroy(&dl.cond);
+        pthread_mutex_destroy(&dl.lock);
+        return INTERNAL;
+    }
+    dl.running = true;
+
+    return T_OK;
+}
+
+void dl_stop(void){
+    if(!dl.running){
+        return;
+    }
+
+    pthread_mutex_lock(&dl.lock);
+    dl.quit = true;
+    pthread_cond_signal(&dl.cond);
+    pthread_mutex_unlock(&dl.lock);
+    pthread_join(dl.thread, NULL);
+
+    pthread_cond_destroy(&dl.cond);
+    pthread_mutex_destroy(&dl.lock);
+    dl.running = false;
+    dl.depth = 0;
+    dl.expired = 0;
+}
+
+ERROR_CODE dl_push(double seconds){
+    if(!dl.running){
+        return FAILED_PRECONDITION;
+    }
+
+    pthread_mutex_lock(&dl.lock);
+    if(dl.depth == DL_MAX_DEPTH){
+        pthread_mutex_unlock(&dl.lock);
+        log_warn("too many nested time budgets");
+        return FAILED_PRECONDITION;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    struct timespec end = dl_after(&now, (seconds > 0.0) ? seconds : 0.0);
+    const struct timespec* parent = &dl.end[dl.depth - 1];
+    if(parent->tv_sec >= 0 && dl_passed(parent, &end)){
+        end = *parent;
+    }
+    dl.end[dl.depth++] = end;
+
+    dl_refresh();
+    pthread_cond_signal(&dl.cond);
+    pthread_mutex_unlock(&dl.lock);
+
+    return T_OK;
+}
+
+void dl_pop(void){
+    if(!dl.running){
+        return;
+    }
+
+    pthread_mutex_lock(&dl.lock);
+    if(dl.depth > 1){
+        dl.depth--;
+    }
+    dl_refresh();
+    pthread_cond_signal(&dl.cond);
+    pthread_mutex_unlock(&dl.lock);
+}
+
+bool dl_expired(void){
+    return __atomic_load_n(&dl.expired, __ATOMIC_RELAXED);
+}
+
+double dl_remaining(void){
+    if(!dl.running){
+        return -1.0;
+    }
+
+    pthread_mutex_lock(&dl.lock);
+    struct timespec end = dl.end[dl.depth - 1];
+    pthread_mutex_unlock(&dl.lock);
+
+    if(end.tv_sec < 0){
+        return -1.0;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double left = (end.tv_sec - now.tv_sec) + (end.tv_nsec - now.tv_nsec) / 1.0E9;
+
+    return (left > 0.0) ? left : 0.0;
+}
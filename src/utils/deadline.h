@@ -0,0 +1,66 @@
+#ifndef DEADLINE_H_
+#define DEADLINE_H_
+
+/**
+ * @file deadline.h
+ * @brief Time limits enforced by a watchdog thread. The thread sleeps until the end of the current time budget and then
+ *        raises a flag, so the algorithms poll dl_expired() in their inner loops instead of reading the clock. Budgets
+ *        can be nested for the phases of an algorithm that must take only part of the time, a nested budget never
+ *        ends after the enclosing one. At the end of the outermost budget the CPLEX terminate flag is raised too
+ * @version 0.1
+ * @date 2024-06-23
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <pthread.h>
+
+#include "utils.h"
+
+#define DL_MAX_DEPTH 8              // maximum number of nested budgets, the outermost included
+
+/**
+ * @brief Starts the watchdog with the outermost budget
+ *
+ * @param start Instant the time limit is measured from, on CLOCK_MONOTONIC
+ * @param seconds Time limit, not positive for no limit
+ * @param terminate Flag raised at the end of the outermost budget, can be NULL
+ * @return ERROR_CODE
+ */
+ERROR_CODE dl_start(const struct timespec* start, double seconds, int* terminate);
+
+/**
+ * @brief Stops the watchdog, does nothing if it is not running
+ *
+ */
+void dl_stop(void);
+
+/**
+ * @brief Opens a nested budget that ends after the given time or with the enclosing one, whichever comes first
+ *
+ * @param seconds Length of the budget
+ * @return ERROR_CODE FAILED_PRECONDITION if the watchdog is not running or too many budgets are open
+ */
+ERROR_CODE dl_push(double seconds);
+
+/**
+ * @brief Closes the innermost nested budget, the outermost one is closed only by dl_stop
+ *
+ */
+void dl_pop(void);
+
+/**
+ * @brief Tells if the innermost budget is over, without any system call
+ *
+ * @return true If the time is over
+ */
+bool dl_expired(void);
+
+/**
+ * @brief Time left in the innermost budget
+ *
+ * @return double Seconds, -1.0 if there is no limit
+ */
+double dl_remaining(void);
+
+#endif
@@ -1,8 +1,44 @@
 #include "errors.h"
 
+#include <pthread.h>
+
+/**
+ * @brief Log line formatted by the thread that wrote it, printed later by the flusher
+ */
+typedef struct {
+  long seq;                           // global order of the records
+  time_t time;
+  LOGGING_TYPE level;
+  const char* file;
+  int line;
+  char message[ERR_MESSAGE_LENGTH];
+} err_record;
+
+/**
+ * @brief Single producer, single consumer ring of records, the producer is the owning thread
+ */
+typedef struct {
+  err_record records[ERR_RING_SIZE];
+  size_t head;                        // next record to print, written by the consumer
+  size_t tail;                        // next free record, written by the producer
+  int closed;                         // the owning thread exited, the ring is freed once empty
+} err_ring;
+
 static struct{
   int verbosity;
-} L;
+  err_ring* rings[ERR_MAX_RINGS];
+  long seq;
+  pthread_once_t once;
+  pthread_key_t key;
+  pthread_t flusher;
+  pthread_mutex_t consumer;           // serializes the flusher thread and err_flush
+  int running;
+  int stop;
+} L = { .once = PTHREAD_ONCE_INIT, .consumer = PTHREAD_MUTEX_INITIALIZER };
+
+static __thread err_ring* ring;
+
+int err_level = LOG_WARN;
 
 static const char *level_strings[] = {
   "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL"
@@ -12,8 +48,8 @@ static const char *level_colors[] = {
   "\x1b[94m", "\x1b[36m", "\x1b[32m", "\x1b[33m", "\x1b[31m", "\x1b[35m"
 };
 
-static char* algs_string[12] = {
-    "Nearest Neighbour", "All Nearest Neighbour", "Nearest Neighbour + 2OPT", "Tabu Search", "Variable Neighborhood Search", "CPLEX No SECs", "CPLEX Benders Loop", "Extra Mileage", "Cplex BendersLoop + Patching", "CPLEX Branch&Cut", "Hard Fixing", "Local Branching"
+static char* algs_string[18] = {
+    "Nearest Neighbour", "All Nearest Neighbour", "Nearest Neighbour + 2OPT", "Tabu Search", "Variable Neighborhood Search", "CPLEX No SECs", "CPLEX Benders Loop", "Extra Mileage", "Cplex BendersLoop + Patching", "CPLEX Branch&Cut", "Hard Fixing", "Local Branching", "1-tree Branch&Bound", "Held-Karp DP", "POPMUSIC", "Cluster Decomposition", "Multilevel", "Proximity Search"
 };
 
 static char* tenure_policy_string[4] = {
@@ -38,33 +74,203 @@ bool err_ok(ERROR_CODE error){
 
 void err_setverbosity(VERBOSITY verbosity){
     L.verbosity = verbosity;
+
+    switch(verbosity){
+    case QUIET:
+        err_level = LOG_FATAL + 1;
+        break;
+    case NORMAL:
+        err_level = LOG_WARN;
+        break;
+    case VERBOSE:
+        err_level = LOG_INFO;
+        break;
+    default:
+        err_level = LOG_TRACE;
+        break;
+    }
 }
 
 bool err_dolog(void){
     return L.verbosity >= VERBOSE;
 }
 
+static void err_print(const err_record* r){
+    char buf[16];
+    struct tm tm;
+    buf[strftime(buf, sizeof(buf), "%H:%M:%S", localtime_r(&r->time, &tm))] = '\0';
+
+    fprintf(stderr,"%s %s%-5s\x1b[0m \x1b[90m%s:%d:\x1b[0m %s\n",buf, level_colors[r->level], level_strings[r->level], r->file, r->line, r->message);
+}
+
+// prints the pending records of all the rings in the order they were written, caller must hold L.consumer
+static void err_drain(void){
+    while(1){
+        err_ring* first = NULL;
+        long seq = 0;
+        for(int i=0; i<ERR_MAX_RINGS; i++){
+            err_ring* r = __atomic_load_n(&L.rings[i], __ATOMIC_ACQUIRE);
+            if(r == NULL){
+                continue;
+            }
+            size_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+            if(r->head == tail){
+                // an exited thread cannot write anymore, its slot is given back
+                if(__atomic_load_n(&r->closed, __ATOMIC_ACQUIRE)){
+                    __atomic_store_n(&L.rings[i], NULL, __ATOMIC_RELEASE);
+                    free(r);
+                }
+                continue;
+            }
+            long s = r->records[r->head % ERR_RING_SIZE].seq;
+            if(first == NULL || s < seq){
+                first = r;
+                seq = s;
+            }
+        }
+        if(first == NULL){
+            break;
+        }
+
+        err_print(&first->records[first->head % ERR_RING_SIZE]);
+        __atomic_store_n(&first->head, first->head + 1, __ATOMIC_RELEASE);
+    }
+    fflush(stderr);
+}
+
+static void* err_flusher(void* arg){
+    (void)arg;
+    struct timespec period = {.tv_sec = 0, .tv_nsec = ERR_FLUSH_PERIOD_MS * 1000000L};
+
+    while(!__atomic_load_n(&L.stop, __ATOMIC_ACQUIRE)){
+        pthread_mutex_lock(&L.consumer);
+        err_drain();
+        pthread_mutex_unlock(&L.consumer);
+        nanosleep(&period, NULL);
+    }
+
+    return NULL;
+}
+
+static void err_closering(void* arg){
+    __atomic_store_n(&((err_ring*)arg)->closed, 1, __ATOMIC_RELEASE);
+}
+
+static void err_stoplogger(void){
+    if(L.running){
+        __atomic_store_n(&L.stop, 1, __ATOMIC_RELEASE);
+        pthread_join(L.flusher, NULL);
+        L.running = 0;
+    }
+    err_flush();
+}
+
+static void err_startlogger(void){
+    if(pthread_key_create(&L.key, err_closering) != 0){
+        return;
+    }
+    if(pthread_create(&L.flusher, NULL, err_flusher, NULL) == 0){
+        L.running = 1;
+    }
+    atexit(err_stoplogger);
+}
+
+// ring of the calling thread, NULL if none can be registered
+static err_ring* err_getring(void){
+    if(ring != NULL){
+        return ring;
+    }
+
+    pthread_once(&L.once, err_startlogger);
+    if(!L.running){
+        return NULL;
+    }
+
+    err_ring* r = (err_ring*) calloc(1, sizeof(err_ring));
+    if(r == NULL){
+        return NULL;
+    }
+    for(int i=0; i<ERR_MAX_RINGS; i++){
+        err_ring* expected = NULL;
+        if(__atomic_compare_exchange_n(&L.rings[i], &expected, r, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)){
+            pthread_setspecific(L.key, r);
+            ring = r;
+            return r;
+        }
+    }
+    free(r);
+
+    return NULL;
+}
+
 void err_logging(LOGGING_TYPE level, const char *file, int line, char* message, ...){
-    if(!(L.verbosity == QUIET) && !(L.verbosity == NORMAL && (level == LOG_INFO || level == LOG_TRACE || level == LOG_DEBUG)) && !(L.verbosity == VERBOSE && (level == LOG_TRACE || level == LOG_DEBUG))){
-        va_list arg;
-        va_start(arg, message);
+    err_ring* r = err_getring();
+    err_record direct;
+    err_record* record = &direct;
+
+    // a full ring or an unregistered thread prints directly, slower but nothing is lost. Errors are printed at once too,
+    // they must be on the terminal if the process crashes right after
+    size_t tail = 0;
+    if(r != NULL && level < LOG_ERROR){
+        tail = r->tail;
+        if(tail - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) < ERR_RING_SIZE){
+            record = &r->records[tail % ERR_RING_SIZE];
+        }
+    }
 
-        char buf[16];
-        time_t t = time(NULL);
-        buf[strftime(buf, sizeof(buf), "%H:%M:%S", localtime(&t))] = '\0';
+    va_list arg;
+    va_start(arg, message);
+    int length = vsnprintf(record->message, ERR_MESSAGE_LENGTH, message, arg);
+    va_end(arg);
 
-        fprintf(stderr,"%s %s%-5s\x1b[0m \x1b[90m%s:%d:\x1b[0m ",buf, level_colors[level], level_strings[level], file, line);
-        vfprintf(stderr, message, arg);
-        fprintf(stderr, "\n");
+    record->seq = __atomic_fetch_add(&L.seq, 1, __ATOMIC_RELAXED);
+    record->time = time(NULL);
+    record->level = level;
+    record->file = file;
+    record->line = line;
 
-        va_end(arg);
+    if(record != &direct && length < ERR_MESSAGE_LENGTH){
+        __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+        return;
     }
+
+    // the records already queued come first
+    err_flush();
+
+    // too long for a record, formatted again on the heap
+    if(length >= ERR_MESSAGE_LENGTH){
+        char* buf = (char*) malloc(length + 1);
+        if(buf != NULL){
+            va_start(arg, message);
+            vsnprintf(buf, length + 1, message, arg);
+            va_end(arg);
+
+            char tbuf[16];
+            struct tm tm;
+            tbuf[strftime(tbuf, sizeof(tbuf), "%H:%M:%S", localtime_r(&record->time, &tm))] = '\0';
+            fprintf(stderr,"%s %s%-5s\x1b[0m \x1b[90m%s:%d:\x1b[0m %s\n",tbuf, level_colors[level], level_strings[level], file, line, buf);
+            free(buf);
+            return;
+        }
+    }
+    err_print(record);
+}
+
+void err_flush(void){
+    pthread_mutex_lock(&L.consumer);
+    err_drain();
+    pthread_mutex_unlock(&L.consumer);
 }
 
 void err_status(char* message, const char *file, int line) {
+  // the cursor movements must surround the line they rewrite
+  err_flush();
   fprintf(stderr, "\033[1A");
 	fprintf(stderr, "\033[K");
-	err_logging(LOG_INFO, file, line, "%s\t%s", message, "✅");
+	if(err_enabled(LOG_INFO)){
+		err_logging(LOG_INFO, file, line, "%s\t%s", message, "✅");
+		err_flush();
+	}
 	fprintf(stderr, "\033[1B"); // Move cursor back down one line to the new line
   fflush(stdout);    // Flush the output buffer to ensure the line is printed immediately
 }
@@ -142,7 +348,8 @@ void err_setinfo(int alg, int nnodes, bool random, char* inputfile, double timel
   }
 }
 
-void err_printoutput(double cost, double time, int alg){
+void err_printoutput(double cost, double time, int alg, double lower_bound){
+  err_flush();
   if(!(L.verbosity == QUIET)){
 
     err_printline();
@@ -150,13 +357,17 @@ void err_printoutput(double cost, double time, int alg){
     printf("algorithm: %s\n", algs_string[alg]);
 
     printf("cost: %.2f\n", cost);
+    if(lower_bound >= 0.0){
+      printf("lower bound: %.2f\n", lower_bound);
+      printf("gap: %.2f%%\n", 100.0 * (cost - lower_bound) / cost);
+    }
     printf("execution time: %.2f seconds\n", time);
 
     err_printline();
 
     printf("Program finished, shutting down...\n");
   }else{
-    if(alg == 6 || alg == 8 || alg == 9){
+    if(alg == 6 || alg == 8 || alg == 9 || alg == 12 || alg == 13){
       // exact methods need to be compared on time
       printf("Time: %.2f\n", time);
     }else{
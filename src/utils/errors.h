@@ -74,12 +74,34 @@ typedef enum{
   VERY_VERBOSE = 3
 } VERBOSITY;
 
-#define log_trace(...) err_logging(LOG_TRACE, __FILE__, __LINE__, __VA_ARGS__)
-#define log_debug(...) err_logging(LOG_DEBUG, __FILE__, __LINE__, __VA_ARGS__)
-#define log_info(...)  err_logging(LOG_INFO,  __FILE__, __LINE__, __VA_ARGS__)
-#define log_warn(...)  err_logging(LOG_WARN,  __FILE__, __LINE__, __VA_ARGS__)
-#define log_error(...) err_logging(LOG_ERROR, __FILE__, __LINE__, __VA_ARGS__)
-#define log_fatal(...) err_logging(LOG_FATAL, __FILE__, __LINE__, __VA_ARGS__)
+/**
+ * @brief lowest level compiled in, the calls below it are removed by the compiler together with their arguments.
+ * Release builds define it as LOG_INFO (make RELEASE=1)
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_TRACE
+#endif
+
+#define ERR_RING_SIZE 256           // records in the ring of each thread
+#define ERR_MESSAGE_LENGTH 240      // longer messages are printed directly
+#define ERR_MAX_RINGS 64            // threads logging at the same time, the others print directly
+#define ERR_FLUSH_PERIOD_MS 20      // period of the flusher thread
+
+/**
+ * @brief lowest level printed with the current verbosity, set by err_setverbosity
+ */
+extern int err_level;
+
+#define err_enabled(level) ((level) >= LOG_MIN_LEVEL && (level) >= err_level)
+
+#define err_log(level, ...) do { if(err_enabled(level)) err_logging(level, __FILE__, __LINE__, __VA_ARGS__); } while(0)
+
+#define log_trace(...) err_log(LOG_TRACE, __VA_ARGS__)
+#define log_debug(...) err_log(LOG_DEBUG, __VA_ARGS__)
+#define log_info(...)  err_log(LOG_INFO,  __VA_ARGS__)
+#define log_warn(...)  err_log(LOG_WARN,  __VA_ARGS__)
+#define log_error(...) err_log(LOG_ERROR, __VA_ARGS__)
+#define log_fatal(...) err_log(LOG_FATAL, __VA_ARGS__)
 
 #define log_status(message) err_status(message, __FILE__, __LINE__);
 
@@ -108,7 +130,9 @@ void err_setverbosity(VERBOSITY verbosity);
 bool err_dolog(void);
 
 /**
- * @brief Helper function to print logs
+ * @brief Helper function to print logs, called through the log_ macros that check the level.
+ * The line is formatted in the ring of the calling thread without locks and printed by a flusher thread, errors and
+ * fatal errors are printed at once after the pending lines
  * 
  * @param level 
  * @param file 
@@ -118,9 +142,22 @@ bool err_dolog(void);
  */
 void err_logging(LOGGING_TYPE level, const char *file, int line, char* message, ...);
 
+/**
+ * @brief Prints the logs still in the rings of all threads
+ */
+void err_flush(void);
+
 void err_status(char* message, const char *file, int line);
 
-void err_printoutput(double cost, double time, int alg);
+/**
+ * @brief Prints the final output of the algorithm
+ * 
+ * @param cost Cost of the best solution
+ * @param time Execution time
+ * @param alg Algorithm
+ * @param lower_bound Held-Karp lower bound, negative if not computed
+ */
+void err_printoutput(double cost, double time, int alg, double lower_bound);
 
 void err_setinfo(int alg, int nnodes, bool random, char* inputfile, double timelimit, int seed, int tabu_policy, int em_init, bool init_mip, int bc_policy, bool callback_relaxation,  double lb_improv, int lb_delta, bool lb_kstar);
 
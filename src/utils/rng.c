@@ -0,0 +1,83 @@
+#include "rng.h"
+
+static inline uint64_t rng_rotl(uint64_t x, int k){
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t rng_splitmix(uint64_t* x){
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void rng_seed(rng_state* r, uint64_t seed){
+    // splitmix64 never gives four zero words in a row
+    for(int i=0; i<4; i++){
+        r->s[i] = rng_splitmix(&seed);
+    }
+}
+
+void rng_split(const rng_state* parent, int id, rng_state* child){
+    *child = *parent;
+    // the parent keeps the first block, stream id takes block id+1
+    for(int i=0; i<=id; i++){
+        rng_jump(child);
+    }
+}
+
+void rng_jump(rng_state* r){
+    static const uint64_t jump[] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+
+    uint64_t s[4] = {0, 0, 0, 0};
+    for(int i=0; i<4; i++){
+        for(int b=0; b<64; b++){
+            if(jump[i] & ((uint64_t)1 << b)){
+                s[0] ^= r->s[0];
+                s[1] ^= r->s[1];
+                s[2] ^= r->s[2];
+                s[3] ^= r->s[3];
+            }
+            rng_next(r);
+        }
+    }
+    r->s[0] = s[0];
+    r->s[1] = s[1];
+    r->s[2] = s[2];
+    r->s[3] = s[3];
+}
+
+uint64_t rng_next(rng_state* r){
+    uint64_t* s = r->s;
+    uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rng_rotl(s[3], 45);
+
+    return result;
+}
+
+double rng_double(rng_state* r){
+    // the upper 53 bits fill the mantissa
+    return (rng_next(r) >> 11) * 0x1.0p-53;
+}
+
+int rng_int(rng_state* r, int bound){
+    // Lemire's multiply and reject, the rejection zone is below 2^32 mod bound
+    uint32_t b = (uint32_t)bound;
+    uint64_t m = (uint64_t)(uint32_t)(rng_next(r) >> 32) * b;
+    uint32_t low = (uint32_t)m;
+    if(low < b){
+        uint32_t threshold = -b % b;
+        while(low < threshold){
+            m = (uint64_t)(uint32_t)(rng_next(r) >> 32) * b;
+            low = (uint32_t)m;
+        }
+    }
+    return (int)(m >> 32);
+}
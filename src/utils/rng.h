@@ -0,0 +1,74 @@
+#ifndef RNG_H_
+#define RNG_H_
+
+/**
+ * @file rng.h
+ * @brief Pseudo random numbers with xoshiro256**, each thread owns its generator state so there is no locking and
+ *        no shared libc state. Parallel streams are made by jumping 2^128 numbers ahead of a parent generator, so
+ *        a run is reproducible for a given seed whatever the scheduling of the threads
+ * @version 0.1
+ * @date 2024-06-24
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <stdint.h>
+
+/**
+ * @brief State of a generator, must not be all zero
+ *
+ */
+typedef struct {
+    uint64_t s[4];
+} rng_state;
+
+/**
+ * @brief Initializes the state from a seed, expanded with splitmix64
+ *
+ * @param r Generator
+ * @param seed Any value
+ */
+void rng_seed(rng_state* r, uint64_t seed);
+
+/**
+ * @brief Derives an independent stream from a parent generator, the parent is not advanced
+ *
+ * @param parent Generator the stream is derived from
+ * @param id Index of the stream, streams with different indices do not overlap
+ * @param child Generator of the stream
+ */
+void rng_split(const rng_state* parent, int id, rng_state* child);
+
+/**
+ * @brief Advances the generator by 2^128 numbers
+ *
+ * @param r Generator
+ */
+void rng_jump(rng_state* r);
+
+/**
+ * @brief Next 64 random bits
+ *
+ * @param r Generator
+ * @return uint64_t
+ */
+uint64_t rng_next(rng_state* r);
+
+/**
+ * @brief Uniform double in [0, 1)
+ *
+ * @param r Generator
+ * @return double
+ */
+double rng_double(rng_state* r);
+
+/**
+ * @brief Uniform integer in [0, bound) without modulo bias
+ *
+ * @param r Generator
+ * @param bound Positive upper bound
+ * @return int
+ */
+int rng_int(rng_state* r, int bound);
+
+#endif
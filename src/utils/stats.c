@@ -0,0 +1,116 @@
+#include "stats.h"
+
+static const char* st_counter_names[ST_NCOUNTERS] = {
+    "2opt_evaluated", "2opt_applied", "oropt_applied", "kicks", "tabu_iterations", "callback_candidate",
+    "callback_relaxation", "candidates_rejected", "cuts_candidate", "cuts_relaxation", "cuts_blossom", "cuts_benders",
+    "cuts_root", "cuts_pool", "heuristic_posted", "mipstart_added", "mipstart_accepted"
+};
+
+static const char* st_timer_names[ST_NTIMERS] = {
+    "parse", "costs", "construction", "refinement", "mip", "separation"
+};
+
+static const char* st_alg_names[18] = {
+    "GREEDY", "GREEDY_ITER", "2OPT_GREEDY", "TABU_SEARCH", "VNS", "CPLEX_NOSEC", "CPLEX_BENDERS", "EXTRA_MILEAGE",
+    "CPLEX_BENDERS_PATCHING", "CPLEX_BRANCH_CUT", "HARD_FIXING", "LOCAL_BRANCHING", "BNB_1TREE", "HELD_KARP_DP",
+    "POPMUSIC", "CLUSTER", "MULTILEVEL", "PROXIMITY_SEARCH"
+};
+
+static struct {
+    pthread_once_t once;
+    pthread_key_t key;
+    pthread_mutex_t lock;           // guards live and total
+    st_block* live;                 // blocks of the running threads
+    st_block total;                 // merged blocks of the exited threads
+} st = { .once = PTHREAD_ONCE_INIT, .lock = PTHREAD_MUTEX_INITIALIZER };
+
+__thread st_block* st_local;
+
+static void st_merge(st_block* into, const st_block* b){
+    for(int i=0; i<ST_NCOUNTERS; i++){
+        into->counters[i] += b->counters[i];
+    }
+    for(int i=0; i<ST_NTIMERS; i++){
+        into->timers[i] += b->timers[i];
+    }
+}
+
+static void st_release(void* arg){
+    st_block* b = (st_block*) arg;
+
+    pthread_mutex_lock(&st.lock);
+    st_merge(&st.total, b);
+    for(st_block** p = &st.live; *p != NULL; p = &(*p)->next){
+        if(*p == b){
+            *p = b->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&st.lock);
+
+    free(b);
+}
+
+static void st_init(void){
+    if(pthread_key_create(&st.key, st_release) != 0){
+        log_warn("thread exit hook for the statistics not available");
+    }
+}
+
+st_block* st_register(void){
+    pthread_once(&st.once, st_init);
+
+    st_block* b = (st_block*) calloc(1, sizeof(st_block));
+    if(b == NULL){
+        return NULL;
+    }
+
+    pthread_mutex_lock(&st.lock);
+    b->next = st.live;
+    st.live = b;
+    pthread_mutex_unlock(&st.lock);
+
+    pthread_setspecific(st.key, b);
+    st_local = b;
+
+    return b;
+}
+
+ERROR_CODE st_dump(const char* path, int alg, double cost, double time){
+    FILE* f = fopen(path, "w");
+    if(f == NULL){
+        log_error("cannot open %s for the statistics", path);
+        return NOT_FOUND;
+    }
+
+    st_block sum = {0};
+    pthread_mutex_lock(&st.lock);
+    st_merge(&sum, &st.total);
+    for(st_block* b = st.live; b != NULL; b = b->next){
+        st_merge(&sum, b);
+    }
+    pthread_mutex_unlock(&st.lock);
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"algorithm\": \"%s\",\n", (alg >= 0 && alg < 18) ? st_alg_names[alg] : "UNKNOWN");
+    fprintf(f, "  \"cost\": %.6f,\n", cost);
+    fprintf(f, "  \"time\": %.6f,\n", time);
+
+    fprintf(f, "  \"counters\": {\n");
+    for(int i=0; i<ST_NCOUNTERS; i++){
+        fprintf(f, "    \"%s\": %ld%s\n", st_counter_names[i], sum.counters[i], (i < ST_NCOUNTERS - 1) ? "," : "");
+    }
+    fprintf(f, "  },\n");
+
+    fprintf(f, "  \"timers\": {\n");
+    for(int i=0; i<ST_NTIMERS; i++){
+        fprintf(f, "    \"%s\": %.6f%s\n", st_timer_names[i], sum.timers[i] / 1.0E9, (i < ST_NTIMERS - 1) ? "," : "");
+    }
+    fprintf(f, "  }\n");
+    fprintf(f, "}\n");
+
+    fclose(f);
+    log_info("statistics written to %s", path);
+
+    return T_OK;
+}
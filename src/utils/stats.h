@@ -0,0 +1,121 @@
+#ifndef STATS_H_
+#define STATS_H_
+
+/**
+ * @file stats.h
+ * @brief Counters and timers of the hot paths. Each thread adds to its own block without atomics, the block of a
+ *        thread is merged into the totals when the thread exits and the totals are written as JSON with --stats
+ * @version 0.1
+ * @date 2024-06-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include <pthread.h>
+
+#include "utils.h"
+
+/**
+ * @brief Counted events
+ *
+ */
+typedef enum {
+    ST_2OPT_EVALUATED,              // 2-opt moves evaluated by the local searches
+    ST_2OPT_APPLIED,
+    ST_OROPT_APPLIED,
+    ST_KICKS,                       // VNS kicks
+    ST_TABU_ITERATIONS,
+    ST_CALLBACK_CANDIDATE,          // B&C callback invocations by context
+    ST_CALLBACK_RELAXATION,
+    ST_CANDIDATES_REJECTED,
+    ST_CUTS_CANDIDATE,              // SECs of rejected candidates
+    ST_CUTS_RELAXATION,             // SECs separated on fractional points
+    ST_CUTS_BLOSSOM,
+    ST_CUTS_BENDERS,
+    ST_CUTS_ROOT,
+    ST_CUTS_POOL,                   // SECs added again from the cut pool
+    ST_HEURISTIC_POSTED,
+    ST_MIPSTART_ADDED,
+    ST_MIPSTART_ACCEPTED,           // MIP starts CPLEX took as incumbent
+    ST_NCOUNTERS
+} st_counter;
+
+/**
+ * @brief Timed phases, a phase can be timed by several threads at once
+ *
+ */
+typedef enum {
+    ST_TIME_PARSE,                  // command line and instance, cost matrix included
+    ST_TIME_COSTS,
+    ST_TIME_CONSTRUCTION,
+    ST_TIME_REFINEMENT,
+    ST_TIME_MIP,
+    ST_TIME_SEPARATION,
+    ST_NTIMERS
+} st_timer;
+
+typedef struct st_block {
+    long counters[ST_NCOUNTERS];
+    long timers[ST_NTIMERS];        // nanoseconds
+    struct st_block* next;
+} st_block;
+
+extern __thread st_block* st_local;
+
+/**
+ * @brief Allocates the block of the calling thread, done by the first st_add or st_time of each thread
+ *
+ * @return st_block* NULL if it cannot be allocated, the events of the thread are then lost
+ */
+st_block* st_register(void);
+
+/**
+ * @brief Adds to a counter of the calling thread
+ *
+ * @param c Counter
+ * @param v Amount
+ */
+static inline void st_add(st_counter c, long v){
+    st_block* b = (st_local != NULL) ? st_local : st_register();
+    if(b != NULL){
+        b->counters[c] += v;
+    }
+}
+
+/**
+ * @brief Start of a timed interval
+ *
+ * @return struct timespec
+ */
+static inline struct timespec st_now(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t;
+}
+
+/**
+ * @brief Adds the time elapsed since from to a timer of the calling thread
+ *
+ * @param t Timer
+ * @param from Start of the interval, from st_now
+ */
+static inline void st_time(st_timer t, const struct timespec* from){
+    struct timespec now = st_now();
+    st_block* b = (st_local != NULL) ? st_local : st_register();
+    if(b != NULL){
+        b->timers[t] += (now.tv_sec - from->tv_sec) * 1000000000L + (now.tv_nsec - from->tv_nsec);
+    }
+}
+
+/**
+ * @brief Writes the counters and timers of all the threads as JSON, the other threads must have stopped
+ *
+ * @param path Output file
+ * @param alg Algorithm that ran
+ * @param cost Cost of the best solution
+ * @param time Execution time
+ * @return ERROR_CODE
+ */
+ERROR_CODE st_dump(const char* path, int alg, double cost, double time);
+
+#endif
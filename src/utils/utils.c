@@ -1,7 +1,7 @@
 #include "utils.h"
 
-static char* algs_string[12] = {
-    "Greedy", "Greedy\\_Iter", "2opt\\_Greedy", "Tabu\\_Search", "VNS", "Cplex\\_NoSec", "Cplex\\_BendersLoop", "Extra\\_Mileage", "Cplex\\_BendersLoop\\_Patching", "Cplex\\_Branch\\&Cut", "Hard\\_Fixing", "Local\\_Branching"
+static char* algs_string[18] = {
+    "Greedy", "Greedy\\_Iter", "2opt\\_Greedy", "Tabu\\_Search", "VNS", "Cplex\\_NoSec", "Cplex\\_BendersLoop", "Extra\\_Mileage", "Cplex\\_BendersLoop\\_Patching", "Cplex\\_Branch\\&Cut", "Hard\\_Fixing", "Local\\_Branching", "BnB\\_1Tree", "Held\\_Karp\\_DP", "POPMUSIC", "Cluster\\_Decomposition", "Multilevel", "Proximity\\_Search"
 };
 
 void utils_safe_memory_free (void ** pointer_address)
@@ -67,65 +67,40 @@ void utils_plotname(char* buffer, int buffersize){
 
 }
 
-void utils_format_title(char *fname, int alg) {
-  size_t num_algs = sizeof(algs_string) / sizeof(algs_string[0]);
-
-    log_debug("fname: %s", fname);
-    // Escape the underscore character (because it's LaTeX)
-    size_t length = strlen(fname) + 50;
-    size_t new_length = length; // Length of the modified string
-    for (size_t i = 0; i < length; i++) {
-        if (fname[i] == '_') {
-            new_length++; // Increase length to accommodate the additional backslash
-        }
-    }
-
-    log_debug("old size: %d", length);
-    log_debug("new size: %d", new_length);
-
-    // Ensure there's enough space for the modifications
-    char *new_fname = (char *)malloc(new_length + 1); // +1 for the null terminator
-    if (new_fname == NULL) {
-        fprintf(stderr, "Memory allocation failed\n");
+void utils_format_title(char* buffer, int buffersize, const char* fname, int alg){
+    size_t num_algs = sizeof(algs_string) / sizeof(algs_string[0]);
+    size_t size = (size_t) buffersize;
+    if(buffer == NULL || size == 0){
         return;
     }
 
-    // Move characters to their new positions, inserting backslashes before underscores
-    int j=0;
-    for (size_t i = 0; i < length; i++) {
-        if (fname[i] == '_') {
-            new_fname[j++] = '\\'; // Insert backslash before underscore
-            new_fname[j++] = '_'; // Move underscore to its new position
-        } else {
-            new_fname[j++] = fname[i]; // Move other characters as they are
-        }
-    }
-    new_fname[new_length] = '\0';
-
-    log_debug("new_fname: %s", new_fname);
+    log_debug("fname: %s", fname);
 
     // Strip the extension
-    char *dot_position = strrchr(new_fname, '.');
-    if (dot_position != NULL) {
-        *dot_position = '\0';
-    }
-
-    // Get string of algorithm
-    const char *alg_s = NULL;
-    if (alg >= 0 && alg < (int)num_algs) {
-        alg_s = algs_string[alg];
+    const char* dot_position = strrchr(fname, '.');
+    size_t length = dot_position != NULL ? (size_t)(dot_position - fname) : strlen(fname);
+
+    // Escape the underscore character (because it's LaTeX), stop when the buffer is full
+    size_t j = 0;
+    for(size_t i = 0; i < length; i++){
+        size_t needed = fname[i] == '_' ? 2 : 1;
+        if(j + needed >= size){
+            log_warn("plot title truncated");
+            break;
+        }
+        if(fname[i] == '_'){
+            buffer[j++] = '\\';
+        }
+        buffer[j++] = fname[i];
     }
+    buffer[j] = '\0';
 
-    // Concatenate the algorithm string
-    if (alg_s != NULL) {
-        strcat(new_fname, alg_s);
+    // Append the name of the algorithm, truncated if it does not fit
+    if(alg >= 0 && alg < (int)num_algs && algs_string[alg] != NULL){
+        strncat(buffer, algs_string[alg], size - j - 1);
     }
 
-    // Copy the new string back to the original pointer (ensure it fits)
-    strncpy(fname, new_fname, new_length + 1);
-
-    // Free allocated memory
-    utils_safe_free(new_fname);
+    log_debug("title: %s", buffer);
 }
 
 void swap(int* a, int* b){
@@ -18,12 +18,13 @@
 #include <time.h>
 
 #include "errors.h"
+#include "rng.h"
 
 
 #define MAX_COORDINATE 5000
 #define MIN_COORDINATE -5000
 
-#define TSP_RAND() ( ((double)rand() / RAND_MAX) * (MAX_COORDINATE - MIN_COORDINATE) + MIN_COORDINATE )
+#define TSP_RAND(r) ( rng_double(r) * (MAX_COORDINATE - MIN_COORDINATE) + MIN_COORDINATE )
 
 #define max(a,b) \
    ({ __typeof__ (a) _a = (a); \
@@ -52,7 +53,7 @@ bool utils_invalid_input(int i, int argc, bool* help);
 void utils_startclock(struct timespec* c);
 double utils_timeelapsed(struct timespec* c);
 void utils_plotname(char* buffer, int buffersize);
-void utils_format_title(char *fname, int alg);
+void utils_format_title(char* buffer, int buffersize, const char* fname, int alg);
 void swap(int* a, int* b);
 
 /**